@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "BenchmarkData.h"
+#include "ContextTable.h"
+
+namespace Contextual {
+
+namespace {
+
+std::vector<std::string> createKeys(size_t count) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back("Key" + std::to_string(i));
+    }
+    return keys;
+}
+
+void BM_ContextTableSetFloat(benchmark::State& state) {
+    auto manager = BenchmarkData::createManager();
+    const auto keys = createKeys(state.range(0));
+    for (auto _ : state) {
+        ContextTable table(manager);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            table.set(keys[i], static_cast<float>(i));
+        }
+        benchmark::DoNotOptimize(table);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ContextTableSetFloat)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_ContextTableSetString(benchmark::State& state) {
+    auto manager = BenchmarkData::createManager();
+    const auto keys = createKeys(state.range(0));
+    for (auto _ : state) {
+        ContextTable table(manager);
+        for (const auto& key : keys) {
+            table.set(key, key);
+        }
+        benchmark::DoNotOptimize(table);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ContextTableSetString)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_ContextTableGetFloat(benchmark::State& state) {
+    auto manager = BenchmarkData::createManager();
+    const auto keys = createKeys(state.range(0));
+    ContextTable table(manager);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        table.set(keys[i], static_cast<float>(i));
+    }
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(table.getFloat(key));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ContextTableGetFloat)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_ContextTableGetFloatById(benchmark::State& state) {
+    auto manager = BenchmarkData::createManager();
+    const auto keys = createKeys(state.range(0));
+    std::vector<int> keyIds;
+    ContextTable table(manager);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        table.set(keys[i], static_cast<float>(i));
+        keyIds.push_back(ContextIds::getKeyId(keys[i]));
+    }
+    for (auto _ : state) {
+        for (int keyId : keyIds) {
+            benchmark::DoNotOptimize(table.getFloat(keyId));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keyIds.size()));
+}
+BENCHMARK(BM_ContextTableGetFloatById)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_ContextTableGetString(benchmark::State& state) {
+    auto manager = BenchmarkData::createManager();
+    const auto keys = createKeys(state.range(0));
+    ContextTable table(manager);
+    for (const auto& key : keys) {
+        table.set(key, key);
+    }
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(table.getString(key));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+BENCHMARK(BM_ContextTableGetString)->RangeMultiplier(4)->Range(4, 256);
+
+}  // namespace
+
+}  // namespace Contextual
@@ -0,0 +1,143 @@
+#include "BenchmarkData.h"
+
+#include <filesystem>
+#include <limits>
+#include <random>
+
+#include "CriterionExist.h"
+#include "CriterionStatic.h"
+#include "DatabaseGenerator.h"
+#include "DefaultFunctionTable.h"
+#include "ResponseSimple.h"
+
+namespace Contextual::BenchmarkData {
+
+namespace {
+
+const float g_EPSILON = std::numeric_limits<float>::epsilon();
+const uint32_t g_RULES_PER_CATEGORY = 1000;
+const uint32_t g_CATEGORIES_PER_GROUP = 10;
+
+enum class CriterionKind { kEquals, kRange, kExists };
+
+struct GeneratedCriterion {
+    CriterionKind kind;
+    int table;
+    int key;
+    int min;
+    int max;
+};
+
+GeneratedCriterion nextCriterion(std::mt19937_64& rng) {
+    std::uniform_int_distribution<int> tableDist(0, static_cast<int>(g_TABLES.size()) - 1);
+    std::uniform_int_distribution<int> keyDist(0, g_NUM_KEYS - 1);
+    std::uniform_int_distribution<int> valueDist(0, g_NUM_VALUES - 1);
+    std::uniform_int_distribution<int> kindDist(0, 9);
+
+    GeneratedCriterion criterion{CriterionKind::kEquals, tableDist(rng), keyDist(rng), 0, 0};
+    int kind = kindDist(rng);
+    if (kind < 5) {
+        criterion.kind = CriterionKind::kEquals;
+        criterion.min = criterion.max = valueDist(rng);
+    } else if (kind < 8) {
+        criterion.kind = CriterionKind::kRange;
+        int a = valueDist(rng);
+        int b = valueDist(rng);
+        criterion.min = std::min(a, b);
+        criterion.max = std::max(a, b);
+    } else {
+        criterion.kind = CriterionKind::kExists;
+    }
+    return criterion;
+}
+
+std::string keyName(int key) {
+    return "Key" + std::to_string(key);
+}
+
+}  // namespace
+
+std::shared_ptr<ContextManager> createManager() {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    return std::make_shared<ContextManager>(std::move(functionTable));
+}
+
+std::shared_ptr<ContextTable> createContext(const std::shared_ptr<ContextManager>& manager, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> valueDist(0, g_NUM_VALUES - 1);
+    auto context = std::make_shared<ContextTable>(manager);
+    for (int key = 0; key < g_NUM_KEYS; ++key) {
+        context->set(keyName(key), valueDist(rng));
+    }
+    return context;
+}
+
+void populateQuery(DatabaseQuery& query, const std::shared_ptr<ContextManager>& manager, uint64_t seed) {
+    for (size_t i = 0; i < g_TABLES.size(); ++i) {
+        query.addContextTable(g_TABLES[i], createContext(manager, seed + i));
+    }
+    query.setSeed(seed);
+}
+
+std::vector<std::shared_ptr<RuleEntry>> createRules(size_t numRules, size_t numCriteria, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> priorityDist(0, static_cast<int>(numCriteria));
+    std::vector<std::shared_ptr<RuleEntry>> entries;
+    entries.reserve(numRules);
+    for (size_t r = 0; r < numRules; ++r) {
+        auto entry = std::make_shared<RuleEntry>();
+        entry->id = "Bench.Rules.Id" + std::to_string(r);
+        for (size_t i = 0; i < numCriteria; ++i) {
+            const auto generated = nextCriterion(rng);
+            std::shared_ptr<Criterion> criterion;
+            if (generated.kind == CriterionKind::kExists) {
+                criterion = std::make_shared<CriterionExist>(false);
+            } else {
+                criterion = std::make_shared<CriterionStatic>(static_cast<float>(generated.min) - g_EPSILON,
+                                                              static_cast<float>(generated.max) + g_EPSILON, false);
+            }
+            entry->criteria.push_back(
+                std::make_shared<Criteria>(g_TABLES[generated.table], keyName(generated.key), std::move(criterion)));
+        }
+        // Priority mirrors what the parser derives from the criteria count, plus some noise for ties
+        entry->priority = static_cast<int>(numCriteria) + priorityDist(rng);
+        entry->response = std::make_shared<ResponseSimple>(std::vector<std::string>{entry->id});
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+std::string writeDatabase(size_t numRules, size_t numCriteria) {
+    const auto dir = std::filesystem::temp_directory_path() /
+                     ("contextual-bench-" + std::to_string(numRules) + "-" + std::to_string(numCriteria));
+    if (std::filesystem::is_directory(dir)) {
+        return dir.string();
+    }
+    // Write to a staging directory first so an interrupted run never leaves a partial database behind
+    auto staging = dir;
+    staging += ".tmp";
+    std::filesystem::remove_all(staging);
+    std::filesystem::create_directories(staging);
+
+    Gen::GeneratorSettings settings;
+    settings.seed = numRules * 31 + numCriteria;
+    settings.tables = g_TABLES;
+    settings.numKeys = g_NUM_KEYS;
+    settings.numValues = g_NUM_VALUES;
+    settings.minCriteria = static_cast<uint32_t>(numCriteria);
+    settings.maxCriteria = static_cast<uint32_t>(numCriteria);
+    settings.rulesPerCategory = static_cast<uint32_t>(std::min<size_t>(numRules, g_RULES_PER_CATEGORY));
+    const size_t numCategories = (numRules + settings.rulesPerCategory - 1) / settings.rulesPerCategory;
+    settings.numCategories = static_cast<uint32_t>(std::min<size_t>(numCategories, g_CATEGORIES_PER_GROUP));
+    settings.numGroups = static_cast<uint32_t>((numCategories + settings.numCategories - 1) / settings.numCategories);
+    Gen::GeneratorStats stats{};
+    auto result = Gen::generateDatabase(stats, settings, staging.string());
+    if (result.code != Gen::GeneratorReturnCode::kSuccess) {
+        return "";
+    }
+    std::filesystem::rename(staging, dir);
+    return dir.string();
+}
+
+}  // namespace Contextual::BenchmarkData
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ContextManager.h"
+#include "ContextTable.h"
+#include "DatabaseQuery.h"
+#include "RuleTable.h"
+
+namespace Contextual::BenchmarkData {
+
+// Context tables that synthetic rules and queries draw from
+const std::vector<std::string> g_TABLES = {"Speaker", "Listener", "World"};
+// Number of keys per table, named Key0, Key1, ...
+constexpr int g_NUM_KEYS = 32;
+// Facts take integer values in [0, g_NUM_VALUES)
+constexpr int g_NUM_VALUES = 8;
+
+std::shared_ptr<ContextManager> createManager();
+// Creates a table with every key set to a random value
+std::shared_ptr<ContextTable> createContext(const std::shared_ptr<ContextManager>& manager, uint64_t seed);
+// Adds a random context for every table in g_TABLES, the query keeps a reference to the manager
+void populateQuery(DatabaseQuery& query, const std::shared_ptr<ContextManager>& manager, uint64_t seed);
+// Reproducible mix of equality, range and existence criteria
+std::vector<std::shared_ptr<RuleEntry>> createRules(size_t numRules, size_t numCriteria, uint64_t seed);
+// Writes a database with the same generator as context-gen and returns its path, or an empty string on failure.
+// Directories are generated once per size and reused by later calls.
+std::string writeDatabase(size_t numRules, size_t numCriteria);
+
+}  // namespace Contextual::BenchmarkData
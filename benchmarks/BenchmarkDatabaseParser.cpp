@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkData.h"
+#include "DatabaseParser.h"
+#include "RuleDatabase.h"
+
+namespace Contextual {
+
+namespace {
+
+const size_t g_CRITERIA_PER_RULE = 4;
+
+void BM_LoadDatabase(benchmark::State& state) {
+    const auto numRules = static_cast<size_t>(state.range(0));
+    // Generated outside the timed region and cached between runs
+    const std::string path = BenchmarkData::writeDatabase(numRules, g_CRITERIA_PER_RULE);
+    auto manager = BenchmarkData::createManager();
+
+    for (auto _ : state) {
+        RuleDatabase database(manager);
+        auto stats = DatabaseParser::loadDatabase(database, path);
+        if (stats.numRules != numRules) {
+            state.SkipWithError("Generated database did not load completely");
+            break;
+        }
+        benchmark::DoNotOptimize(stats);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * numRules));
+}
+BENCHMARK(BM_LoadDatabase)->ArgName("rules")->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace Contextual
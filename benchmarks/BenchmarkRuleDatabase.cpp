@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "BenchmarkData.h"
+#include "RuleDatabase.h"
+#include "ThreadPool.h"
+
+namespace Contextual {
+
+namespace {
+
+const size_t g_CRITERIA_PER_RULE = 4;
+const size_t g_NUM_QUERIES = 512;
+// Queries repeat these contexts, as when many NPCs are in the same situation
+const uint64_t g_NUM_CONTEXTS = 16;
+
+// Arguments are {number of rules, whether the table caches its candidates}
+void BM_QueryBestMatches(benchmark::State& state) {
+    auto manager = BenchmarkData::createManager();
+    auto ruleTable = std::make_unique<RuleTable>();
+    ruleTable->addEntries(BenchmarkData::createRules(state.range(0), g_CRITERIA_PER_RULE, 1234));
+    ruleTable->sortEntries();
+    if (state.range(1) != 0) {
+        ruleTable->enableCache(g_NUM_CONTEXTS);
+    }
+    RuleDatabase database(manager);
+    database.addRuleTable("Bench", "Rules", ruleTable);
+
+    std::vector<DatabaseQuery> queries;
+    queries.reserve(g_NUM_QUERIES);
+    for (size_t i = 0; i < g_NUM_QUERIES; ++i) {
+        queries.emplace_back(manager, "Bench", "Rules");
+        BenchmarkData::populateQuery(queries.back(), manager, (i % g_NUM_CONTEXTS) * 17 + 1);
+    }
+
+    ThreadPool threadPool;
+    std::vector<BestMatch> bestMatches;
+    std::vector<QueryReturnCode> returnCodes;
+    for (auto _ : state) {
+        database.queryBestMatches(bestMatches, returnCodes, queries, threadPool);
+        benchmark::DoNotOptimize(bestMatches.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * g_NUM_QUERIES));
+}
+BENCHMARK(BM_QueryBestMatches)
+    ->ArgNames({"rules", "cached"})
+    ->ArgsProduct({{1000, 10000}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace Contextual
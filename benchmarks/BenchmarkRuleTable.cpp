@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkData.h"
+#include "RuleTable.h"
+
+namespace Contextual {
+
+namespace {
+
+// Arguments are {number of rules, criteria per rule}
+void applyRuleTableArgs(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"rules", "criteria"});
+    benchmark->ArgsProduct({{100, 1000, 10000}, {1, 4, 8}});
+}
+
+class RuleTableFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override {
+        m_manager = BenchmarkData::createManager();
+        m_ruleTable = std::make_unique<RuleTable>();
+        m_ruleTable->addEntries(BenchmarkData::createRules(state.range(0), state.range(1), 1234));
+        m_ruleTable->sortEntries();
+        // Several distinct queries so the result is not dominated by a single lucky or unlucky context
+        m_queries.clear();
+        for (uint64_t i = 0; i < g_NUM_QUERIES; ++i) {
+            m_queries.emplace_back(m_manager, "Bench", "Rules");
+            BenchmarkData::populateQuery(m_queries.back(), m_manager, i * 17 + 1);
+        }
+    }
+
+    void TearDown(const benchmark::State&) override {
+        m_queries.clear();
+        m_ruleTable.reset();
+        m_manager.reset();
+    }
+
+protected:
+    static constexpr uint64_t g_NUM_QUERIES = 16;
+
+    std::shared_ptr<ContextManager> m_manager;
+    std::unique_ptr<RuleTable> m_ruleTable;
+    std::vector<DatabaseQuery> m_queries;
+};
+
+BENCHMARK_DEFINE_F(RuleTableFixture, QueryBest)(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m_ruleTable->queryBest(m_queries[i++ % m_queries.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(RuleTableFixture, QueryBest)->Apply(applyRuleTableArgs);
+
+BENCHMARK_DEFINE_F(RuleTableFixture, QueryBestScratch)(benchmark::State& state) {
+    QueryScratch scratch;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m_ruleTable->queryBest(scratch, m_queries[i++ % m_queries.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(RuleTableFixture, QueryBestScratch)->Apply(applyRuleTableArgs);
+
+BENCHMARK_DEFINE_F(RuleTableFixture, QueryUniform)(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m_ruleTable->queryUniform(m_queries[i++ % m_queries.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(RuleTableFixture, QueryUniform)->Apply(applyRuleTableArgs);
+
+BENCHMARK_DEFINE_F(RuleTableFixture, QueryWeighted)(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m_ruleTable->queryWeighted(m_queries[i++ % m_queries.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(RuleTableFixture, QueryWeighted)->Apply(applyRuleTableArgs);
+
+BENCHMARK_DEFINE_F(RuleTableFixture, QueryAllScratch)(benchmark::State& state) {
+    QueryScratch scratch;
+    size_t i = 0;
+    for (auto _ : state) {
+        m_ruleTable->queryAll(scratch, m_queries[i++ % m_queries.size()]);
+        benchmark::DoNotOptimize(scratch.matches.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(RuleTableFixture, QueryAllScratch)->Apply(applyRuleTableArgs);
+
+// Same queries repeating against an unchanged context, as with an NPC querying every tick
+BENCHMARK_DEFINE_F(RuleTableFixture, QueryBestCached)(benchmark::State& state) {
+    m_ruleTable->enableCache(g_NUM_QUERIES);
+    QueryScratch scratch;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m_ruleTable->queryBest(scratch, m_queries[i++ % m_queries.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(RuleTableFixture, QueryBestCached)->Apply(applyRuleTableArgs);
+
+}  // namespace
+
+}  // namespace Contextual
@@ -0,0 +1,120 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchmarkData.h"
+#include "ResponseSpeech.h"
+#include "SpeechGenerator.h"
+#include "SpeechSink.h"
+#include "SpeechTokenizer.h"
+
+namespace Contextual {
+
+namespace {
+
+const std::vector<std::string> g_SPEECH_LINES = {
+    "Hello there!",
+    "Hello #Listener.Name, my name is #Speaker.Name.",
+    "{speed=2}*Well* well... @upper(#Listener.Name), I did not expect you here.__ Welcome to #World.Place!",
+    "@capitalize(#Listener.Name)! @capitalize(@subjective(#Listener.Gender)) said it was @ord(#World.Day) "
+    "of the month, not the @ord(@add(#World.Day, 1)).",
+};
+
+class SpeechGeneratorFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override {
+        m_manager = BenchmarkData::createManager();
+        m_query = std::make_unique<DatabaseQuery>(m_manager, "Bench", "Speech");
+        BenchmarkData::populateQuery(*m_query, m_manager, 42);
+        auto speaker = m_query->getContextTable("Speaker");
+        speaker->set("Name", "Obi-Wan");
+        auto listener = m_query->getContextTable("Listener");
+        listener->set("Name", "Grievous");
+        listener->set("Gender", "male");
+        auto world = m_query->getContextTable("World");
+        world->set("Place", "Utapau");
+        world->set("Day", 19);
+
+        m_tokens.clear();
+        const std::unordered_map<std::string, std::shared_ptr<SymbolToken>> symbols;
+        const auto& line = g_SPEECH_LINES[state.range(0)];
+        auto result = SpeechTokenizer::tokenize(m_tokens, line, symbols, symbols, m_manager);
+        m_valid = result.code == SpeechTokenizerReturnCode::kSuccess;
+    }
+
+    void TearDown(const benchmark::State&) override {
+        m_tokens.clear();
+        m_query.reset();
+        m_manager.reset();
+    }
+
+protected:
+    std::shared_ptr<ContextManager> m_manager;
+    std::unique_ptr<DatabaseQuery> m_query;
+    std::vector<std::shared_ptr<SpeechToken>> m_tokens;
+    bool m_valid = false;
+};
+
+BENCHMARK_DEFINE_F(SpeechGeneratorFixture, GenerateLineFromTokens)(benchmark::State& state) {
+    if (!m_valid) {
+        state.SkipWithError("Failed to tokenize speech line");
+        return;
+    }
+    std::vector<std::shared_ptr<TextToken>> speechLine;
+    for (auto _ : state) {
+        speechLine.clear();
+        m_query->clearPrevChoices();
+        bool success = SpeechGenerator::generateLineFromTokens(speechLine, *m_query, m_tokens);
+        benchmark::DoNotOptimize(success);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(SpeechGeneratorFixture, GenerateLineFromTokens)
+    ->ArgName("line")
+    ->DenseRange(0, static_cast<int>(g_SPEECH_LINES.size()) - 1);
+
+BENCHMARK_DEFINE_F(SpeechGeneratorFixture, GenerateLineIntoString)(benchmark::State& state) {
+    if (!m_valid) {
+        state.SkipWithError("Failed to tokenize speech line");
+        return;
+    }
+    std::string text;
+    StringSpeechSink sink(text);
+    for (auto _ : state) {
+        text.clear();
+        m_query->clearPrevChoices();
+        bool success = SpeechGenerator::generateLineFromTokens(sink, *m_query, m_tokens);
+        benchmark::DoNotOptimize(success);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(SpeechGeneratorFixture, GenerateLineIntoString)
+    ->ArgName("line")
+    ->DenseRange(0, static_cast<int>(g_SPEECH_LINES.size()) - 1);
+
+BENCHMARK_DEFINE_F(SpeechGeneratorFixture, GenerateLineFromProgram)(benchmark::State& state) {
+    if (!m_valid) {
+        state.SkipWithError("Failed to tokenize speech line");
+        return;
+    }
+    auto speechResponse =
+        std::make_shared<ResponseSpeech>(std::vector<std::vector<std::shared_ptr<SpeechToken>>>{m_tokens});
+    std::string text;
+    StringSpeechSink sink(text);
+    for (auto _ : state) {
+        text.clear();
+        bool success = SpeechGenerator::generateLineFromResponse(sink, *m_query, speechResponse);
+        benchmark::DoNotOptimize(success);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(SpeechGeneratorFixture, GenerateLineFromProgram)
+    ->ArgName("line")
+    ->DenseRange(0, static_cast<int>(g_SPEECH_LINES.size()) - 1);
+
+}  // namespace
+
+}  // namespace Contextual
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// Process-wide mapping of context table and key names to dense IDs. Names are resolved once when rules and speech
+// lines are loaded, so queries only ever index by ID.
+namespace Contextual::ContextIds {
+
+int getTableId(const std::string& table);
+std::optional<int> findTableId(const std::string& table);
+const std::string& getTableName(int tableId);
+// Number of table IDs handed out so far; every table ID is below it
+int getNumTables();
+int getKeyId(const std::string& key);
+std::optional<int> findKeyId(const std::string& key);
+const std::string& getKeyName(int keyId);
+
+}  // namespace Contextual::ContextIds
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "ContextManager.h"
+#include "FactList.h"
 
 namespace Contextual {
 
@@ -28,30 +29,78 @@ public:
     void set(const std::string& key, std::unique_ptr<std::unordered_set<int>> listValue, bool isStringList);
     void set(const std::string& key, const std::unordered_set<const char*>& listValue);
     void set(const std::string& key, const std::unordered_set<std::string>& listValue);
+    void set(const std::string& key, FactList listValue, bool isStringList);
     void setRawValue(const std::string& key, float value, FactType type);
     void remove(const std::string& key);
     std::optional<std::string> getString(const std::string& key) const;
     std::optional<float> getFloat(const std::string& key) const;
     std::optional<int> getInt(const std::string& key) const;
     std::optional<bool> getBool(const std::string& key) const;
-    const std::unique_ptr<std::unordered_set<int>>& getList(const std::string& key) const;
+    // The returned list is invalidated when another list is set on this table
+    const FactList* getList(const std::string& key) const;
     std::optional<float> getRawValue(const std::string& key) const;
     std::optional<std::vector<std::string>> toStringList(const std::string& key) const;
     bool isStringList(const std::string& key) const;
     bool hasKey(const std::string& key) const;
     FactType getType(const std::string& key) const;
 
+    // Same as above, using key IDs from ContextIds
+    void set(int keyId, FactList listValue, bool isStringList);
+    void setRawValue(int keyId, float value, FactType type);
+    void remove(int keyId);
+    std::optional<std::string> getString(int keyId) const;
+    std::optional<float> getFloat(int keyId) const;
+    std::optional<int> getInt(int keyId) const;
+    std::optional<bool> getBool(int keyId) const;
+    const FactList* getList(int keyId) const;
+    std::optional<float> getRawValue(int keyId) const;
+    std::optional<std::vector<std::string>> toStringList(int keyId) const;
+    bool isStringList(int keyId) const;
+    bool hasKey(int keyId) const;
+    FactType getType(int keyId) const;
+
+    // Change tracking. Only writes that change a value count, and versions are drawn from one process-wide counter,
+    // so the same table never shows the same version with different facts, and two tables never share a nonzero
+    // version.
+    // Version of the last change to any key, or 0 if the table was never changed
+    uint64_t getVersion() const;
+    // Version of the last change to the key, including its removal, or 0 if it was never changed
+    uint64_t getKeyVersion(const std::string& key) const;
+    uint64_t getKeyVersion(int keyId) const;
+    // Keys changed since the last call to clearDirty, sorted by key ID
+    const std::vector<int>& getDirtyKeys() const;
+    bool isDirty(int keyId) const;
+    void clearDirty();
+
 private:
     struct FactTuple {
         FactType type;
         float value;
     };
 
+    struct ListTuple {
+        FactList list;
+        bool isStringList;
+    };
+
     std::shared_ptr<ContextManager> m_manager;
-    std::unordered_map<std::string, FactTuple> m_basicContext;
-    std::optional<std::unordered_map<std::string, std::pair<std::unique_ptr<std::unordered_set<int>>, bool>>>
-        m_listContext;
-    std::optional<FactTuple> getTuple(const std::string& key, FactType type) const;
+    // Parallel arrays sorted by key ID
+    std::vector<int> m_basicKeys;
+    std::vector<FactTuple> m_basicValues;
+    std::vector<int> m_listKeys;
+    std::vector<ListTuple> m_listValues;
+    uint64_t m_version = 0;
+    // Parallel arrays sorted by key ID. Removed keys stay, so their removal is still visible.
+    std::vector<int> m_versionKeys;
+    std::vector<uint64_t> m_keyVersions;
+    std::vector<int> m_dirtyKeys;
+    const FactTuple* findTuple(int keyId) const;
+    const ListTuple* findList(int keyId) const;
+    // Return true if the key was present
+    bool eraseTuple(int keyId);
+    bool eraseList(int keyId);
+    void markChanged(int keyId);
+    std::optional<FactTuple> getTuple(int keyId, FactType type) const;
 };
 
 }  // namespace Contextual
\ No newline at end of file
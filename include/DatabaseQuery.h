@@ -2,10 +2,11 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "ContextManager.h"
 #include "ContextTable.h"
+#include "Random.h"
 #include "Response.h"
 #include "StringTable.h"
 
@@ -20,14 +21,25 @@ public:
     enum class WillFail : uint8_t { kNormal, kAlways, kNever };
 
     explicit DatabaseQuery(std::shared_ptr<ContextManager>& manager, std::string group, std::string category);
+    // Creates a query with no context tables and a fixed seed, for evaluating calls whose arguments are all literals
+    explicit DatabaseQuery(std::shared_ptr<ContextManager>& manager);
     void addContextTable(const std::string& tableName, std::shared_ptr<ContextTable> contextTable);
-    std::shared_ptr<ContextTable> getContextTable(const std::string& tableName) const;
+    void addContextTable(int tableId, std::shared_ptr<ContextTable> contextTable);
+    const std::shared_ptr<ContextTable>& getContextTable(const std::string& tableName) const;
+    const std::shared_ptr<ContextTable>& getContextTable(int tableId) const;
+    // Non-owning access for evaluation, so reading a table never touches its reference count. Returns nullptr if no
+    // table was added under the given name or ID.
+    ContextTable* findContextTable(const std::string& tableName) const;
+    ContextTable* findContextTable(int tableId) const;
     void setWillFail(WillFail value);
     void clearPrevChoices();
     void addPrevChoice(size_t index, std::string choice);
     std::optional<std::string> getPrevChoice(int index) const;
     std::optional<size_t> getPrevChoiceIndex(int index) const;
     WillFail willFail() const;
+    // Seeds the generator used for every random choice made while matching and generating for this query
+    void setSeed(uint64_t seed);
+    Random& getRandom() const;
     StringTable& getStringTable();
     const std::unique_ptr<FunctionTable>& getFunctionTable() const;
     const std::string& getGroup() const;
@@ -39,8 +51,12 @@ private:
     std::string m_category;
     std::vector<std::string> m_prevChoices;
     std::vector<size_t> m_prevChoiceIndices;
-    std::unordered_map<std::string, std::shared_ptr<ContextTable>> m_contexts;
+    // Indexed by table ID, with a slot for every table known when the query is created
+    std::vector<std::shared_ptr<ContextTable>> m_contexts;
+    // Borrowed from m_contexts, slot for slot
+    std::vector<ContextTable*> m_tables;
     WillFail m_willFail;
+    mutable Random m_random;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RuleTable.h"
+
+namespace Contextual {
+
+// Immutable view of every rule table in a RuleDatabase at one point in time. Readers hold a snapshot for as long as
+// they need a consistent database; tables are freed once no snapshot refers to them anymore.
+class DatabaseSnapshot {
+public:
+    struct GroupCategory {
+        std::string group;
+        std::string category;
+    };
+
+    struct GroupCategoryHash {
+        std::size_t operator()(const GroupCategory& gc) const {
+            return std::hash<std::string>()(gc.group) ^ std::hash<std::string>()(gc.category);
+        }
+    };
+
+    struct GroupCategoryEquals {
+        bool operator()(const GroupCategory& gc1, const GroupCategory& gc2) const {
+            return gc1.group == gc2.group && gc1.category == gc2.category;
+        }
+    };
+
+    using TableMap =
+        std::unordered_map<GroupCategory, std::shared_ptr<const RuleTable>, GroupCategoryHash, GroupCategoryEquals>;
+
+    DatabaseSnapshot() = default;
+    DatabaseSnapshot(uint64_t version, TableMap tables);
+    // The returned pointer lives as long as the snapshot does
+    [[nodiscard]] const std::shared_ptr<const RuleTable>& getRuleTable(const std::string& group,
+                                                                       const std::string& category) const;
+    // Group and category of every table, sorted by group then category
+    [[nodiscard]] std::vector<std::pair<std::string, std::string>> getTableNames() const;
+    [[nodiscard]] const TableMap& getTables() const;
+    [[nodiscard]] size_t getNumTables() const;
+    // Incremented every time the database publishes a new snapshot
+    [[nodiscard]] uint64_t getVersion() const;
+
+private:
+    uint64_t m_version = 0;
+    TableMap m_tables;
+};
+
+}  // namespace Contextual
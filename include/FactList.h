@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace Contextual {
+
+// Sorted set of list fact values. Small lists are stored inline, larger lists spill to the heap.
+class FactList {
+public:
+    FactList() = default;
+    explicit FactList(const std::unordered_set<int>& values);
+    void insert(int value);
+    [[nodiscard]] bool contains(int value) const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] const int* begin() const;
+    [[nodiscard]] const int* end() const;
+
+private:
+    static constexpr uint32_t g_INLINE_CAPACITY = 6;
+
+    uint32_t m_size = 0;
+    int m_inline[g_INLINE_CAPACITY] = {};
+    std::vector<int> m_heap;
+};
+
+}  // namespace Contextual
\ No newline at end of file
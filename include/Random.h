@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Contextual {
+
+// Seedable xoshiro256** generator. Each DatabaseQuery owns one, so queries can run on any thread and a session can
+// be replayed exactly from its seeds.
+class Random {
+public:
+    explicit Random(uint64_t seed);
+    void seed(uint64_t seed);
+    uint64_t next();
+    // Uniform in [0, range) without modulo bias
+    uint32_t nextBounded(uint32_t range);
+    int randInt(int min, int max);
+    size_t randUInt(size_t min, size_t max);
+    float randFloat(float min, float max);
+
+private:
+    uint64_t m_state[4];
+};
+
+}  // namespace Contextual
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Checks one value against many [min, max] ranges at once. Uses AVX2 or SSE2 when the compiler targets them, unless
+// CONTEXTUAL_NO_SIMD is defined, and plain scalar code otherwise.
+namespace Contextual::RangeKernel {
+
+// Range arrays must be padded to a multiple of this many entries
+const size_t g_LANES = 8;
+const size_t g_WORD_BITS = 64;
+
+[[nodiscard]] size_t getPaddedCount(size_t count);
+[[nodiscard]] size_t getNumWords(size_t count);
+// Padding entries never contain any value
+[[nodiscard]] float getPaddingMin();
+[[nodiscard]] float getPaddingMax();
+// Sets bit i of matches if mins[i] <= value <= maxs[i]. count must be padded, and matches must hold getNumWords(count)
+// words. NaN never matches.
+void evaluate(float value, const float* mins, const float* maxs, size_t count, uint64_t* matches);
+[[nodiscard]] const char* getInstructionSet();
+
+}  // namespace Contextual::RangeKernel
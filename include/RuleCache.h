@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Contextual {
+
+// Memoizes which rules of a table pass their deterministic criteria, keyed by a fingerprint of the facts those
+// criteria read. A fingerprint holds the exact facts, so when a context table changes in a way that matters to the
+// rule table, the next query simply misses; stale entries are evicted oldest first once the cache is full. Safe to
+// use from several threads at once, and lookups only take a shared lock so concurrent hits do not serialize.
+class RuleCache {
+public:
+    explicit RuleCache(size_t capacity);
+    // Copy the candidate bitset stored for the fingerprint into candidates. Return true on a hit, false otherwise.
+    bool find(const std::vector<uint64_t>& fingerprint, std::vector<uint64_t>& candidates) const;
+    void insert(const std::vector<uint64_t>& fingerprint, const std::vector<uint64_t>& candidates);
+    void clear();
+    [[nodiscard]] size_t getCapacity() const;
+    [[nodiscard]] size_t getSize() const;
+    [[nodiscard]] size_t getNumHits() const;
+    [[nodiscard]] size_t getNumMisses() const;
+
+private:
+    struct FingerprintHash {
+        size_t operator()(const std::vector<uint64_t>& fingerprint) const;
+    };
+
+    using Map = std::unordered_map<std::vector<uint64_t>, std::vector<uint64_t>, FingerprintHash>;
+
+    size_t m_capacity;
+    mutable std::shared_mutex m_mutex;
+    Map m_entries;
+    // Keys in insertion order, for eviction. Points into m_entries, whose nodes never move.
+    std::deque<const std::vector<uint64_t>*> m_order;
+    mutable std::atomic<size_t> m_numHits = 0;
+    mutable std::atomic<size_t> m_numMisses = 0;
+};
+
+}  // namespace Contextual
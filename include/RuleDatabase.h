@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "DatabaseSnapshot.h"
 #include "ResponseSpeech.h"
 #include "RuleTable.h"
 #include "TextToken.h"
+#include "ThreadPool.h"
 
 namespace Contextual {
 
@@ -14,43 +19,61 @@ enum class RuleDatabaseReturnCode : uint32_t { kSuccess = 0, kAlreadyDefined = 1
 
 enum class QueryReturnCode { kSuccess, kFailure };
 
+// Replacement for one table in RuleDatabase::updateRuleTables. A null table removes it.
+struct RuleTableUpdate {
+    std::string group;
+    std::string category;
+    std::shared_ptr<const RuleTable> table;
+};
+
 class RuleDatabase {
 public:
     explicit RuleDatabase(std::shared_ptr<ContextManager> contextManager);
     virtual ~RuleDatabase() = default;
     RuleDatabaseReturnCode addRuleTable(const std::string& group, const std::string& category,
                                         std::unique_ptr<RuleTable>& ruleTable);
+    RuleDatabaseReturnCode addRuleTable(const std::string& group, const std::string& category,
+                                        std::shared_ptr<const RuleTable> ruleTable);
+    // Applies every update at once, so a concurrent query sees either all of the old tables or all of the new ones.
+    // Queries already running keep using the tables they started with.
+    void updateRuleTables(std::vector<RuleTableUpdate>& updates);
+    // Current tables of the database. Later updates do not affect a snapshot that has already been taken. Copying
+    // the pointer takes a short internal lock, but never waits for a writer to finish building an update.
+    [[nodiscard]] std::shared_ptr<const DatabaseSnapshot> getSnapshot() const;
+    [[nodiscard]] uint64_t getVersion() const;
     QueryReturnCode queryBestMatch(BestMatch& bestMatch, DatabaseQuery& query) const;
+    // Same as queryBestMatch for every query, spread across the pool. Queries are grouped by table so each worker
+    // stays on one table at a time. Results are written at the same index as their query.
+    void queryBestMatches(std::vector<BestMatch>& bestMatches, std::vector<QueryReturnCode>& returnCodes,
+                          std::vector<DatabaseQuery>& queries, ThreadPool& threadPool) const;
     QueryReturnCode queryUniformMatch(UniformMatch& uniformMatch, DatabaseQuery& query) const;
     QueryReturnCode queryWeightedMatch(WeightedMatch& weightedMatch, DatabaseQuery& query) const;
     QueryReturnCode querySimpleUniformMatch(SimpleUniformMatch& simpleUniformMatch, DatabaseQuery& query,
                                             const std::unordered_set<std::string>& skip, bool unique) const;
     QueryReturnCode querySimpledWeightedMatch(SimpleWeightedMatch& simpleWeightedMatch, DatabaseQuery& query,
                                               const std::unordered_set<std::string>& skip, bool unique) const;
-    const std::unique_ptr<RuleTable>& getRuleTable(const std::string& group, const std::string& category) const;
+    [[nodiscard]] std::shared_ptr<const RuleTable> getRuleTable(const std::string& group,
+                                                                const std::string& category) const;
+    // Group and category of every table, sorted by group then category
+    [[nodiscard]] std::vector<std::pair<std::string, std::string>> getTableNames() const;
     std::shared_ptr<ContextManager>& getContextManager();
+    // Capacity of the result cache of every table loaded from now on, see RuleTable::enableCache. 0, the default,
+    // disables it.
+    void setCacheCapacity(size_t capacity);
+    [[nodiscard]] size_t getCacheCapacity() const;
 
 private:
-    struct GroupCategory {
-        std::string group;
-        std::string category;
-    };
-
-    struct GroupCategoryHash {
-        std::size_t operator()(const GroupCategory& gc) const {
-            return std::hash<std::string>()(gc.group) ^ std::hash<std::string>()(gc.category);
-        }
-    };
-
-    struct GroupCategoryEquals {
-        bool operator()(const GroupCategory& gc1, const GroupCategory& gc2) const {
-            return gc1.group == gc2.group && gc1.category == gc2.category;
-        }
-    };
-
     std::shared_ptr<ContextManager> m_contextManager;
-    std::unordered_map<GroupCategory, std::unique_ptr<RuleTable>, GroupCategoryHash, GroupCategoryEquals>
-        m_groupCategoryToTable;
+    // Only accessed through the atomic shared_ptr functions, which guard the pointer copy with a short lock from a
+    // shared pool rather than being lock-free. Writers copy the current snapshot and publish a new one.
+    std::shared_ptr<const DatabaseSnapshot> m_snapshot;
+    std::mutex m_writeMutex;
+    size_t m_cacheCapacity = 0;
+
+    // Called with m_writeMutex held, once the table is known not to exist yet
+    void publishAdded(const DatabaseSnapshot& current, const std::string& group, const std::string& category,
+                      std::shared_ptr<const RuleTable> ruleTable);
+    void publish(uint64_t version, DatabaseSnapshot::TableMap tables);
 };
 
 }  // namespace Contextual
\ No newline at end of file
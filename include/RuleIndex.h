@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "criterion/CompiledCriteria.h"
+#include "criterion/Criterion.h"
+#include "DatabaseQuery.h"
+#include "FactList.h"
+
+namespace Contextual {
+
+struct Criteria;
+struct RuleEntry;
+
+// Discrimination network over the criteria of a sorted rule table. Criteria are grouped per (table, key) so each
+// fact is read at most once per query, and every distinct predicate is evaluated at most once. When a predicate
+// fails, its rule bitset is masked out of the surviving rules, so all rules that depend on it are pruned together
+// and skipped without being visited. Criteria are stored in compiled form, so matching never
+// goes through a virtual call. Static range predicates on the same fact are packed together and checked in one
+// vectorized pass the first time any of them is needed; the others then read their result from the bitmask.
+class RuleIndex {
+public:
+    struct FactState {
+        bool loaded = false;
+        bool exists = false;
+        std::optional<float> value;
+        const FactList* list = nullptr;
+        // Whether the range block of this key has been written to QueryState::rangeMatches
+        bool rangesEvaluated = false;
+    };
+
+    // Per-query scratch space; the index itself is immutable once built
+    struct QueryState {
+        std::vector<FactState> facts;
+        std::vector<int8_t> predicates;
+        // Bit i is cleared once the entry at index i is known to fail
+        std::vector<uint64_t> surviving;
+        // Match bitmasks of the range blocks, laid out like the index's invert masks
+        std::vector<uint64_t> rangeMatches;
+        // Set once every surviving entry is known to pass its predicates, so only residual criteria are left
+        bool predicatesResolved = false;
+    };
+
+    void build(const std::vector<std::shared_ptr<RuleEntry>>& entries);
+    void clear();
+    [[nodiscard]] bool isBuilt() const;
+    // Unique to each build of any index, so state derived from one build is never mistaken for another's
+    [[nodiscard]] uint64_t getBuildId() const;
+    // Context tables read by the predicates
+    [[nodiscard]] const std::vector<int>& getTableIds() const;
+    [[nodiscard]] QueryState createState() const;
+    // Same as createState, but reuses the buffers of an existing state
+    void resetState(QueryState& state) const;
+    // Return the index of the first entry at or after the given one that has not been pruned yet, or the number of
+    // entries if there is none
+    [[nodiscard]] size_t findNext(size_t entryIndex, const QueryState& state) const;
+    // Evaluate the predicates of every entry, leaving only entries that pass them in state.surviving
+    void resolvePredicates(const DatabaseQuery& query, QueryState& state) const;
+    // Write the facts read by the predicates into fingerprint. Queries with equal fingerprints resolve to the same
+    // surviving entries.
+    void fingerprint(const DatabaseQuery& query, std::vector<uint64_t>& fingerprint) const;
+    // Return true if all criteria of the entry at the given index match, false otherwise
+    [[nodiscard]] bool match(size_t entryIndex, const DatabaseQuery& query, QueryState& state) const;
+
+private:
+    struct IndexedKey {
+        int tableId;
+        int keyId;
+    };
+
+    struct Predicate {
+        CompiledCriterion criterion;
+        uint32_t keyIndex;
+        // Entries that use this predicate, as a bitset over words [firstWord, firstWord + numWords) of the entries
+        // stored at maskBegin in m_masks
+        uint32_t maskBegin;
+        uint32_t firstWord;
+        uint32_t numWords;
+        // Position in the range block of its key, for static predicates
+        uint32_t rangeSlot;
+    };
+
+    // Static predicates of one key, stored at [begin, begin + padded count) of the range arrays
+    struct RangeBlock {
+        uint32_t begin = 0;
+        uint32_t count = 0;
+        uint32_t wordBegin = 0;
+    };
+
+    struct IndexedEntry {
+        std::vector<uint32_t> predicates;
+        // Range in m_residual of the criteria that cannot be indexed, evaluated in their original order after the
+        // predicates pass
+        uint32_t residualBegin;
+        uint32_t residualEnd;
+    };
+
+    std::vector<IndexedKey> m_keys;
+    std::vector<Predicate> m_predicates;
+    std::vector<IndexedEntry> m_entries;
+    std::vector<CompiledCriterion> m_residual;
+    std::vector<uint64_t> m_masks;
+    // Indexed by key index
+    std::vector<RangeBlock> m_rangeBlocks;
+    std::vector<float> m_rangeMins;
+    std::vector<float> m_rangeMaxs;
+    std::vector<uint64_t> m_rangeInverts;
+    CompiledCriteria m_compiled;
+    std::vector<int> m_tableIds;
+    uint64_t m_buildId = 0;
+    bool m_built = false;
+
+    const FactState& loadFact(uint32_t keyIndex, const DatabaseQuery& query, QueryState& state) const;
+    bool evaluatePredicate(uint32_t predicateIndex, const DatabaseQuery& query, QueryState& state) const;
+    void evaluateRanges(uint32_t keyIndex, const DatabaseQuery& query, QueryState& state) const;
+    void setResult(uint32_t predicateIndex, bool passed, QueryState& state) const;
+    void buildMasks(const std::vector<std::vector<uint32_t>>& predicateEntries);
+    void buildRanges();
+};
+
+}  // namespace Contextual
\ No newline at end of file
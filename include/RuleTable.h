@@ -5,9 +5,12 @@
 #include <utility>
 #include <vector>
 
+#include "ContextIds.h"
 #include "criterion/Criterion.h"
 #include "DatabaseQuery.h"
 #include "response/Response.h"
+#include "RuleCache.h"
+#include "RuleIndex.h"
 
 namespace Contextual {
 
@@ -15,9 +18,15 @@ struct Criteria {
     std::string table;
     std::string key;
     std::shared_ptr<Criterion> criterion;
+    int tableId;
+    int keyId;
 
     Criteria(std::string table, std::string key, std::shared_ptr<Criterion> criterion)
-        : table(std::move(table)), key(std::move(key)), criterion(std::move(criterion)) {}
+        : table(std::move(table)),
+          key(std::move(key)),
+          criterion(std::move(criterion)),
+          tableId(ContextIds::getTableId(this->table)),
+          keyId(ContextIds::getKeyId(this->key)) {}
 };
 
 struct RuleEntry {
@@ -49,6 +58,25 @@ struct SimpleWeightedMatch {
     std::vector<std::pair<std::string, int>> weightedOptions;
 };
 
+// Reusable buffers for the scratch variants of the RuleTable queries. Keep one per thread and pass it to every query:
+// it grows to fit the largest table it has seen, after which querying allocates nothing.
+struct QueryScratch {
+    RuleIndex::QueryState indexState;
+    // Indices into RuleTable::getEntries of the matching entries, in table order
+    std::vector<uint32_t> matches;
+    // Options of matching simple responses with the priority of their entry. Points into the table's responses.
+    std::vector<std::pair<const std::string*, int>> simpleOptions;
+    // Used to drop repeated simple options
+    std::vector<uint32_t> order;
+    std::vector<bool> duplicates;
+    // Facts read by the table's predicates, when it has a cache
+    std::vector<uint64_t> fingerprint;
+    // Index build and context table versions the fingerprint was taken from. While none of them changed, the
+    // fingerprint is reused without reading any fact.
+    uint64_t fingerprintBuildId = 0;
+    std::vector<std::pair<const ContextTable*, uint64_t>> fingerprintVersions;
+};
+
 class RuleTable {
 public:
     RuleTable() = default;
@@ -56,6 +84,11 @@ public:
     void addEntry(std::shared_ptr<RuleEntry>& ruleEntry);
     void addEntries(const std::vector<std::shared_ptr<RuleEntry>>& ruleEntries);
     bool sortEntries();
+    // Remember which rules pass their deterministic criteria for up to capacity distinct sets of relevant facts.
+    // Repeated queries then only redo residual criteria, fail rolls and the random choice. 0 disables the cache.
+    void enableCache(size_t capacity);
+    // Null if the cache is disabled
+    [[nodiscard]] const RuleCache* getCache() const;
     [[nodiscard]] BestMatch queryBest(const DatabaseQuery& query) const;
     [[nodiscard]] UniformMatch queryUniform(const DatabaseQuery& query) const;
     [[nodiscard]] WeightedMatch queryWeighted(const DatabaseQuery& query) const;
@@ -64,12 +97,33 @@ public:
     [[nodiscard]] SimpleWeightedMatch querySimpleWeighted(const DatabaseQuery& query,
                                                           const std::unordered_set<std::string>& skip,
                                                           bool unique) const;
+    // The scratch variants below return entries of this table and pointers into them, so results stay valid only
+    // as long as the table does. They make the same random choices as the variants above.
+    // Return the chosen best matching entry, or null if none match
+    [[nodiscard]] const RuleEntry* queryBest(QueryScratch& scratch, const DatabaseQuery& query) const;
+    // Fill scratch.matches with every matching entry. Uniform and weighted queries read the entries' responses
+    // and priorities from there.
+    void queryAll(QueryScratch& scratch, const DatabaseQuery& query) const;
+    // Fill scratch.simpleOptions with the options of every matching simple response
+    void querySimple(QueryScratch& scratch, const DatabaseQuery& query, const std::unordered_set<std::string>& skip,
+                     bool unique) const;
     [[nodiscard]] size_t getNumEntries() const;
     [[nodiscard]] const std::vector<std::shared_ptr<RuleEntry>> getEntries() const;
+    [[nodiscard]] const RuleEntry& getEntry(size_t index) const;
 
 private:
     std::vector<std::shared_ptr<RuleEntry>> m_entries;
+    RuleIndex m_index;
+    std::unique_ptr<RuleCache> m_cache;
     bool m_sorted = false;
+
+    // Resets the index state, or restores the surviving entries from the cache
+    void prepareState(QueryScratch& scratch, const DatabaseQuery& query) const;
+    [[nodiscard]] bool isFingerprintCurrent(const QueryScratch& scratch, const DatabaseQuery& query) const;
+
+    // Skips entries already pruned by the index
+    [[nodiscard]] size_t nextCandidate(size_t index, const QueryScratch& scratch) const;
+    [[nodiscard]] bool matchEntry(size_t index, const DatabaseQuery& query, QueryScratch& scratch) const;
 };
 
 }  // namespace Contextual
\ No newline at end of file
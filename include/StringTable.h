@@ -1,24 +1,54 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace Contextual {
 
+// Interns strings as integer symbols. Safe to use from multiple threads: lookups and hits on strings that are
+// already cached never lock, and new strings are added under a single writer mutex.
 class StringTable {
 public:
+    // Symbols are handed out sequentially starting from this value
+    static constexpr int g_FIRST_SYMBOL = 1000;
+
     StringTable();
-    virtual ~StringTable() = default;
+    virtual ~StringTable();
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
 
-    int cache(const std::string& str);
-    std::optional<std::string> lookup(int symbol) const;
+    int cache(std::string_view str);
+    // The returned view stays valid for the lifetime of the table
+    std::optional<std::string_view> lookup(int symbol) const;
     size_t getSize() const;
 
 private:
-    std::unordered_map<std::string, int32_t> m_cache;
-    std::unordered_map<int32_t, std::string> m_lookup;
-    int32_t m_nextId;
+    // Open addressing table of (hash << 32 | symbol) entries, where 0 marks an empty slot
+    struct HashIndex {
+        explicit HashIndex(size_t capacity);
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    // Strings live in chunks that double in size and never move once allocated
+    static constexpr size_t g_NUM_CHUNKS = 32;
+
+    std::atomic<std::string*> m_chunks[g_NUM_CHUNKS];
+    std::atomic<HashIndex*> m_index;
+    std::atomic<uint32_t> m_size;
+    // Retired indices are kept alive since readers may still be probing them
+    std::vector<std::unique_ptr<HashIndex>> m_indices;
+    std::mutex m_writeMutex;
+
+    std::optional<int> find(std::string_view str, uint32_t hash) const;
+    const std::string* getString(uint32_t index) const;
+    void insertIndex(HashIndex& index, uint64_t entry) const;
 };
 
 }  // namespace Contextual
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Contextual {
+
+// Fixed set of worker threads for running batches of queries
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t numThreads = std::thread::hardware_concurrency());
+    virtual ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    // Run task(i) for every i in [0, count), blocking until all calls have finished. The calling thread helps, and
+    // tasks may call parallelFor again. If a task throws, no further indices are started and the first exception is
+    // rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+    [[nodiscard]] size_t getNumThreads() const;
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+
+    void workerLoop();
+};
+
+}  // namespace Contextual
\ No newline at end of file
@@ -15,5 +15,7 @@ struct AppSettings {
     std::optional<std::string> category;
     std::string queryType = "best";
     std::string inputDir = "./generated/compiled";
+    // Compiled database to write to, defaults to database.ctxdb inside the input directory
+    std::optional<std::string> outputFile;
     int count = 10;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of a compiled rule database. Every value is a native-endian 32-bit word, so the file can be read in place
+// once mapped. Objects are stored in pools and refer to each other by index, always to an earlier entry:
+//
+//   Header     magic, version, byte order mark, file size in bytes
+//   Strings    count, (offset, length) per string, blob size, blob padded to a word
+//   Symbols    count, string index per symbol of the StringTable in symbol order
+//   Tokens     count, tagged speech and symbol tokens
+//   Criterion  count, tagged criteria. Values that are string symbols are flagged as such, see the StringTable.
+//   Criteria   count, (table string, key string, criterion)
+//   Responses  count, tagged responses
+//   Entries    count, (id string, priority, response or g_NULL_INDEX, criteria count, criteria...)
+//   Tables     count, (group string, category string, entry count, entries...)
+namespace Contextual::CompiledFormat {
+
+constexpr char g_MAGIC[8] = {'C', 'T', 'X', 'D', 'B', '\0', '\0', '\0'};
+// Increment whenever the layout or any tag changes
+constexpr uint32_t g_VERSION = 2;
+constexpr uint32_t g_BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t g_NULL_INDEX = 0xFFFFFFFF;
+
+enum class TokenTag : uint32_t {
+    kLiteral,
+    kFormat,
+    kFormatBool,
+    kFormatFloat,
+    kFormatInt,
+    kFormatString,
+    kBoolean,
+    kInt,
+    kFloat,
+    kString,
+    kContext,
+    kFunction,
+    kList
+};
+
+enum class CriterionTag : uint32_t { kStatic, kAlternate, kDynamic, kExist, kIncludes, kEmpty, kFail };
+
+enum class ResponseTag : uint32_t {
+    kSimple,
+    kMultiple,
+    kSpeech,
+    kEvent,
+    kContextSetStatic,
+    kContextSetDynamic,
+    kContextSetList,
+    kContextAdd,
+    kContextMultiply,
+    kContextInvert
+};
+
+}  // namespace Contextual::CompiledFormat
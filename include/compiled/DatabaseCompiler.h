@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "RuleDatabase.h"
+
+namespace Contextual::DatabaseCompiler {
+
+enum class CompileReturnCode : uint32_t {
+    kSuccess,
+    kInvalidPath,
+    kInvalidFormat,
+    kVersionMismatch,
+    kUnsupportedType
+};
+
+struct CompileResult {
+    CompileReturnCode code;
+    std::string errorMsg;
+};
+
+struct CompileStats {
+    uint32_t numTables;
+    uint32_t numRules;
+};
+
+// Serializes every rule table of the database into a single binary file, along with the strings cached in its
+// string table. Objects shared between rules, such as inherited entries, named rule criteria and group symbols, are
+// written once and stay shared when loaded.
+CompileResult writeDatabase(CompileStats& stats, RuleDatabase& database, const std::string& path);
+// Loads a file written by writeDatabase. The file is memory-mapped and read in place, so no JSON is parsed and no
+// speech lines are tokenized. Symbols stored in the file are cached in the database's string table and remapped to
+// the IDs it assigns, so it may already hold other strings.
+CompileResult loadDatabase(CompileStats& stats, RuleDatabase& database, const std::string& path);
+
+}  // namespace Contextual::DatabaseCompiler
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Criterion.h"
+#include "DatabaseQuery.h"
+#include "FactList.h"
+
+namespace Contextual {
+
+// Flat form of a criterion and the fact it reads. Evaluated by a single switch instead of a virtual call, so rules
+// can keep their criteria inline in one contiguous array.
+struct CompiledCriterion {
+    struct Range {
+        float min;
+        float max;
+    };
+
+    // Slice of the owning CompiledCriteria's option pool
+    struct Options {
+        uint32_t begin;
+        uint32_t count;
+    };
+
+    struct Dynamic {
+        float minDelta;
+        float maxDelta;
+        int otherTableId;
+        int otherKeyId;
+    };
+
+    CriterionType type;
+    bool invert;
+    int tableId;
+    int keyId;
+    union {
+        Range range;              // kStatic
+        Options options;          // kAlternate, kIncludes
+        Dynamic dynamic;          // kDynamic
+        float chanceToFail;       // kFail
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<CompiledCriterion>);
+
+// Compiles criteria into CompiledCriterion and evaluates them. Holds the option lists they refer to, so a compiled
+// criterion is only meaningful together with the CompiledCriteria that made it.
+class CompiledCriteria {
+public:
+    [[nodiscard]] CompiledCriterion compile(int tableId, int keyId, const Criterion& criterion);
+    void clear();
+    // Same result as Criterion::evaluate, including the random roll of fail criteria
+    [[nodiscard]] bool evaluate(const CompiledCriterion& criterion, const DatabaseQuery& query) const;
+    // Comparisons against a fact that has already been read, for criteria that only depend on that fact
+    [[nodiscard]] bool compareValue(const CompiledCriterion& criterion, float value) const;
+    [[nodiscard]] bool compareList(const CompiledCriterion& criterion, const FactList& list) const;
+    [[nodiscard]] static bool compareExists(const CompiledCriterion& criterion, bool exists);
+
+private:
+    // Alternate options are sorted so they can be searched; includes options keep their order
+    std::vector<int> m_options;
+
+    [[nodiscard]] bool containsOption(const CompiledCriterion::Options& options, int value) const;
+};
+
+}  // namespace Contextual
@@ -1,24 +1,29 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 #include "DatabaseQuery.h"
 
 namespace Contextual {
 
+enum class CriterionType : uint8_t { kStatic, kAlternate, kDynamic, kExist, kIncludes, kEmpty, kFail };
+
 class Criterion {
 public:
     static int getCount();
-    [[nodiscard]] virtual bool evaluate(const std::string& table, const std::string& key,
-                                        const DatabaseQuery& query) const = 0;
+    [[nodiscard]] virtual bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const = 0;
     [[nodiscard]] virtual int getPriority() const = 0;
+    [[nodiscard]] virtual CriterionType getType() const = 0;
 
 protected:
     Criterion();
     ~Criterion();
 
 private:
-    static int count;
+    // Atomic since rules are parsed on several threads
+    static std::atomic<int> count;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -8,14 +8,18 @@ namespace Contextual {
 
 class CriterionAlternate : public CriterionFloatComparable {
 public:
-    CriterionAlternate(std::unordered_set<int> options, bool invert);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
+    // symbols holds the options that are string symbols rather than numbers
+    CriterionAlternate(std::unordered_set<int> options, bool invert, std::unordered_set<int> symbols = {});
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
     [[nodiscard]] bool compare(float value) const override;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
+    [[nodiscard]] const std::unordered_set<int>& getOptions() const;
+    [[nodiscard]] const std::unordered_set<int>& getSymbols() const;
 
 private:
     std::unordered_set<int> m_options;
+    std::unordered_set<int> m_symbols;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -9,16 +9,22 @@ namespace Contextual {
 class CriterionDynamic : public CriterionFloatComparable {
 public:
     CriterionDynamic(float min, float max, std::string otherTable, std::string otherName, bool invert);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
     [[nodiscard]] bool compare(float delta) const override;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
+    [[nodiscard]] float getMinDelta() const;
+    [[nodiscard]] float getMaxDelta() const;
+    [[nodiscard]] const std::string& getOtherTable() const;
+    [[nodiscard]] const std::string& getOtherKey() const;
 
 private:
     const float m_minDelta;
     const float m_maxDelta;
     const std::string m_otherTable;
     const std::string m_otherKey;
+    const int m_otherTableId;
+    const int m_otherKeyId;
 };
 
 }  // namespace Contextual
\ No newline at end of file
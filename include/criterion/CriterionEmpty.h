@@ -7,10 +7,10 @@ namespace Contextual {
 class CriterionEmpty : public CriterionListComparable {
 public:
     explicit CriterionEmpty(bool invert);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
-    [[nodiscard]] bool compare(const std::unordered_set<int>& value) const override;
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
+    [[nodiscard]] bool compare(const FactList& value) const override;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -7,9 +7,10 @@ namespace Contextual {
 class CriterionExist : public CriterionInvertible {
 public:
     explicit CriterionExist(bool invert);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
+    [[nodiscard]] bool compare(bool hasKey) const;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
 };
 
 }  // namespace Contextual
\ No newline at end of file
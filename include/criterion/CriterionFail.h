@@ -7,9 +7,10 @@ namespace Contextual {
 class CriterionFail : public Criterion {
 public:
     explicit CriterionFail(float chanceToFail);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
+    [[nodiscard]] float getChanceToFail() const;
 
 private:
     const float m_chanceToFail;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <unordered_set>
 #include <vector>
 
 #include "CriterionListComparable.h"
@@ -8,14 +9,18 @@ namespace Contextual {
 
 class CriterionIncludes : public CriterionListComparable {
 public:
-    CriterionIncludes(std::vector<int> options, bool invert);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
-    [[nodiscard]] bool compare(const std::unordered_set<int>& value) const override;
+    // symbols holds the options that are string symbols rather than numbers
+    CriterionIncludes(std::vector<int> options, bool invert, std::unordered_set<int> symbols = {});
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
+    [[nodiscard]] bool compare(const FactList& value) const override;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
+    [[nodiscard]] const std::vector<int>& getOptions() const;
+    [[nodiscard]] const std::unordered_set<int>& getSymbols() const;
 
 private:
     std::vector<int> m_options;
+    std::unordered_set<int> m_symbols;
 };
 
 }  // namespace Contextual
\ No newline at end of file
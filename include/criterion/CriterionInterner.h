@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "Criterion.h"
+#include "RuleTable.h"
+
+namespace Contextual {
+
+// Hash-conses criteria while a database is parsed, so every structurally identical criterion and every identical
+// (table, key, criterion) triple is stored once no matter how many rules, categories or groups use it. Rules that
+// share criteria objects also share predicates in the rule index. Safe to use from several parsing threads at once.
+class CriterionInterner {
+public:
+    // Return the stored criterion equal to the given one, storing it first if there is none
+    [[nodiscard]] std::shared_ptr<Criterion> intern(const std::shared_ptr<Criterion>& criterion);
+    // Return the stored criteria for this table, key and criterion, storing it first if there is none
+    [[nodiscard]] std::shared_ptr<Criteria> intern(const std::string& table, const std::string& key,
+                                                   const std::shared_ptr<Criterion>& criterion);
+    // Forget every stored criterion and criteria that nothing but the interner refers to anymore, such as those of
+    // tables replaced by a reload. Criteria still held by a snapshot are kept until a later call.
+    void prune();
+    [[nodiscard]] size_t getNumCriterions() const;
+    [[nodiscard]] size_t getNumCriteria() const;
+
+private:
+    struct SignatureHash {
+        size_t operator()(const std::vector<uint32_t>& signature) const;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::vector<uint32_t>, std::shared_ptr<Criterion>, SignatureHash> m_criterions;
+    std::map<std::tuple<int, int, const Criterion*>, std::shared_ptr<Criteria>> m_criteria;
+
+    [[nodiscard]] std::shared_ptr<Criterion> internLocked(const std::shared_ptr<Criterion>& criterion);
+};
+
+}  // namespace Contextual
@@ -5,6 +5,9 @@
 namespace Contextual {
 
 class CriterionInvertible : public Criterion {
+public:
+    [[nodiscard]] bool isInverted() const;
+
 protected:
     explicit CriterionInvertible(bool invert);
     bool m_invert;
@@ -1,14 +1,13 @@
 #pragma once
 
-#include <unordered_set>
-
 #include "CriterionInvertible.h"
+#include "FactList.h"
 
 namespace Contextual {
 
 class CriterionListComparable : public CriterionInvertible {
 public:
-    [[nodiscard]] virtual bool compare(const std::unordered_set<int>& value) const = 0;
+    [[nodiscard]] virtual bool compare(const FactList& value) const = 0;
 
 protected:
     explicit CriterionListComparable(bool invert);
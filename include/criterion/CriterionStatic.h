@@ -6,15 +6,20 @@ namespace Contextual {
 
 class CriterionStatic : public CriterionFloatComparable {
 public:
-    CriterionStatic(float min, float max, bool invert);
-    [[nodiscard]] bool evaluate(const std::string& table, const std::string& key,
-                                const DatabaseQuery& query) const override;
+    // isSymbol marks a range holding a single string symbol rather than a number
+    CriterionStatic(float min, float max, bool invert, bool isSymbol = false);
+    [[nodiscard]] bool evaluate(int tableId, int keyId, const DatabaseQuery& query) const override;
     [[nodiscard]] bool compare(float value) const override;
     [[nodiscard]] int getPriority() const override;
+    [[nodiscard]] CriterionType getType() const override;
+    [[nodiscard]] float getMin() const;
+    [[nodiscard]] float getMax() const;
+    [[nodiscard]] bool isSymbol() const;
 
 private:
     const float m_min;
     const float m_max;
+    const bool m_isSymbol;
 };
 
 }  // namespace Contextual
\ No newline at end of file
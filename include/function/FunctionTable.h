@@ -2,6 +2,7 @@
 
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -11,8 +12,10 @@
 
 namespace Contextual {
 
+class ContextManager;
 class DatabaseQuery;
 class SymbolToken;
+class TokenFunction;
 
 struct FunctionVal {
     bool error;
@@ -59,6 +62,11 @@ struct FunctionSig {
     TokenType returnType;
     std::vector<TokenType> argTypes;
     bool hasVarArgs;
+    // Pure functions always return the same value for the same arguments and never read the query, so calls with
+    // literal arguments are folded when they are parsed
+    bool isPure;
+    // Chosen by the table when registering the function and passed back to doCall
+    int id;
 };
 
 class FunctionTable {
@@ -68,17 +76,32 @@ public:
                              const std::vector<std::shared_ptr<SymbolToken>>& args);
     static bool matches(TokenType targetType, TokenType type);
     virtual void initialize() = 0;
+    // Returns nullptr if no function is registered under the given name
     const std::unique_ptr<FunctionSig>& getSignature(const std::string& name) const;
     FunctionVal call(const std::string& name, const std::vector<std::shared_ptr<SymbolToken>>& args,
                      DatabaseQuery& query) const;
+    // Calls a function resolved through getSignature with arguments that were already validated against it, without
+    // looking up its name
+    FunctionVal call(const FunctionSig& sig, const std::vector<std::shared_ptr<SymbolToken>>& args,
+                     DatabaseQuery& query) const;
+    FunctionVal call(const TokenFunction& token, DatabaseQuery& query) const;
+    // Returns the literal token that a call to a pure function with only literal arguments always evaluates to, or
+    // nullptr if the call has to be made at runtime. The call is made against the manager the function is parsed for.
+    std::shared_ptr<SymbolToken> fold(const FunctionSig& sig, const std::vector<std::shared_ptr<SymbolToken>>& args,
+                                      std::shared_ptr<ContextManager>& contextManager) const;
+    // Convert the result of a call to the text it stands for in a speech line, moving out any string it holds
+    static std::optional<std::string> valueToString(FunctionVal&& val, DatabaseQuery& query);
 
 protected:
-    void registerFunction(std::string, TokenType returnType, std::vector<TokenType> argTypes, bool hasVarArgs);
-    virtual FunctionVal doCall(const std::string& name, const std::vector<std::shared_ptr<SymbolToken>>& args,
+    void registerFunction(int id, std::string name, TokenType returnType, std::vector<TokenType> argTypes,
+                          bool hasVarArgs, bool isPure = false);
+    virtual FunctionVal doCall(int functionId, const std::vector<std::shared_ptr<SymbolToken>>& args,
                                DatabaseQuery& query) const = 0;
     std::optional<std::string> argToString(const std::shared_ptr<SymbolToken>& token, DatabaseQuery& query) const;
     std::optional<std::pair<std::vector<int>, bool>> argToList(const std::shared_ptr<SymbolToken>& token,
                                                                DatabaseQuery& query) const;
+    // Same as argToList(token, query)->first.size(), but reads context lists in place instead of copying them
+    std::optional<size_t> argToListSize(const std::shared_ptr<SymbolToken>& token, DatabaseQuery& query) const;
     std::optional<int> argToListItem(bool& isString, const std::shared_ptr<SymbolToken>& token,
                                      DatabaseQuery& query) const;
     std::optional<int> argToInt(const std::shared_ptr<SymbolToken>& token, DatabaseQuery& query) const;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Contextual::Gen {
+
+// Relative weights of each criterion type. A weight of zero disables that type.
+struct CriterionMix {
+    int equals = 8;
+    int alternate = 2;
+    int range = 4;
+    int compare = 3;
+    int dynamic = 1;
+    int exists = 2;
+    int includes = 1;
+    int empty = 1;
+    int named = 2;
+    int fail = 1;
+};
+
+struct GeneratorSettings {
+    uint64_t seed = 1;
+    // Groups are laid out in inheritance chains of this depth, each group naming the previous one as its Parent
+    uint32_t numGroups = 4;
+    uint32_t inheritanceDepth = 1;
+    uint32_t numCategories = 4;
+    uint32_t rulesPerCategory = 100;
+    uint32_t minCriteria = 1;
+    uint32_t maxCriteria = 4;
+    CriterionMix criterionMix;
+    // Named rules in each group's Preset category, referenced by Named criteria
+    uint32_t numPresets = 4;
+    uint32_t numSymbols = 4;
+    uint32_t linesPerRule = 2;
+    // Number of text, context, symbol, function and formatting pieces per speech line
+    uint32_t minLineTokens = 2;
+    uint32_t maxLineTokens = 6;
+    // Context vocabulary: every table has numeric keys Key0..KeyN as well as the Name and Tags keys
+    std::vector<std::string> tables = {"Speaker", "Listener", "World"};
+    uint32_t numKeys = 32;
+    uint32_t numValues = 8;
+    // Share of categories that opt out of inheriting their parent's rules
+    float noInheritChance = 0.0f;
+};
+
+struct GeneratorStats {
+    uint32_t numGroups;
+    uint32_t numCategories;
+    uint32_t numRules;
+};
+
+enum class GeneratorReturnCode { kSuccess, kInvalidSettings, kInvalidPath };
+
+struct GeneratorResult {
+    GeneratorReturnCode code;
+    std::string errorMsg;
+};
+
+// Writes one group JSON file per group into outDir, in the format read by DatabaseParser::loadDatabase. Output is
+// fully determined by the settings, so the same seed always produces the same files.
+GeneratorResult generateDatabase(GeneratorStats& stats, const GeneratorSettings& settings, const std::string& outDir);
+// Same as above for a single group, returned as a JSON string. Groups with an index that is not a multiple of the
+// inheritance depth name the previous group as their parent.
+std::string generateGroup(const GeneratorSettings& settings, uint32_t groupIndex);
+std::string getGroupName(uint32_t groupIndex);
+std::string getCategoryName(uint32_t categoryIndex);
+
+}  // namespace Contextual::Gen
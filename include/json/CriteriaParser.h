@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 
+#include "CriterionInterner.h"
 #include "JsonUtils.h"
 #include "Response.h"
 #include "RuleTable.h"
@@ -18,8 +19,8 @@ struct RuleInfo {
 
 namespace CriteriaParser {
 
-JsonParseResult parseCriteria(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority, StringTable& stringTable,
-                              const rapidjson::Value& root,
+JsonParseResult parseCriteria(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                              int& priority, StringTable& stringTable, const rapidjson::Value& root,
                               const std::unordered_map<std::string, RuleInfo>& namedRules);
 
 }  // namespace CriteriaParser
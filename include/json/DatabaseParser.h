@@ -1,9 +1,11 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "JsonUtils.h"
 #include "RuleDatabase.h"
+#include "ThreadPool.h"
 
 namespace Contextual::DatabaseParser {
 
@@ -16,6 +18,32 @@ struct DatabaseStats {
 
 enum class ParsingType : uint8_t { kDefault, kSpeechbank, kSimple };
 
+// Loads groups into a database and remembers them, so that a single group file can later be reloaded without
+// rebuilding the rest of the database. Loading and reloading must happen on one thread at a time, but queries can
+// keep running against the database throughout.
+class DatabaseLoader {
+public:
+    explicit DatabaseLoader(RuleDatabase& database);
+    DatabaseLoader(RuleDatabase& database, ThreadPool& threadPool);
+    virtual ~DatabaseLoader();
+    DatabaseLoader(const DatabaseLoader&) = delete;
+    DatabaseLoader& operator=(const DatabaseLoader&) = delete;
+    DatabaseStats loadDatabase(const std::string& dirPath);
+    // Re-parses the group file at the path and rebuilds every group that inherits from it, then swaps all of their
+    // tables into the database at once. If anything fails to parse, the database is left untouched.
+    JsonParseResult reloadGroup(DatabaseStats& stats, const std::string& path);
+
+private:
+    struct State;
+    std::unique_ptr<State> m_state;
+
+    JsonParseResult rebuildGroup(DatabaseStats& stats, const std::string& path);
+};
+
 JsonParseResult loadGroup(RuleDatabase& out, const std::string& path);
+// Loads every group file under the directory. Files are read and parsed in parallel, and each group is built as soon
+// as its own parent has loaded, so independent groups and inheritance subtrees load concurrently. If several files
+// define the same group, the first one in path order wins.
 DatabaseStats loadDatabase(RuleDatabase& out, const std::string& dirPath);
+DatabaseStats loadDatabase(RuleDatabase& out, const std::string& dirPath, ThreadPool& threadPool);
 }  // namespace Contextual::RuleParser
\ No newline at end of file
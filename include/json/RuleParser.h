@@ -9,10 +9,10 @@
 
 namespace Contextual::RuleParser {
 
-JsonParseResult parseRule(StringTable& stringTable, std::shared_ptr<RuleEntry>& rule,
+JsonParseResult parseRule(StringTable& stringTable, CriterionInterner& interner, std::shared_ptr<RuleEntry>& rule,
                           std::unordered_map<std::string, RuleInfo>& namedRules, int& nextId,
                           const rapidjson::Value& root, const std::string& idPrefix, DatabaseParser::ParsingType parsingType,
                           const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
-                          const std::unique_ptr<FunctionTable>& functionTable);
+                          std::shared_ptr<ContextManager>& contextManager);
 
 }  // namespace Contextual::RuleParser
\ No newline at end of file
@@ -13,7 +13,7 @@ namespace Contextual::SymbolParser {
 JsonParseResult parseSymbols(
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols, const rapidjson::Value& root,
     const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-    const std::unique_ptr<FunctionTable>& functionTable);
+    std::shared_ptr<ContextManager>& contextManager);
 std::string tokenTypeToString(TokenType type);
 
 }  // namespace Contextual::SymbolParser
\ No newline at end of file
@@ -12,10 +12,14 @@ public:
     ResponseContext(std::string table, std::string key);
     virtual void execute(DatabaseQuery& query) = 0;
     [[nodiscard]] ResponseType getType() const override;
+    [[nodiscard]] const std::string& getTable() const;
+    [[nodiscard]] const std::string& getKey() const;
 
 protected:
     std::string m_table;
     std::string m_key;
+    int m_tableId;
+    int m_keyId;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -8,6 +8,7 @@ class ResponseContextMultiply : public ResponseContext {
 public:
     ResponseContextMultiply(std::string table, std::string key, float value);
     void execute(DatabaseQuery& query) override;
+    [[nodiscard]] float getValue() const;
 
 private:
     float m_value;
@@ -8,10 +8,14 @@ class ResponseContextSetDynamic : public ResponseContext {
 public:
     ResponseContextSetDynamic(std::string table, std::string key, std::string otherTable, std::string otherKey);
     void execute(DatabaseQuery& query) override;
+    [[nodiscard]] const std::string& getOtherTable() const;
+    [[nodiscard]] const std::string& getOtherKey() const;
 
 private:
     std::string m_otherTable;
     std::string m_otherKey;
+    int m_otherTableId;
+    int m_otherKeyId;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -7,10 +7,13 @@ namespace Contextual {
 class ResponseContextSetList : public ResponseContext {
 public:
     ResponseContextSetList(std::string table, std::string key, std::unordered_set<int> value, bool isStringList);
+    ResponseContextSetList(std::string table, std::string key, FactList value, bool isStringList);
     void execute(DatabaseQuery& query) override;
+    [[nodiscard]] const FactList& getValue() const;
+    [[nodiscard]] bool isStringList() const;
 
 private:
-    std::unordered_set<int> m_value;
+    FactList m_value;
     bool m_isStringList;
 };
 
@@ -8,6 +8,8 @@ class ResponseContextSetStatic : public ResponseContext {
 public:
     ResponseContextSetStatic(std::string table, std::string key, FactType type, float value);
     void execute(DatabaseQuery& query) override;
+    [[nodiscard]] FactType getFactType() const;
+    [[nodiscard]] float getValue() const;
 
 private:
     FactType m_type;
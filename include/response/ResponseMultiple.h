@@ -10,7 +10,7 @@ namespace Contextual {
 class ResponseMultiple : public Response {
 public:
     explicit ResponseMultiple(std::vector<std::shared_ptr<Response>> responses);
-    [[nodiscard]] std::vector<std::shared_ptr<Response>> getResponses() const;
+    [[nodiscard]] const std::vector<std::shared_ptr<Response>>& getResponses() const;
     [[nodiscard]] ResponseType getType() const override;
 
 private:
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 
+#include "Random.h"
 #include "Response.h"
 
 namespace Contextual {
@@ -11,6 +12,7 @@ class ResponseSimple : public Response {
 public:
     explicit ResponseSimple(std::vector<std::string> options);
     [[nodiscard]] const std::string& getRandomOption() const;
+    [[nodiscard]] const std::string& getRandomOption(Random& random) const;
     [[nodiscard]] const std::vector<std::string>& getOptions() const;
     [[nodiscard]] ResponseType getType() const override;
 
@@ -3,7 +3,9 @@
 #include <vector>
 
 #include "DatabaseQuery.h"
+#include "Random.h"
 #include "Response.h"
+#include "SpeechProgram.h"
 #include "SpeechToken.h"
 
 namespace Contextual {
@@ -12,10 +14,15 @@ class ResponseSpeech : public Response {
 public:
     explicit ResponseSpeech(std::vector<std::vector<std::shared_ptr<SpeechToken>>> speechLines);
     [[nodiscard]] const std::vector<std::shared_ptr<SpeechToken>>& getRandomLine() const;
+    [[nodiscard]] const std::vector<std::shared_ptr<SpeechToken>>& getRandomLine(Random& random) const;
     [[nodiscard]] ResponseType getType() const override;
+    [[nodiscard]] const std::vector<std::vector<std::shared_ptr<SpeechToken>>>& getSpeechLines() const;
+    // The speech lines compiled when the response was created, in the same order
+    [[nodiscard]] const SpeechProgram& getProgram() const;
 
 private:
     std::vector<std::vector<std::shared_ptr<SpeechToken>>> m_speechLines;
+    SpeechProgram m_program;
 };
 
 }  // namespace Contextual
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include "DatabaseQuery.h"
 #include "ResponseSpeech.h"
+#include "SpeechProgram.h"
+#include "SpeechSink.h"
 #include "SpeechToken.h"
 #include "TextToken.h"
 
@@ -22,6 +24,16 @@ bool generateLineFromResponse(std::vector<std::shared_ptr<TextToken>>& speechLin
                               const std::shared_ptr<ResponseSpeech>& speechResponse);
 bool generateLineFromTokens(std::vector<std::shared_ptr<TextToken>>& speechLine, DatabaseQuery& query,
                             const std::vector<std::shared_ptr<SpeechToken>>& speechTokens);
+// Same as the above, but write the line into a sink as it is generated. A failed attempt is rolled back, so the sink
+// only ever keeps the text of the line that succeeds.
+SpeechGeneratorReturnCode performSpeechResponse(SpeechSink& sink, std::shared_ptr<ResponseSpeech>& speechResponse,
+                                                DatabaseQuery& query, const std::shared_ptr<Response>& response);
+bool generateLineFromResponse(SpeechSink& sink, DatabaseQuery& query,
+                              const std::shared_ptr<ResponseSpeech>& speechResponse);
+bool generateLineFromTokens(SpeechSink& sink, DatabaseQuery& query,
+                            const std::vector<std::shared_ptr<SpeechToken>>& speechTokens);
+// Generate the line at the given index of a compiled program, the way generateLineFromTokens would for its tokens
+bool generateLineFromProgram(SpeechSink& sink, DatabaseQuery& query, const SpeechProgram& program, size_t lineIndex);
 std::string getRawSpeechLine(const std::vector<std::shared_ptr<TextToken>>& speechLine);
 std::string integerToOrdinal(int num);
 std::string integerToWord(int num);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SpeechToken.h"
+#include "SymbolToken.h"
+#include "TextToken.h"
+
+namespace Contextual {
+
+// Speech lines compiled into flat instructions, with all constant text in one pool. Generating a line is then a single
+// pass over plain structs instead of a walk over polymorphic tokens.
+class SpeechProgram {
+public:
+    enum class Op : uint8_t { kText, kFormat, kSymbol, kList };
+
+    struct Instruction {
+        Op op;
+        // Offset into the text pool for kText, or index of the format or symbol
+        uint32_t index;
+        // Length of the text for kText, or the slot of the list within its line for kList
+        uint32_t arg;
+    };
+
+    struct Line {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        // Number of distinct lists, which are sampled without replacement within the line
+        uint32_t numLists = 0;
+        // Lines without any symbol never generate
+        bool hasText = false;
+    };
+
+    void compile(const std::vector<std::vector<std::shared_ptr<SpeechToken>>>& speechLines);
+    [[nodiscard]] size_t getNumLines() const;
+    [[nodiscard]] const Line& getLine(size_t lineIndex) const;
+    [[nodiscard]] const Instruction& getInstruction(size_t instructionIndex) const;
+    [[nodiscard]] std::string_view getText(const Instruction& instruction) const;
+    [[nodiscard]] const std::shared_ptr<TextToken>& getFormat(const Instruction& instruction) const;
+    [[nodiscard]] const SymbolToken& getSymbol(const Instruction& instruction) const;
+
+private:
+    std::vector<Instruction> m_instructions;
+    std::vector<Line> m_lines;
+    std::string m_text;
+    std::vector<std::shared_ptr<TextToken>> m_formats;
+    std::vector<std::shared_ptr<SymbolToken>> m_symbols;
+
+    void appendText(std::string_view text);
+};
+
+}  // namespace Contextual
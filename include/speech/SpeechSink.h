@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TextToken.h"
+
+namespace Contextual {
+
+// Receives a speech line as it is generated, so it can be rendered straight into the caller's own buffer instead of
+// going through an intermediate token list
+class SpeechSink {
+public:
+    virtual ~SpeechSink() = default;
+    // Called before each attempt at generating a line
+    virtual void begin() = 0;
+    // The text is only valid for the duration of the call
+    virtual void writeText(std::string_view text) = 0;
+    // Formatting tokens are shared with the speech line they come from
+    virtual void writeFormat(const std::shared_ptr<TextToken>& format) = 0;
+    // Drop everything written since the last call to begin, after an attempt fails partway through the line
+    virtual void rollback() = 0;
+};
+
+// Appends the raw text of the line to a string, ignoring formatting
+class StringSpeechSink : public SpeechSink {
+public:
+    explicit StringSpeechSink(std::string& out);
+    void begin() override;
+    void writeText(std::string_view text) override;
+    void writeFormat(const std::shared_ptr<TextToken>& format) override;
+    void rollback() override;
+
+private:
+    std::string& m_out;
+    size_t m_begin = 0;
+};
+
+// Appends the line to a list of text tokens, with a literal for each piece of text
+class TokenSpeechSink : public SpeechSink {
+public:
+    explicit TokenSpeechSink(std::vector<std::shared_ptr<TextToken>>& out);
+    void begin() override;
+    void writeText(std::string_view text) override;
+    void writeFormat(const std::shared_ptr<TextToken>& format) override;
+    void rollback() override;
+
+private:
+    std::vector<std::shared_ptr<TextToken>>& m_out;
+    size_t m_begin = 0;
+};
+
+}  // namespace Contextual
@@ -27,7 +27,7 @@ namespace SpeechTokenizer {
 SpeechTokenizerResult tokenize(std::vector<std::shared_ptr<SpeechToken>>& tokens, const std::string& text,
                                const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                               const std::unique_ptr<FunctionTable>& functionTable);
+                               std::shared_ptr<ContextManager>& contextManager);
 
 }
 
@@ -12,10 +12,14 @@ public:
     [[nodiscard]] std::string toString() const override;
     [[nodiscard]] const std::string& getTable() const;
     [[nodiscard]] const std::string& getKey() const;
+    [[nodiscard]] int getTableId() const;
+    [[nodiscard]] int getKeyId() const;
 
 private:
     const std::string m_table;
     const std::string m_key;
+    const int m_tableId;
+    const int m_keyId;
 };
 
 }  // namespace Contextual
\ No newline at end of file
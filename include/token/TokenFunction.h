@@ -7,18 +7,25 @@
 
 namespace Contextual {
 
+struct FunctionSig;
+
 class TokenFunction : public SymbolToken {
 public:
-    TokenFunction(std::string name, std::vector<std::shared_ptr<SymbolToken>> args);
+    // The signature is the function resolved when the token was parsed, with the arguments already validated against
+    // it. It must belong to the function table of the queries that evaluate this token. Without it, the function is
+    // looked up by name on every call.
+    TokenFunction(std::string name, std::vector<std::shared_ptr<SymbolToken>> args, const FunctionSig* sig = nullptr);
     [[nodiscard]] std::optional<std::string> evaluate(DatabaseQuery& query) const override;
     [[nodiscard]] TokenType getType() const override;
     [[nodiscard]] std::string toString() const override;
     [[nodiscard]] const std::string& getName() const;
     [[nodiscard]] const std::vector<std::shared_ptr<SymbolToken>>& getArgs() const;
+    [[nodiscard]] const FunctionSig* getSignature() const;
 
 private:
     const std::string m_name;
     const std::vector<std::shared_ptr<SymbolToken>> m_args;
+    const FunctionSig* const m_sig;
 };
 
 }  // namespace Contextual
\ No newline at end of file
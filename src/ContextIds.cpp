@@ -0,0 +1,100 @@
+#include "ContextIds.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Contextual::ContextIds {
+
+namespace {
+const std::string g_NOT_FOUND;
+
+class NameRegistry {
+public:
+    int getId(const std::string& name) {
+        {
+            std::shared_lock lock(m_mutex);
+            auto got = m_ids.find(name);
+            if (got != m_ids.end()) {
+                return got->second;
+            }
+        }
+        std::unique_lock lock(m_mutex);
+        auto [it, inserted] = m_ids.try_emplace(name, static_cast<int>(m_names.size()));
+        if (inserted) {
+            m_names.push_back(name);
+        }
+        return it->second;
+    }
+
+    std::optional<int> findId(const std::string& name) const {
+        std::shared_lock lock(m_mutex);
+        auto got = m_ids.find(name);
+        if (got == m_ids.end()) {
+            return std::nullopt;
+        }
+        return got->second;
+    }
+
+    // Names are never removed and deque elements never move, so the reference stays valid
+    const std::string& getName(const int id) const {
+        std::shared_lock lock(m_mutex);
+        if (id < 0 || static_cast<size_t>(id) >= m_names.size()) {
+            return g_NOT_FOUND;
+        }
+        return m_names[id];
+    }
+
+    int getSize() const {
+        std::shared_lock lock(m_mutex);
+        return static_cast<int>(m_names.size());
+    }
+
+private:
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, int> m_ids;
+    std::deque<std::string> m_names;
+};
+
+NameRegistry& tables() {
+    static NameRegistry registry;
+    return registry;
+}
+
+NameRegistry& keys() {
+    static NameRegistry registry;
+    return registry;
+}
+
+}  // namespace
+
+int getTableId(const std::string& table) {
+    return tables().getId(table);
+}
+
+std::optional<int> findTableId(const std::string& table) {
+    return tables().findId(table);
+}
+
+const std::string& getTableName(const int tableId) {
+    return tables().getName(tableId);
+}
+
+int getNumTables() {
+    return tables().getSize();
+}
+
+int getKeyId(const std::string& key) {
+    return keys().getId(key);
+}
+
+std::optional<int> findKeyId(const std::string& key) {
+    return keys().findId(key);
+}
+
+const std::string& getKeyName(const int keyId) {
+    return keys().getName(keyId);
+}
+
+}  // namespace Contextual::ContextIds
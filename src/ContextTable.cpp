@@ -1,20 +1,33 @@
 #include "ContextTable.h"
 
+#include <algorithm>
+#include <atomic>
+
+#include "ContextIds.h"
+
 namespace Contextual {
 
 namespace {
-const std::unique_ptr<std::unordered_set<int>> g_NOT_FOUND = nullptr;
+
+// Returns the position of the key in the sorted key array, or the position it should be inserted at
+size_t lowerBound(const std::vector<int>& keys, const int keyId) {
+    return std::lower_bound(keys.begin(), keys.end(), keyId) - keys.begin();
 }
 
+bool contains(const std::vector<int>& keys, const size_t index, const int keyId) {
+    return index < keys.size() && keys[index] == keyId;
+}
+
+// Source of every table's versions, so a version identifies one state of one table
+std::atomic<uint64_t> g_nextVersion = 1;
+
+}  // namespace
+
 ContextTable::ContextTable(std::shared_ptr<ContextManager> manager) : m_manager(std::move(manager)) {}
 
 void ContextTable::set(const std::string& key, const std::string& strValue) {
     int symbol = m_manager->getStringTable().cache(strValue);
-    FactTuple tuple = {FactType::kString, static_cast<float>(symbol)};
-    if (m_listContext) {
-        m_listContext->erase(key);
-    }
-    m_basicContext.insert_or_assign(key, tuple);
+    setRawValue(ContextIds::getKeyId(key), static_cast<float>(symbol), FactType::kString);
 }
 
 void ContextTable::set(const std::string& key, const char* strValue) {
@@ -22,47 +35,69 @@ void ContextTable::set(const std::string& key, const char* strValue) {
 }
 
 void ContextTable::set(const std::string& key, float floatValue) {
-    FactTuple tuple = {FactType::kNumber, floatValue};
-    if (m_listContext) {
-        m_listContext->erase(key);
-    }
-    m_basicContext.insert_or_assign(key, tuple);
+    setRawValue(ContextIds::getKeyId(key), floatValue, FactType::kNumber);
 }
 
 void ContextTable::set(const std::string& key, int intValue) {
-    FactTuple tuple = {FactType::kNumber, static_cast<float>(intValue)};
-    if (m_listContext) {
-        m_listContext->erase(key);
-    }
-    m_basicContext.insert_or_assign(key, tuple);
+    setRawValue(ContextIds::getKeyId(key), static_cast<float>(intValue), FactType::kNumber);
 }
 
 void ContextTable::set(const std::string& key, bool boolValue) {
-    FactTuple tuple = {FactType::kBoolean, static_cast<float>(boolValue)};
-    if (m_listContext) {
-        m_listContext->erase(key);
-    }
-    m_basicContext.insert_or_assign(key, tuple);
+    setRawValue(ContextIds::getKeyId(key), static_cast<float>(boolValue), FactType::kBoolean);
 }
 
 void ContextTable::setRawValue(const std::string& key, float value, FactType type) {
+    setRawValue(ContextIds::getKeyId(key), value, type);
+}
+
+void ContextTable::setRawValue(const int keyId, float value, FactType type) {
     if (type == FactType::kNull || type == FactType::kList) {
         // Not allowed type
         return;
     }
     FactTuple tuple = {type, value};
-    if (m_listContext) {
-        m_listContext->erase(key);
+    bool changed = eraseList(keyId);
+    size_t index = lowerBound(m_basicKeys, keyId);
+    if (contains(m_basicKeys, index, keyId)) {
+        FactTuple& current = m_basicValues[index];
+        if (!changed && current.type == type && current.value == value) {
+            return;
+        }
+        current = tuple;
+    } else {
+        m_basicKeys.insert(m_basicKeys.begin() + index, keyId);
+        m_basicValues.insert(m_basicValues.begin() + index, tuple);
     }
-    m_basicContext.insert_or_assign(key, tuple);
+    markChanged(keyId);
 }
 
 void ContextTable::set(const std::string& key, std::unique_ptr<std::unordered_set<int>> listValue, bool isStringList) {
-    if (!m_listContext) {
-        m_listContext = std::unordered_map<std::string, std::pair<std::unique_ptr<std::unordered_set<int>>, bool>>();
+    FactList list;
+    if (listValue != nullptr) {
+        list = FactList(*listValue);
+    }
+    set(ContextIds::getKeyId(key), std::move(list), isStringList);
+}
+
+void ContextTable::set(const std::string& key, FactList listValue, bool isStringList) {
+    set(ContextIds::getKeyId(key), std::move(listValue), isStringList);
+}
+
+void ContextTable::set(const int keyId, FactList listValue, bool isStringList) {
+    bool changed = eraseTuple(keyId);
+    size_t index = lowerBound(m_listKeys, keyId);
+    if (contains(m_listKeys, index, keyId)) {
+        ListTuple& current = m_listValues[index];
+        if (!changed && current.isStringList == isStringList && current.list.size() == listValue.size() &&
+            std::equal(current.list.begin(), current.list.end(), listValue.begin())) {
+            return;
+        }
+        current = {std::move(listValue), isStringList};
+    } else {
+        m_listKeys.insert(m_listKeys.begin() + index, keyId);
+        m_listValues.insert(m_listValues.begin() + index, {std::move(listValue), isStringList});
     }
-    m_basicContext.erase(key);
-    m_listContext->insert_or_assign(key, std::make_pair(std::move(listValue), isStringList));
+    markChanged(keyId);
 }
 
 void ContextTable::set(const std::string& key, std::unique_ptr<std::unordered_set<int>> listValue) {
@@ -70,41 +105,62 @@ void ContextTable::set(const std::string& key, std::unique_ptr<std::unordered_se
 }
 
 void ContextTable::set(const std::string& key, const std::unordered_set<const char*>& listValue) {
-    auto intValues = std::make_unique<std::unordered_set<int>>();
+    FactList intValues;
     StringTable& symbolTable = m_manager->getStringTable();
     for (const char* cStr : listValue) {
-        intValues->insert(symbolTable.cache(std::string(cStr)));
+        intValues.insert(symbolTable.cache(cStr));
     }
     set(key, std::move(intValues), true);
 }
 
 void ContextTable::set(const std::string& key, const std::unordered_set<std::string>& listValue) {
-    auto intValues = std::make_unique<std::unordered_set<int>>();
+    FactList intValues;
     StringTable& symbolTable = m_manager->getStringTable();
     for (const std::string& str : listValue) {
-        intValues->insert(symbolTable.cache(str));
+        intValues.insert(symbolTable.cache(str));
     }
     set(key, std::move(intValues), true);
 }
 
 void ContextTable::remove(const std::string& key) {
-    m_basicContext.erase(key);
-    if (m_listContext) {
-        m_listContext->erase(key);
+    if (std::optional<int> keyId = ContextIds::findKeyId(key)) {
+        remove(*keyId);
+    }
+}
+
+void ContextTable::remove(const int keyId) {
+    bool removedTuple = eraseTuple(keyId);
+    bool removedList = eraseList(keyId);
+    if (removedTuple || removedList) {
+        markChanged(keyId);
     }
 }
 
 std::optional<std::string> ContextTable::getString(const std::string& key) const {
-    std::optional<FactTuple> tuple = getTuple(key, FactType::kString);
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getString(*keyId) : std::nullopt;
+}
+
+std::optional<std::string> ContextTable::getString(const int keyId) const {
+    std::optional<FactTuple> tuple = getTuple(keyId, FactType::kString);
     if (!tuple) {
         return std::nullopt;
     }
     int value = (int)tuple->value;
-    return m_manager->getStringTable().lookup(value);
+    std::optional<std::string_view> str = m_manager->getStringTable().lookup(value);
+    if (!str) {
+        return std::nullopt;
+    }
+    return std::string(*str);
 }
 
 std::optional<float> ContextTable::getFloat(const std::string& key) const {
-    std::optional<FactTuple> tuple = getTuple(key, FactType::kNumber);
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getFloat(*keyId) : std::nullopt;
+}
+
+std::optional<float> ContextTable::getFloat(const int keyId) const {
+    std::optional<FactTuple> tuple = getTuple(keyId, FactType::kNumber);
     if (!tuple) {
         return std::nullopt;
     }
@@ -112,7 +168,12 @@ std::optional<float> ContextTable::getFloat(const std::string& key) const {
 }
 
 std::optional<int> ContextTable::getInt(const std::string& key) const {
-    std::optional<FactTuple> tuple = getTuple(key, FactType::kNumber);
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getInt(*keyId) : std::nullopt;
+}
+
+std::optional<int> ContextTable::getInt(const int keyId) const {
+    std::optional<FactTuple> tuple = getTuple(keyId, FactType::kNumber);
     if (!tuple) {
         return std::nullopt;
     }
@@ -120,92 +181,185 @@ std::optional<int> ContextTable::getInt(const std::string& key) const {
 }
 
 std::optional<bool> ContextTable::getBool(const std::string& key) const {
-    std::optional<FactTuple> tuple = getTuple(key, FactType::kBoolean);
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getBool(*keyId) : std::nullopt;
+}
+
+std::optional<bool> ContextTable::getBool(const int keyId) const {
+    std::optional<FactTuple> tuple = getTuple(keyId, FactType::kBoolean);
     if (!tuple) {
         return std::nullopt;
     }
     return tuple->value != 0.0f;
 }
 
-const std::unique_ptr<std::unordered_set<int>>& ContextTable::getList(const std::string& key) const {
-    if (!m_listContext) {
-        return g_NOT_FOUND;
-    }
-    auto got = m_listContext->find(key);
-    if (got == m_listContext->end()) {
-        return g_NOT_FOUND;
+const FactList* ContextTable::getList(const std::string& key) const {
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getList(*keyId) : nullptr;
+}
+
+const FactList* ContextTable::getList(const int keyId) const {
+    const ListTuple* tuple = findList(keyId);
+    if (tuple == nullptr) {
+        return nullptr;
     }
-    return got->second.first;
+    return &tuple->list;
 }
 
 bool ContextTable::isStringList(const std::string& key) const {
-    if (!m_listContext) {
-        return false;
-    }
-    auto got = m_listContext->find(key);
-    if (got == m_listContext->end()) {
-        return false;
-    }
-    return got->second.second;
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId && isStringList(*keyId);
+}
+
+bool ContextTable::isStringList(const int keyId) const {
+    const ListTuple* tuple = findList(keyId);
+    return tuple != nullptr && tuple->isStringList;
 }
 
 std::optional<std::vector<std::string>> ContextTable::toStringList(const std::string& key) const {
-    if (!m_listContext) {
-        return std::nullopt;
-    }
-    auto got = m_listContext->find(key);
-    if (got == m_listContext->end()) {
-        return std::nullopt;
-    }
-    if (!got->second.second) {
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? toStringList(*keyId) : std::nullopt;
+}
+
+std::optional<std::vector<std::string>> ContextTable::toStringList(const int keyId) const {
+    const ListTuple* tuple = findList(keyId);
+    if (tuple == nullptr || !tuple->isStringList) {
         return std::nullopt;
     }
 
     std::vector<std::string> strList;
-    strList.reserve(got->second.first->size());
+    strList.reserve(tuple->list.size());
     StringTable& stringTable = m_manager->getStringTable();
-    for (auto value : *got->second.first) {
-        strList.push_back(stringTable.lookup(value).value_or("NULL"));
+    for (auto value : tuple->list) {
+        strList.emplace_back(stringTable.lookup(value).value_or("NULL"));
     }
     return strList;
 }
 
 FactType ContextTable::getType(const std::string& key) const {
-    if (m_listContext && m_listContext->find(key) != m_listContext->end()) {
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getType(*keyId) : FactType::kNull;
+}
+
+FactType ContextTable::getType(const int keyId) const {
+    if (findList(keyId) != nullptr) {
         return FactType::kList;
     }
-    auto got = m_basicContext.find(key);
-    if (got == m_basicContext.end()) {
+    const FactTuple* tuple = findTuple(keyId);
+    if (tuple == nullptr) {
         return FactType::kNull;
     }
-    const FactTuple& tuple = got->second;
-    return tuple.type;
+    return tuple->type;
 }
 
 std::optional<float> ContextTable::getRawValue(const std::string& key) const {
-    auto got = m_basicContext.find(key);
-    if (got == m_basicContext.end()) {
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getRawValue(*keyId) : std::nullopt;
+}
+
+std::optional<float> ContextTable::getRawValue(const int keyId) const {
+    const FactTuple* tuple = findTuple(keyId);
+    if (tuple == nullptr) {
         return std::nullopt;
     }
-    const FactTuple& tuple = got->second;
-    return tuple.value;
+    return tuple->value;
 }
 
 bool ContextTable::hasKey(const std::string& key) const {
-    return (m_basicContext.find(key) != m_basicContext.end()) ||
-           (m_listContext && m_listContext->find(key) != m_listContext->end());
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId && hasKey(*keyId);
 }
 
-std::optional<ContextTable::FactTuple> ContextTable::getTuple(const std::string& key, const FactType type) const {
-    auto got = m_basicContext.find(key);
-    if (got == m_basicContext.end()) {
-        return std::nullopt;
+bool ContextTable::hasKey(const int keyId) const {
+    return findTuple(keyId) != nullptr || findList(keyId) != nullptr;
+}
+
+uint64_t ContextTable::getVersion() const {
+    return m_version;
+}
+
+uint64_t ContextTable::getKeyVersion(const std::string& key) const {
+    std::optional<int> keyId = ContextIds::findKeyId(key);
+    return keyId ? getKeyVersion(*keyId) : 0;
+}
+
+uint64_t ContextTable::getKeyVersion(const int keyId) const {
+    size_t index = lowerBound(m_versionKeys, keyId);
+    if (!contains(m_versionKeys, index, keyId)) {
+        return 0;
+    }
+    return m_keyVersions[index];
+}
+
+const std::vector<int>& ContextTable::getDirtyKeys() const {
+    return m_dirtyKeys;
+}
+
+bool ContextTable::isDirty(const int keyId) const {
+    return contains(m_dirtyKeys, lowerBound(m_dirtyKeys, keyId), keyId);
+}
+
+void ContextTable::clearDirty() {
+    m_dirtyKeys.clear();
+}
+
+const ContextTable::FactTuple* ContextTable::findTuple(const int keyId) const {
+    size_t index = lowerBound(m_basicKeys, keyId);
+    if (!contains(m_basicKeys, index, keyId)) {
+        return nullptr;
+    }
+    return &m_basicValues[index];
+}
+
+const ContextTable::ListTuple* ContextTable::findList(const int keyId) const {
+    size_t index = lowerBound(m_listKeys, keyId);
+    if (!contains(m_listKeys, index, keyId)) {
+        return nullptr;
+    }
+    return &m_listValues[index];
+}
+
+bool ContextTable::eraseTuple(const int keyId) {
+    size_t index = lowerBound(m_basicKeys, keyId);
+    if (!contains(m_basicKeys, index, keyId)) {
+        return false;
     }
-    const FactTuple& tuple = got->second;
-    if (tuple.type != type) {
+    m_basicKeys.erase(m_basicKeys.begin() + index);
+    m_basicValues.erase(m_basicValues.begin() + index);
+    return true;
+}
+
+bool ContextTable::eraseList(const int keyId) {
+    size_t index = lowerBound(m_listKeys, keyId);
+    if (!contains(m_listKeys, index, keyId)) {
+        return false;
+    }
+    m_listKeys.erase(m_listKeys.begin() + index);
+    m_listValues.erase(m_listValues.begin() + index);
+    return true;
+}
+
+void ContextTable::markChanged(const int keyId) {
+    m_version = g_nextVersion.fetch_add(1, std::memory_order_relaxed);
+    size_t index = lowerBound(m_versionKeys, keyId);
+    if (contains(m_versionKeys, index, keyId)) {
+        m_keyVersions[index] = m_version;
+    } else {
+        m_versionKeys.insert(m_versionKeys.begin() + index, keyId);
+        m_keyVersions.insert(m_keyVersions.begin() + index, m_version);
+    }
+    index = lowerBound(m_dirtyKeys, keyId);
+    if (!contains(m_dirtyKeys, index, keyId)) {
+        m_dirtyKeys.insert(m_dirtyKeys.begin() + index, keyId);
+    }
+}
+
+std::optional<ContextTable::FactTuple> ContextTable::getTuple(const int keyId, const FactType type) const {
+    const FactTuple* tuple = findTuple(keyId);
+    if (tuple == nullptr || tuple->type != type) {
         return std::nullopt;
     }
-    return tuple;
+    return *tuple;
 }
 
 }  // namespace Contextual
\ No newline at end of file
@@ -1,22 +1,70 @@
 #include "DatabaseQuery.h"
 
+#include <limits>
+
+#include "ContextIds.h"
+#include "MathUtils.h"
+
 namespace Contextual {
 
+namespace {
+const std::shared_ptr<ContextTable> g_NOT_FOUND = nullptr;
+}
+
 DatabaseQuery::DatabaseQuery(std::shared_ptr<ContextManager>& contextManager, std::string group, std::string category)
-    : m_manager(contextManager), m_group(std::move(group)), m_category(std::move(category)) {
+    : m_manager(contextManager),
+      m_group(std::move(group)),
+      m_category(std::move(category)),
+      m_contexts(ContextIds::getNumTables()),
+      m_tables(m_contexts.size(), nullptr),
+      m_random(MathUtils::randUInt(0, std::numeric_limits<size_t>::max())) {
     m_willFail = WillFail::kNormal;
 }
 
+DatabaseQuery::DatabaseQuery(std::shared_ptr<ContextManager>& contextManager)
+    : m_manager(contextManager), m_willFail(WillFail::kNormal), m_random(0) {}
+
 void DatabaseQuery::addContextTable(const std::string& tableName, std::shared_ptr<ContextTable> contextTable) {
-    m_contexts.emplace(tableName, std::move(contextTable));
+    addContextTable(ContextIds::getTableId(tableName), std::move(contextTable));
 }
 
-std::shared_ptr<ContextTable> DatabaseQuery::getContextTable(const std::string& tableName) const {
-    auto got = m_contexts.find(tableName);
-    if (got == m_contexts.end()) {
+void DatabaseQuery::addContextTable(const int tableId, std::shared_ptr<ContextTable> contextTable) {
+    if (tableId < 0) {
+        return;
+    }
+    if (static_cast<size_t>(tableId) >= m_contexts.size()) {
+        m_contexts.resize(tableId + 1);
+        m_tables.resize(tableId + 1, nullptr);
+    }
+    // Keep the first table added under this name
+    if (m_contexts[tableId] == nullptr) {
+        m_tables[tableId] = contextTable.get();
+        m_contexts[tableId] = std::move(contextTable);
+    }
+}
+
+const std::shared_ptr<ContextTable>& DatabaseQuery::getContextTable(const std::string& tableName) const {
+    std::optional<int> tableId = ContextIds::findTableId(tableName);
+    return tableId ? getContextTable(*tableId) : g_NOT_FOUND;
+}
+
+const std::shared_ptr<ContextTable>& DatabaseQuery::getContextTable(const int tableId) const {
+    if (tableId < 0 || static_cast<size_t>(tableId) >= m_contexts.size()) {
+        return g_NOT_FOUND;
+    }
+    return m_contexts[tableId];
+}
+
+ContextTable* DatabaseQuery::findContextTable(const std::string& tableName) const {
+    std::optional<int> tableId = ContextIds::findTableId(tableName);
+    return tableId ? findContextTable(*tableId) : nullptr;
+}
+
+ContextTable* DatabaseQuery::findContextTable(const int tableId) const {
+    if (tableId < 0 || static_cast<size_t>(tableId) >= m_tables.size()) {
         return nullptr;
     }
-    return got->second;
+    return m_tables[tableId];
 }
 
 void DatabaseQuery::setWillFail(DatabaseQuery::WillFail value) {
@@ -27,6 +75,14 @@ DatabaseQuery::WillFail DatabaseQuery::willFail() const {
     return m_willFail;
 }
 
+void DatabaseQuery::setSeed(const uint64_t seed) {
+    m_random.seed(seed);
+}
+
+Random& DatabaseQuery::getRandom() const {
+    return m_random;
+}
+
 StringTable& DatabaseQuery::getStringTable() {
     return m_manager->getStringTable();
 }
@@ -0,0 +1,47 @@
+#include "DatabaseSnapshot.h"
+
+#include <algorithm>
+
+namespace Contextual {
+
+namespace {
+
+const std::shared_ptr<const RuleTable> g_NOT_FOUND = nullptr;
+
+}  // namespace
+
+DatabaseSnapshot::DatabaseSnapshot(const uint64_t version, TableMap tables)
+    : m_version(version), m_tables(std::move(tables)) {}
+
+const std::shared_ptr<const RuleTable>& DatabaseSnapshot::getRuleTable(const std::string& group,
+                                                                       const std::string& category) const {
+    auto got = m_tables.find({group, category});
+    if (got == m_tables.end()) {
+        return g_NOT_FOUND;
+    }
+    return got->second;
+}
+
+std::vector<std::pair<std::string, std::string>> DatabaseSnapshot::getTableNames() const {
+    std::vector<std::pair<std::string, std::string>> names;
+    names.reserve(m_tables.size());
+    for (const auto& [groupCategory, table] : m_tables) {
+        names.emplace_back(groupCategory.group, groupCategory.category);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+const DatabaseSnapshot::TableMap& DatabaseSnapshot::getTables() const {
+    return m_tables;
+}
+
+size_t DatabaseSnapshot::getNumTables() const {
+    return m_tables.size();
+}
+
+uint64_t DatabaseSnapshot::getVersion() const {
+    return m_version;
+}
+
+}  // namespace Contextual
@@ -0,0 +1,57 @@
+#include "FactList.h"
+
+#include <algorithm>
+
+namespace Contextual {
+
+FactList::FactList(const std::unordered_set<int>& values) {
+    if (values.size() > g_INLINE_CAPACITY) {
+        m_heap.assign(values.begin(), values.end());
+        std::sort(m_heap.begin(), m_heap.end());
+        m_size = static_cast<uint32_t>(m_heap.size());
+        return;
+    }
+    for (const int value : values) {
+        insert(value);
+    }
+}
+
+void FactList::insert(const int value) {
+    const int* pos = std::lower_bound(begin(), end(), value);
+    if (pos != end() && *pos == value) {
+        return;
+    }
+    size_t index = pos - begin();
+    if (m_size < g_INLINE_CAPACITY) {
+        std::copy_backward(m_inline + index, m_inline + m_size, m_inline + m_size + 1);
+        m_inline[index] = value;
+    } else {
+        if (m_size == g_INLINE_CAPACITY) {
+            m_heap.assign(m_inline, m_inline + m_size);
+        }
+        m_heap.insert(m_heap.begin() + static_cast<std::ptrdiff_t>(index), value);
+    }
+    ++m_size;
+}
+
+bool FactList::contains(const int value) const {
+    return std::binary_search(begin(), end(), value);
+}
+
+size_t FactList::size() const {
+    return m_size;
+}
+
+bool FactList::empty() const {
+    return m_size == 0;
+}
+
+const int* FactList::begin() const {
+    return m_size > g_INLINE_CAPACITY ? m_heap.data() : m_inline;
+}
+
+const int* FactList::end() const {
+    return begin() + m_size;
+}
+
+}  // namespace Contextual
\ No newline at end of file
@@ -35,7 +35,7 @@ void testDatabaseLoading() {
     PLOG_INFO << "StringTable Size: " << contextManager->getStringTable().getSize();
 
     PLOG_INFO << "";
-    const std::unique_ptr<Contextual::RuleTable>& table = database.getRuleTable("Person", "Interact");
+    std::shared_ptr<const Contextual::RuleTable> table = database.getRuleTable("Person", "Interact");
     PLOG_INFO << "Nullptr: " << (table == nullptr);
 }
 
@@ -7,8 +7,9 @@ namespace Contextual::MathUtils {
 
 namespace {
 
-std::random_device rd;
-std::mt19937 engine(rd());
+// One engine per thread so batched queries can run in parallel
+thread_local std::random_device rd;
+thread_local std::mt19937 engine(rd());
 
 }
 
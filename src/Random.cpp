@@ -0,0 +1,91 @@
+#include "Random.h"
+
+#include <limits>
+
+namespace Contextual {
+
+namespace {
+
+uint64_t rotl(const uint64_t x, const int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t splitMix64(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+}  // namespace
+
+Random::Random(const uint64_t seed) {
+    this->seed(seed);
+}
+
+void Random::seed(uint64_t seed) {
+    // Expand the seed so that similar seeds still give unrelated streams
+    for (uint64_t& state : m_state) {
+        state = splitMix64(seed);
+    }
+}
+
+uint64_t Random::next() {
+    const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+    const uint64_t t = m_state[1] << 17;
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 45);
+    return result;
+}
+
+uint32_t Random::nextBounded(const uint32_t range) {
+    // Lemire's multiply-shift, rejecting only the few values that would bias the result
+    uint64_t product = (next() >> 32) * range;
+    auto low = static_cast<uint32_t>(product);
+    if (low < range) {
+        const uint32_t threshold = -range % range;
+        while (low < threshold) {
+            product = (next() >> 32) * range;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+int Random::randInt(const int min, const int max) {
+    const uint32_t span = static_cast<uint32_t>(max) - static_cast<uint32_t>(min);
+    if (span == std::numeric_limits<uint32_t>::max()) {
+        return static_cast<int>(next() >> 32);
+    }
+    return static_cast<int>(static_cast<uint32_t>(min) + nextBounded(span + 1));
+}
+
+size_t Random::randUInt(const size_t min, const size_t max) {
+    const size_t span = max - min;
+    if (span < std::numeric_limits<uint32_t>::max()) {
+        return min + nextBounded(static_cast<uint32_t>(span + 1));
+    }
+    // Very large ranges are not needed for picking among options, so plain rejection is fine here
+    if (span == std::numeric_limits<size_t>::max()) {
+        return static_cast<size_t>(next());
+    }
+    const uint64_t range = static_cast<uint64_t>(span) + 1;
+    const uint64_t limit = std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % range;
+    uint64_t value;
+    do {
+        value = next();
+    } while (value >= limit);
+    return min + static_cast<size_t>(value % range);
+}
+
+float Random::randFloat(const float min, const float max) {
+    // Top 24 bits map to evenly spaced floats in [0, 1)
+    const float unit = static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+    return min + (max - min) * unit;
+}
+
+}  // namespace Contextual
\ No newline at end of file
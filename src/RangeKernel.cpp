@@ -0,0 +1,70 @@
+#include "RangeKernel.h"
+
+#include <algorithm>
+#include <limits>
+
+#if !defined(CONTEXTUAL_NO_SIMD) && defined(__AVX2__)
+#define CONTEXTUAL_RANGE_AVX2
+#include <immintrin.h>
+#elif !defined(CONTEXTUAL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define CONTEXTUAL_RANGE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Contextual::RangeKernel {
+
+size_t getPaddedCount(const size_t count) {
+    return (count + g_LANES - 1) / g_LANES * g_LANES;
+}
+
+size_t getNumWords(const size_t count) {
+    return (count + g_WORD_BITS - 1) / g_WORD_BITS;
+}
+
+float getPaddingMin() {
+    return std::numeric_limits<float>::infinity();
+}
+
+float getPaddingMax() {
+    return -std::numeric_limits<float>::infinity();
+}
+
+void evaluate(const float value, const float* mins, const float* maxs, const size_t count, uint64_t* matches) {
+    std::fill(matches, matches + getNumWords(count), 0);
+    // Groups of g_LANES never straddle a word, since g_LANES divides g_WORD_BITS
+    for (size_t i = 0; i < count; i += g_LANES) {
+#if defined(CONTEXTUAL_RANGE_AVX2)
+        const __m256 broadcast = _mm256_set1_ps(value);
+        const __m256 aboveMin = _mm256_cmp_ps(broadcast, _mm256_loadu_ps(mins + i), _CMP_GE_OQ);
+        const __m256 belowMax = _mm256_cmp_ps(broadcast, _mm256_loadu_ps(maxs + i), _CMP_LE_OQ);
+        const auto bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_and_ps(aboveMin, belowMax)));
+#elif defined(CONTEXTUAL_RANGE_SSE2)
+        const __m128 broadcast = _mm_set1_ps(value);
+        const __m128 low = _mm_and_ps(_mm_cmpge_ps(broadcast, _mm_loadu_ps(mins + i)),
+                                      _mm_cmple_ps(broadcast, _mm_loadu_ps(maxs + i)));
+        const __m128 high = _mm_and_ps(_mm_cmpge_ps(broadcast, _mm_loadu_ps(mins + i + 4)),
+                                       _mm_cmple_ps(broadcast, _mm_loadu_ps(maxs + i + 4)));
+        const auto bits = static_cast<uint64_t>(_mm_movemask_ps(low) | (_mm_movemask_ps(high) << 4));
+#else
+        uint64_t bits = 0;
+        for (size_t lane = 0; lane < g_LANES; ++lane) {
+            if (mins[i + lane] <= value && value <= maxs[i + lane]) {
+                bits |= uint64_t{1} << lane;
+            }
+        }
+#endif
+        matches[i / g_WORD_BITS] |= bits << (i % g_WORD_BITS);
+    }
+}
+
+const char* getInstructionSet() {
+#if defined(CONTEXTUAL_RANGE_AVX2)
+    return "AVX2";
+#elif defined(CONTEXTUAL_RANGE_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+}  // namespace Contextual::RangeKernel
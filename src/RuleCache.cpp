@@ -0,0 +1,69 @@
+#include "RuleCache.h"
+
+namespace Contextual {
+
+RuleCache::RuleCache(const size_t capacity) : m_capacity(capacity) {}
+
+size_t RuleCache::FingerprintHash::operator()(const std::vector<uint64_t>& fingerprint) const {
+    // FNV-1a over whole words
+    uint64_t hash = 14695981039346656037ULL;
+    for (const uint64_t word : fingerprint) {
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool RuleCache::find(const std::vector<uint64_t>& fingerprint, std::vector<uint64_t>& candidates) const {
+    std::shared_lock lock(m_mutex);
+    auto got = m_entries.find(fingerprint);
+    if (got == m_entries.end()) {
+        ++m_numMisses;
+        return false;
+    }
+    candidates.assign(got->second.begin(), got->second.end());
+    ++m_numHits;
+    return true;
+}
+
+void RuleCache::insert(const std::vector<uint64_t>& fingerprint, const std::vector<uint64_t>& candidates) {
+    if (m_capacity == 0) {
+        return;
+    }
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_entries.try_emplace(fingerprint, candidates);
+    if (!inserted) {
+        // Another thread computed the same entry first
+        return;
+    }
+    m_order.push_back(&it->first);
+    if (m_order.size() > m_capacity) {
+        m_entries.erase(m_entries.find(*m_order.front()));
+        m_order.pop_front();
+    }
+}
+
+void RuleCache::clear() {
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    m_order.clear();
+}
+
+size_t RuleCache::getCapacity() const {
+    return m_capacity;
+}
+
+size_t RuleCache::getSize() const {
+    std::shared_lock lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t RuleCache::getNumHits() const {
+    return m_numHits;
+}
+
+size_t RuleCache::getNumMisses() const {
+    return m_numMisses;
+}
+
+}  // namespace Contextual
@@ -1,5 +1,6 @@
 #include "RuleDatabase.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "ResponseContext.h"
@@ -10,41 +11,98 @@ namespace Contextual {
 
 namespace {
 
-const std::unique_ptr<RuleTable> g_NOT_FOUND = nullptr;
+// Maximum number of queries handed to a worker at once
+const size_t g_BATCH_SIZE = 32;
 
 }  // namespace
 
 RuleDatabase::RuleDatabase(std::shared_ptr<ContextManager> contextManager)
-    : m_contextManager(std::move(contextManager)) {}
+    : m_contextManager(std::move(contextManager)), m_snapshot(std::make_shared<const DatabaseSnapshot>()) {}
 
 RuleDatabaseReturnCode RuleDatabase::addRuleTable(const std::string& group, const std::string& category,
                                                   std::unique_ptr<RuleTable>& ruleTable) {
-    GroupCategory groupCategory = {group, category};
-    if (m_groupCategoryToTable.find(groupCategory) != m_groupCategoryToTable.end()) {
+    std::lock_guard lock(m_writeMutex);
+    std::shared_ptr<const DatabaseSnapshot> current = getSnapshot();
+    if (current->getRuleTable(group, category) != nullptr) {
         return RuleDatabaseReturnCode::kAlreadyDefined;
     }
+    // Only taken from the caller once it is certain to be added
+    publishAdded(*current, group, category, std::move(ruleTable));
+    return RuleDatabaseReturnCode::kSuccess;
+}
 
-    m_groupCategoryToTable.emplace(groupCategory, std::move(ruleTable));
+RuleDatabaseReturnCode RuleDatabase::addRuleTable(const std::string& group, const std::string& category,
+                                                  std::shared_ptr<const RuleTable> ruleTable) {
+    std::lock_guard lock(m_writeMutex);
+    std::shared_ptr<const DatabaseSnapshot> current = getSnapshot();
+    if (current->getRuleTable(group, category) != nullptr) {
+        return RuleDatabaseReturnCode::kAlreadyDefined;
+    }
+    publishAdded(*current, group, category, std::move(ruleTable));
     return RuleDatabaseReturnCode::kSuccess;
 }
 
-const std::unique_ptr<RuleTable>& RuleDatabase::getRuleTable(const std::string& group,
-                                                             const std::string& category) const {
-    GroupCategory groupCategory = {group, category};
-    auto got = m_groupCategoryToTable.find(groupCategory);
-    if (got == m_groupCategoryToTable.end()) {
-        return g_NOT_FOUND;
+void RuleDatabase::updateRuleTables(std::vector<RuleTableUpdate>& updates) {
+    std::lock_guard lock(m_writeMutex);
+    std::shared_ptr<const DatabaseSnapshot> current = getSnapshot();
+    DatabaseSnapshot::TableMap tables = current->getTables();
+    for (RuleTableUpdate& update : updates) {
+        DatabaseSnapshot::GroupCategory groupCategory = {update.group, update.category};
+        if (update.table == nullptr) {
+            tables.erase(groupCategory);
+        } else {
+            tables.insert_or_assign(groupCategory, std::move(update.table));
+        }
     }
-    return got->second;
+    publish(current->getVersion() + 1, std::move(tables));
+}
+
+std::shared_ptr<const DatabaseSnapshot> RuleDatabase::getSnapshot() const {
+    return std::atomic_load_explicit(&m_snapshot, std::memory_order_acquire);
+}
+
+void RuleDatabase::publishAdded(const DatabaseSnapshot& current, const std::string& group,
+                                const std::string& category, std::shared_ptr<const RuleTable> ruleTable) {
+    DatabaseSnapshot::TableMap tables = current.getTables();
+    tables.emplace(DatabaseSnapshot::GroupCategory{group, category}, std::move(ruleTable));
+    publish(current.getVersion() + 1, std::move(tables));
+}
+
+void RuleDatabase::publish(const uint64_t version, DatabaseSnapshot::TableMap tables) {
+    auto snapshot = std::make_shared<const DatabaseSnapshot>(version, std::move(tables));
+    // The previous snapshot is freed by whichever reader lets go of it last
+    std::atomic_store_explicit(&m_snapshot, std::move(snapshot), std::memory_order_release);
+}
+
+std::shared_ptr<const RuleTable> RuleDatabase::getRuleTable(const std::string& group,
+                                                            const std::string& category) const {
+    return getSnapshot()->getRuleTable(group, category);
+}
+
+std::vector<std::pair<std::string, std::string>> RuleDatabase::getTableNames() const {
+    return getSnapshot()->getTableNames();
+}
+
+uint64_t RuleDatabase::getVersion() const {
+    return getSnapshot()->getVersion();
 }
 
 std::shared_ptr<ContextManager>& RuleDatabase::getContextManager() {
     return m_contextManager;
 }
 
+void RuleDatabase::setCacheCapacity(const size_t capacity) {
+    m_cacheCapacity = capacity;
+}
+
+size_t RuleDatabase::getCacheCapacity() const {
+    return m_cacheCapacity;
+}
+
 QueryReturnCode RuleDatabase::queryBestMatch(BestMatch& bestMatch, DatabaseQuery& query) const {
     // Look for table
-    const std::unique_ptr<RuleTable>& table = getRuleTable(query.getGroup(), query.getCategory());
+    std::shared_ptr<const DatabaseSnapshot> snapshot = getSnapshot();
+    const std::shared_ptr<const RuleTable>& table = snapshot->getRuleTable(query.getGroup(), query.getCategory());
     if (table == nullptr) {
         return QueryReturnCode::kFailure;
     }
@@ -57,12 +115,59 @@ QueryReturnCode RuleDatabase::queryBestMatch(BestMatch& bestMatch, DatabaseQuery
     return QueryReturnCode::kSuccess;
 }
 
+void RuleDatabase::queryBestMatches(std::vector<BestMatch>& bestMatches, std::vector<QueryReturnCode>& returnCodes,
+                                    std::vector<DatabaseQuery>& queries, ThreadPool& threadPool) const {
+    bestMatches.assign(queries.size(), {});
+    returnCodes.assign(queries.size(), QueryReturnCode::kFailure);
+
+    // The whole batch runs against one snapshot, which also keeps its tables alive through a reload
+    std::shared_ptr<const DatabaseSnapshot> snapshot = getSnapshot();
+
+    // Resolve tables up front and order queries by table
+    std::vector<const RuleTable*> tables(queries.size());
+    std::vector<size_t> order;
+    order.reserve(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        tables[i] = snapshot->getRuleTable(queries[i].getGroup(), queries[i].getCategory()).get();
+        if (tables[i] != nullptr) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&tables](const size_t a, const size_t b) { return tables[a] < tables[b]; });
+
+    // Split into batches that never span two tables
+    std::vector<std::pair<size_t, size_t>> batches;
+    size_t start = 0;
+    for (size_t i = 1; i <= order.size(); ++i) {
+        if (i == order.size() || i - start == g_BATCH_SIZE || tables[order[i]] != tables[order[start]]) {
+            batches.emplace_back(start, i);
+            start = i;
+        }
+    }
+
+    threadPool.parallelFor(batches.size(), [&](const size_t batchIndex) {
+        const auto& [batchStart, batchEnd] = batches[batchIndex];
+        // A batch stays on one table, so the scratch buffers only grow once
+        QueryScratch scratch;
+        for (size_t i = batchStart; i < batchEnd; ++i) {
+            size_t queryIndex = order[i];
+            const RuleEntry* entry = tables[queryIndex]->queryBest(scratch, queries[queryIndex]);
+            if (entry != nullptr) {
+                bestMatches[queryIndex] = {entry->response, entry->priority};
+                returnCodes[queryIndex] = QueryReturnCode::kSuccess;
+            }
+        }
+    });
+}
+
 QueryReturnCode RuleDatabase::queryUniformMatch(UniformMatch& uniformMatch, DatabaseQuery& query) const {
     // Set query to skip fail criterion
     query.setWillFail(DatabaseQuery::WillFail::kNever);
 
     // Look for table
-    const std::unique_ptr<RuleTable>& table = getRuleTable(query.getGroup(), query.getCategory());
+    std::shared_ptr<const DatabaseSnapshot> snapshot = getSnapshot();
+    const std::shared_ptr<const RuleTable>& table = snapshot->getRuleTable(query.getGroup(), query.getCategory());
     if (table == nullptr) {
         return QueryReturnCode::kFailure;
     }
@@ -79,7 +184,8 @@ QueryReturnCode RuleDatabase::queryWeightedMatch(WeightedMatch& weightedMatch, D
     query.setWillFail(DatabaseQuery::WillFail::kNever);
 
     // Look for table
-    const std::unique_ptr<RuleTable>& table = getRuleTable(query.getGroup(), query.getCategory());
+    std::shared_ptr<const DatabaseSnapshot> snapshot = getSnapshot();
+    const std::shared_ptr<const RuleTable>& table = snapshot->getRuleTable(query.getGroup(), query.getCategory());
     if (table == nullptr) {
         return QueryReturnCode::kFailure;
     }
@@ -97,7 +203,8 @@ QueryReturnCode RuleDatabase::querySimpleUniformMatch(SimpleUniformMatch& simple
     query.setWillFail(DatabaseQuery::WillFail::kNever);
 
     // Look for table
-    const std::unique_ptr<RuleTable>& table = getRuleTable(query.getGroup(), query.getCategory());
+    std::shared_ptr<const DatabaseSnapshot> snapshot = getSnapshot();
+    const std::shared_ptr<const RuleTable>& table = snapshot->getRuleTable(query.getGroup(), query.getCategory());
     if (table == nullptr) {
         return QueryReturnCode::kFailure;
     }
@@ -116,7 +223,8 @@ QueryReturnCode RuleDatabase::querySimpledWeightedMatch(SimpleWeightedMatch& sim
     query.setWillFail(DatabaseQuery::WillFail::kNever);
 
     // Look for table
-    const std::unique_ptr<RuleTable>& table = getRuleTable(query.getGroup(), query.getCategory());
+    std::shared_ptr<const DatabaseSnapshot> snapshot = getSnapshot();
+    const std::shared_ptr<const RuleTable>& table = snapshot->getRuleTable(query.getGroup(), query.getCategory());
     if (table == nullptr) {
         return QueryReturnCode::kFailure;
     }
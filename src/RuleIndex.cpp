@@ -0,0 +1,358 @@
+#include "RuleIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "RangeKernel.h"
+#include "RuleTable.h"
+
+namespace Contextual {
+
+namespace {
+const int8_t g_UNKNOWN = 0;
+const int8_t g_PASSED = 1;
+const int8_t g_FAILED = -1;
+const size_t g_WORD_BITS = 64;
+
+std::atomic<uint64_t> g_nextBuildId = 1;
+
+// Fact tags in a fingerprint, kept in the upper bits so they never collide with a value or list size
+const uint64_t g_FACT_MISSING = uint64_t{1} << 62;
+const uint64_t g_FACT_VALUE = uint64_t{2} << 62;
+const uint64_t g_FACT_LIST = uint64_t{3} << 62;
+
+size_t countTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+    size_t count = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Only criteria that depend on a single fact and have no side effects can be shared between rules
+bool isIndexable(const CriterionType type) {
+    return type == CriterionType::kStatic || type == CriterionType::kAlternate || type == CriterionType::kExist ||
+           type == CriterionType::kIncludes || type == CriterionType::kEmpty;
+}
+
+}  // namespace
+
+void RuleIndex::build(const std::vector<std::shared_ptr<RuleEntry>>& entries) {
+    clear();
+    std::map<std::pair<int, int>, uint32_t> keyIndices;
+    std::map<std::pair<uint32_t, const Criterion*>, uint32_t> predicateIndices;
+    std::vector<std::vector<uint32_t>> predicateEntries;
+    m_entries.reserve(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        IndexedEntry& indexedEntry = m_entries.emplace_back();
+        indexedEntry.residualBegin = static_cast<uint32_t>(m_residual.size());
+        bool pure = true;
+        for (const auto& criteria : entries[i]->criteria) {
+            CriterionType type = criteria->criterion->getType();
+            // Criteria after a fail chance must keep their order, otherwise the number of random rolls would change
+            if (type == CriterionType::kFail) {
+                pure = false;
+            }
+            if (!pure || !isIndexable(type)) {
+                m_residual.push_back(m_compiled.compile(criteria->tableId, criteria->keyId, *criteria->criterion));
+                continue;
+            }
+
+            auto [keyIt, keyInserted] =
+                keyIndices.try_emplace(std::make_pair(criteria->tableId, criteria->keyId), m_keys.size());
+            if (keyInserted) {
+                m_keys.push_back({criteria->tableId, criteria->keyId});
+            }
+            auto [predicateIt, predicateInserted] = predicateIndices.try_emplace(
+                std::make_pair(keyIt->second, criteria->criterion.get()), m_predicates.size());
+            if (predicateInserted) {
+                Predicate& predicate = m_predicates.emplace_back();
+                predicate.criterion = m_compiled.compile(criteria->tableId, criteria->keyId, *criteria->criterion);
+                predicate.keyIndex = keyIt->second;
+                predicateEntries.emplace_back();
+            }
+            std::vector<uint32_t>& sharedEntries = predicateEntries[predicateIt->second];
+            if (sharedEntries.empty() || sharedEntries.back() != i) {
+                sharedEntries.push_back(i);
+                indexedEntry.predicates.push_back(predicateIt->second);
+            }
+        }
+        indexedEntry.residualEnd = static_cast<uint32_t>(m_residual.size());
+    }
+    buildMasks(predicateEntries);
+    buildRanges();
+    for (const IndexedKey& indexedKey : m_keys) {
+        m_tableIds.push_back(indexedKey.tableId);
+    }
+    std::sort(m_tableIds.begin(), m_tableIds.end());
+    m_tableIds.erase(std::unique(m_tableIds.begin(), m_tableIds.end()), m_tableIds.end());
+    m_buildId = g_nextBuildId.fetch_add(1, std::memory_order_relaxed);
+    m_built = true;
+}
+
+void RuleIndex::buildMasks(const std::vector<std::vector<uint32_t>>& predicateEntries) {
+    // Entries are sorted by priority, so rules sharing a predicate tend to be close together. Each mask only spans
+    // the words between its first and last entry.
+    for (size_t i = 0; i < m_predicates.size(); ++i) {
+        const std::vector<uint32_t>& entries = predicateEntries[i];
+        Predicate& predicate = m_predicates[i];
+        predicate.maskBegin = static_cast<uint32_t>(m_masks.size());
+        predicate.firstWord = static_cast<uint32_t>(entries.front() / g_WORD_BITS);
+        predicate.numWords = static_cast<uint32_t>(entries.back() / g_WORD_BITS) - predicate.firstWord + 1;
+        m_masks.resize(m_masks.size() + predicate.numWords, 0);
+        for (const uint32_t entryIndex : entries) {
+            m_masks[predicate.maskBegin + entryIndex / g_WORD_BITS - predicate.firstWord] |= uint64_t{1}
+                                                                                             << (entryIndex % g_WORD_BITS);
+        }
+    }
+}
+
+void RuleIndex::buildRanges() {
+    std::vector<std::vector<uint32_t>> keyPredicates(m_keys.size());
+    for (uint32_t i = 0; i < m_predicates.size(); ++i) {
+        if (m_predicates[i].criterion.type == CriterionType::kStatic) {
+            keyPredicates[m_predicates[i].keyIndex].push_back(i);
+        }
+    }
+
+    m_rangeBlocks.resize(m_keys.size());
+    for (size_t keyIndex = 0; keyIndex < m_keys.size(); ++keyIndex) {
+        const std::vector<uint32_t>& predicates = keyPredicates[keyIndex];
+        if (predicates.empty()) {
+            continue;
+        }
+        RangeBlock& block = m_rangeBlocks[keyIndex];
+        block.begin = static_cast<uint32_t>(m_rangeMins.size());
+        block.count = static_cast<uint32_t>(predicates.size());
+        block.wordBegin = static_cast<uint32_t>(m_rangeInverts.size());
+        const size_t paddedCount = RangeKernel::getPaddedCount(predicates.size());
+        m_rangeMins.resize(block.begin + paddedCount, RangeKernel::getPaddingMin());
+        m_rangeMaxs.resize(block.begin + paddedCount, RangeKernel::getPaddingMax());
+        m_rangeInverts.resize(block.wordBegin + RangeKernel::getNumWords(paddedCount), 0);
+        for (size_t i = 0; i < predicates.size(); ++i) {
+            const CompiledCriterion& criterion = m_predicates[predicates[i]].criterion;
+            m_rangeMins[block.begin + i] = criterion.range.min;
+            m_rangeMaxs[block.begin + i] = criterion.range.max;
+            m_predicates[predicates[i]].rangeSlot = static_cast<uint32_t>(i);
+            if (criterion.invert) {
+                m_rangeInverts[block.wordBegin + i / RangeKernel::g_WORD_BITS] |=
+                    uint64_t{1} << (i % RangeKernel::g_WORD_BITS);
+            }
+        }
+    }
+}
+
+void RuleIndex::clear() {
+    m_keys.clear();
+    m_predicates.clear();
+    m_entries.clear();
+    m_residual.clear();
+    m_masks.clear();
+    m_tableIds.clear();
+    m_buildId = 0;
+    m_compiled.clear();
+    m_rangeBlocks.clear();
+    m_rangeMins.clear();
+    m_rangeMaxs.clear();
+    m_rangeInverts.clear();
+    m_built = false;
+}
+
+bool RuleIndex::isBuilt() const {
+    return m_built;
+}
+
+uint64_t RuleIndex::getBuildId() const {
+    return m_buildId;
+}
+
+const std::vector<int>& RuleIndex::getTableIds() const {
+    return m_tableIds;
+}
+
+RuleIndex::QueryState RuleIndex::createState() const {
+    QueryState state;
+    resetState(state);
+    return state;
+}
+
+void RuleIndex::resetState(QueryState& state) const {
+    state.facts.assign(m_keys.size(), {});
+    state.predicates.assign(m_predicates.size(), g_UNKNOWN);
+    const size_t numWords = (m_entries.size() + g_WORD_BITS - 1) / g_WORD_BITS;
+    state.surviving.assign(numWords, ~uint64_t{0});
+    if (m_entries.size() % g_WORD_BITS != 0) {
+        state.surviving.back() = (uint64_t{1} << (m_entries.size() % g_WORD_BITS)) - 1;
+    }
+    // Only read after the block is evaluated, so it needs no clearing
+    state.rangeMatches.resize(m_rangeInverts.size());
+    state.predicatesResolved = false;
+}
+
+void RuleIndex::resolvePredicates(const DatabaseQuery& query, QueryState& state) const {
+    for (size_t i = findNext(0, state); i < m_entries.size(); i = findNext(i + 1, state)) {
+        for (const uint32_t predicateIndex : m_entries[i].predicates) {
+            if (!evaluatePredicate(predicateIndex, query, state)) {
+                state.surviving[i / g_WORD_BITS] &= ~(uint64_t{1} << (i % g_WORD_BITS));
+                break;
+            }
+        }
+    }
+    state.predicatesResolved = true;
+}
+
+void RuleIndex::fingerprint(const DatabaseQuery& query, std::vector<uint64_t>& fingerprint) const {
+    fingerprint.clear();
+    for (const IndexedKey& indexedKey : m_keys) {
+        const ContextTable* contextTable = query.findContextTable(indexedKey.tableId);
+        if (contextTable == nullptr) {
+            fingerprint.push_back(g_FACT_MISSING);
+            continue;
+        }
+        if (std::optional<float> value = contextTable->getRawValue(indexedKey.keyId)) {
+            uint32_t bits;
+            std::memcpy(&bits, &*value, sizeof(bits));
+            fingerprint.push_back(g_FACT_VALUE | bits);
+        } else if (const FactList* list = contextTable->getList(indexedKey.keyId)) {
+            // Lists are sorted, so equal lists give equal words
+            fingerprint.push_back(g_FACT_LIST | list->size());
+            fingerprint.insert(fingerprint.end(), list->begin(), list->end());
+        } else {
+            fingerprint.push_back(g_FACT_MISSING);
+        }
+    }
+}
+
+size_t RuleIndex::findNext(const size_t entryIndex, const QueryState& state) const {
+    size_t word = entryIndex / g_WORD_BITS;
+    if (word >= state.surviving.size()) {
+        return m_entries.size();
+    }
+    uint64_t bits = state.surviving[word] & (~uint64_t{0} << (entryIndex % g_WORD_BITS));
+    while (bits == 0) {
+        if (++word == state.surviving.size()) {
+            return m_entries.size();
+        }
+        bits = state.surviving[word];
+    }
+    return word * g_WORD_BITS + countTrailingZeros(bits);
+}
+
+bool RuleIndex::match(const size_t entryIndex, const DatabaseQuery& query, QueryState& state) const {
+    if (((state.surviving[entryIndex / g_WORD_BITS] >> (entryIndex % g_WORD_BITS)) & 1) == 0) {
+        return false;
+    }
+    const IndexedEntry& indexedEntry = m_entries[entryIndex];
+    if (!state.predicatesResolved) {
+        for (const uint32_t predicateIndex : indexedEntry.predicates) {
+            if (!evaluatePredicate(predicateIndex, query, state)) {
+                return false;
+            }
+        }
+    }
+    for (uint32_t i = indexedEntry.residualBegin; i < indexedEntry.residualEnd; ++i) {
+        if (!m_compiled.evaluate(m_residual[i], query)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const RuleIndex::FactState& RuleIndex::loadFact(const uint32_t keyIndex, const DatabaseQuery& query,
+                                                QueryState& state) const {
+    FactState& fact = state.facts[keyIndex];
+    if (fact.loaded) {
+        return fact;
+    }
+    fact.loaded = true;
+    const IndexedKey& indexedKey = m_keys[keyIndex];
+    const ContextTable* contextTable = query.findContextTable(indexedKey.tableId);
+    if (contextTable != nullptr) {
+        fact.value = contextTable->getRawValue(indexedKey.keyId);
+        fact.list = contextTable->getList(indexedKey.keyId);
+        fact.exists = fact.value || fact.list != nullptr;
+    }
+    return fact;
+}
+
+bool RuleIndex::evaluatePredicate(const uint32_t predicateIndex, const DatabaseQuery& query, QueryState& state) const {
+    int8_t& result = state.predicates[predicateIndex];
+    if (result != g_UNKNOWN) {
+        return result == g_PASSED;
+    }
+
+    const Predicate& predicate = m_predicates[predicateIndex];
+    if (predicate.criterion.type == CriterionType::kStatic) {
+        if (!state.facts[predicate.keyIndex].rangesEvaluated) {
+            evaluateRanges(predicate.keyIndex, query, state);
+        }
+        const RangeBlock& block = m_rangeBlocks[predicate.keyIndex];
+        const uint64_t word = state.rangeMatches[block.wordBegin + predicate.rangeSlot / g_WORD_BITS];
+        const bool passed = (word >> (predicate.rangeSlot % g_WORD_BITS)) & 1;
+        setResult(predicateIndex, passed, state);
+        return passed;
+    }
+
+    const FactState& fact = loadFact(predicate.keyIndex, query, state);
+    bool passed = false;
+    switch (predicate.criterion.type) {
+        case CriterionType::kAlternate:
+            passed = fact.value && m_compiled.compareValue(predicate.criterion, *fact.value);
+            break;
+        case CriterionType::kIncludes:
+        case CriterionType::kEmpty:
+            passed = fact.list != nullptr && m_compiled.compareList(predicate.criterion, *fact.list);
+            break;
+        case CriterionType::kExist:
+            passed = CompiledCriteria::compareExists(predicate.criterion, fact.exists);
+            break;
+        default:
+            passed = m_compiled.evaluate(predicate.criterion, query);
+            break;
+    }
+
+    setResult(predicateIndex, passed, state);
+    return passed;
+}
+
+void RuleIndex::evaluateRanges(const uint32_t keyIndex, const DatabaseQuery& query, QueryState& state) const {
+    const RangeBlock& block = m_rangeBlocks[keyIndex];
+    const FactState& fact = loadFact(keyIndex, query, state);
+    uint64_t* matches = state.rangeMatches.data() + block.wordBegin;
+    const size_t paddedCount = RangeKernel::getPaddedCount(block.count);
+    const size_t numWords = RangeKernel::getNumWords(paddedCount);
+    if (fact.value) {
+        RangeKernel::evaluate(*fact.value, &m_rangeMins[block.begin], &m_rangeMaxs[block.begin], paddedCount, matches);
+        for (size_t word = 0; word < numWords; ++word) {
+            matches[word] ^= m_rangeInverts[block.wordBegin + word];
+        }
+    } else {
+        // A missing value fails every range, inverted or not
+        std::fill(matches, matches + numWords, 0);
+    }
+    state.facts[keyIndex].rangesEvaluated = true;
+}
+
+void RuleIndex::setResult(const uint32_t predicateIndex, const bool passed, QueryState& state) const {
+    state.predicates[predicateIndex] = passed ? g_PASSED : g_FAILED;
+    if (!passed) {
+        // Every rule sharing this predicate fails too
+        const Predicate& predicate = m_predicates[predicateIndex];
+        uint64_t* surviving = state.surviving.data() + predicate.firstWord;
+        const uint64_t* mask = m_masks.data() + predicate.maskBegin;
+        for (uint32_t i = 0; i < predicate.numWords; ++i) {
+            surviving[i] &= ~mask[i];
+        }
+    }
+}
+
+}  // namespace Contextual
\ No newline at end of file
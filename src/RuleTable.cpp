@@ -3,7 +3,6 @@
 #include <algorithm>
 #include <limits>
 
-#include "MathUtils.h"
 #include "ResponseMultiple.h"
 #include "ResponseSimple.h"
 
@@ -20,153 +19,208 @@ bool compareEntries(const std::shared_ptr<RuleEntry>& entry1, const std::shared_
 // Return true if all criteria match, false otherwise
 bool match(const DatabaseQuery& query, const std::vector<std::shared_ptr<Criteria>>& criteria) {
     return std::all_of(criteria.begin(), criteria.end(), [&query](const auto& criterionTuple) {
-        return criterionTuple->criterion->evaluate(criterionTuple->table, criterionTuple->key, query);
+        return criterionTuple->criterion->evaluate(criterionTuple->tableId, criterionTuple->keyId, query);
     });
 }
 
+// Simple response of an entry, looking one nested layer into multiple responses
+const ResponseSimple* getSimpleResponse(const Response& response) {
+    if (response.getType() == ResponseType::kSimple) {
+        return static_cast<const ResponseSimple*>(&response);
+    }
+    if (response.getType() == ResponseType::kMultiple) {
+        for (const auto& child : static_cast<const ResponseMultiple&>(response).getResponses()) {
+            if (child->getType() == ResponseType::kSimple) {
+                return static_cast<const ResponseSimple*>(child.get());
+            }
+        }
+    }
+    return nullptr;
+}
+
 }  // namespace
 
 void RuleTable::addEntry(std::shared_ptr<RuleEntry>& ruleEntry) {
     m_entries.push_back(std::move(ruleEntry));
     m_sorted = false;
+    m_index.clear();
+    if (m_cache != nullptr) {
+        m_cache->clear();
+    }
 }
 
 void RuleTable::addEntries(const std::vector<std::shared_ptr<RuleEntry>>& ruleEntries) {
     m_entries.reserve(m_entries.size() + ruleEntries.size());
     m_entries.insert(m_entries.end(), ruleEntries.begin(), ruleEntries.end());
+    m_sorted = false;
+    m_index.clear();
+    if (m_cache != nullptr) {
+        m_cache->clear();
+    }
 }
 
 bool RuleTable::sortEntries() {
     if (m_sorted) {
         return false;
     }
-    std::sort(m_entries.begin(), m_entries.end(), compareEntries);
+    // Stable so rules of equal priority keep their file order, which also survives a compiled round trip
+    std::stable_sort(m_entries.begin(), m_entries.end(), compareEntries);
+    m_index.build(m_entries);
+    m_sorted = true;
     return true;
 }
 
-BestMatch RuleTable::queryBest(const DatabaseQuery& query) const {
-    std::vector<std::shared_ptr<Response>> candidates;
-    int highestMatchingPriority = std::numeric_limits<int>::min();
-    for (const auto& entry : m_entries) {
-        if (entry->priority < highestMatchingPriority) {
-            break;
-        }
-        if (match(query, entry->criteria)) {
-            if (entry->priority > highestMatchingPriority) {
-                highestMatchingPriority = entry->priority;
-                candidates.clear();
-            }
-            candidates.push_back(entry->response);
-        }
+void RuleTable::enableCache(const size_t capacity) {
+    if (capacity == 0) {
+        m_cache = nullptr;
+    } else {
+        m_cache = std::make_unique<RuleCache>(capacity);
     }
+}
+
+const RuleCache* RuleTable::getCache() const {
+    return m_cache.get();
+}
 
-    // Return random candidate
-    if (candidates.empty()) {
+BestMatch RuleTable::queryBest(const DatabaseQuery& query) const {
+    QueryScratch scratch;
+    const RuleEntry* entry = queryBest(scratch, query);
+    if (entry == nullptr) {
         return {};
     }
-    if (candidates.size() == 1) {
-        return {candidates[0], highestMatchingPriority};
-    }
-    size_t index = MathUtils::randUInt(0, candidates.size() - 1);
-    return {candidates[index], highestMatchingPriority};
+    return {entry->response, entry->priority};
 }
 
 UniformMatch RuleTable::queryUniform(const DatabaseQuery& query) const {
+    QueryScratch scratch;
+    queryAll(scratch, query);
     std::vector<std::shared_ptr<Response>> options;
-    for (const auto& entry : m_entries) {
-        if (match(query, entry->criteria)) {
-            options.push_back(entry->response);
-        }
+    options.reserve(scratch.matches.size());
+    for (const uint32_t index : scratch.matches) {
+        options.push_back(m_entries[index]->response);
     }
     return {options};
 }
 
 WeightedMatch RuleTable::queryWeighted(const DatabaseQuery& query) const {
+    QueryScratch scratch;
+    queryAll(scratch, query);
     std::vector<std::pair<std::shared_ptr<Response>, int>> weightedOptions;
-    for (const auto& entry : m_entries) {
-        if (match(query, entry->criteria)) {
-            weightedOptions.emplace_back(std::make_pair(entry->response, entry->priority));
-        }
+    weightedOptions.reserve(scratch.matches.size());
+    for (const uint32_t index : scratch.matches) {
+        weightedOptions.emplace_back(m_entries[index]->response, m_entries[index]->priority);
     }
     return {weightedOptions};
 }
 
 SimpleUniformMatch RuleTable::querySimpleUniform(const DatabaseQuery& query,
                                                  const std::unordered_set<std::string>& skip, bool unique) const {
+    QueryScratch scratch;
+    querySimple(scratch, query, skip, unique);
     std::vector<std::string> options;
-    std::unordered_set<std::string> encountered;
-    for (const auto& entry : m_entries) {
-        if (match(query, entry->criteria)) {
-            ResponseType type = entry->response->getType();
-            std::shared_ptr<ResponseSimple> simpleResponse;
-            if (type == ResponseType::kSimple) {
-                simpleResponse = std::static_pointer_cast<ResponseSimple>(entry->response);
-            } else if (type == ResponseType::kMultiple) {
-                // Look one nested layer for simple
-                const auto& multipleResponse = std::static_pointer_cast<ResponseMultiple>(entry->response);
-                for (const auto& response : multipleResponse->getResponses()) {
-                    if (response->getType() == ResponseType::kSimple) {
-                        simpleResponse = std::static_pointer_cast<ResponseSimple>(response);
-                        break;
-                    }
-                }
-            }
-            if (simpleResponse == nullptr) {
-                continue;
-            }
-
-            // Add all
-            for (const auto& option : simpleResponse->getOptions()) {
-                if (skip.find(option) != skip.end() || (unique && encountered.find(option) != encountered.end())) {
-                    continue;
-                }
-                if (unique) {
-                    encountered.insert(option);
-                }
-                options.push_back(option);
-            }
-        }
+    options.reserve(scratch.simpleOptions.size());
+    for (const auto& [option, priority] : scratch.simpleOptions) {
+        options.push_back(*option);
     }
     return {options};
 }
 
 SimpleWeightedMatch RuleTable::querySimpleWeighted(const DatabaseQuery& query,
                                                    const std::unordered_set<std::string>& skip, bool unique) const {
+    QueryScratch scratch;
+    querySimple(scratch, query, skip, unique);
     std::vector<std::pair<std::string, int>> weightedOptions;
-    std::unordered_set<std::string> encountered;
-    for (const auto& entry : m_entries) {
-        if (match(query, entry->criteria)) {
-            ResponseType type = entry->response->getType();
-            std::shared_ptr<ResponseSimple> simpleResponse;
-            if (type == ResponseType::kSimple) {
-                simpleResponse = std::static_pointer_cast<ResponseSimple>(entry->response);
-            } else if (type == ResponseType::kMultiple) {
-                // Look one nested layer for simple
-                const auto& multipleResponse = std::static_pointer_cast<ResponseMultiple>(entry->response);
-                for (const auto& response : multipleResponse->getResponses()) {
-                    if (response->getType() == ResponseType::kSimple) {
-                        simpleResponse = std::static_pointer_cast<ResponseSimple>(response);
-                        break;
-                    }
-                }
-            }
-            if (simpleResponse == nullptr) {
-                continue;
+    weightedOptions.reserve(scratch.simpleOptions.size());
+    for (const auto& [option, priority] : scratch.simpleOptions) {
+        weightedOptions.emplace_back(*option, priority);
+    }
+    return {weightedOptions};
+}
+
+const RuleEntry* RuleTable::queryBest(QueryScratch& scratch, const DatabaseQuery& query) const {
+    prepareState(scratch, query);
+    scratch.matches.clear();
+    int highestMatchingPriority = std::numeric_limits<int>::min();
+    for (size_t i = nextCandidate(0, scratch); i < m_entries.size(); i = nextCandidate(i + 1, scratch)) {
+        const RuleEntry& entry = *m_entries[i];
+        if (entry.priority < highestMatchingPriority) {
+            break;
+        }
+        if (matchEntry(i, query, scratch)) {
+            if (entry.priority > highestMatchingPriority) {
+                highestMatchingPriority = entry.priority;
+                scratch.matches.clear();
             }
+            scratch.matches.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Pick a random candidate
+    if (scratch.matches.empty()) {
+        return nullptr;
+    }
+    if (scratch.matches.size() == 1) {
+        return m_entries[scratch.matches[0]].get();
+    }
+    size_t index = query.getRandom().randUInt(0, scratch.matches.size() - 1);
+    return m_entries[scratch.matches[index]].get();
+}
+
+void RuleTable::queryAll(QueryScratch& scratch, const DatabaseQuery& query) const {
+    prepareState(scratch, query);
+    scratch.matches.clear();
+    for (size_t i = nextCandidate(0, scratch); i < m_entries.size(); i = nextCandidate(i + 1, scratch)) {
+        if (matchEntry(i, query, scratch)) {
+            scratch.matches.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
 
-            // Add all
-            for (const auto& option : simpleResponse->getOptions()) {
-                if (skip.find(option) != skip.end() || (unique && encountered.find(option) != encountered.end())) {
-                    continue;
-                }
-                if (unique) {
-                    encountered.insert(option);
-                }
-                weightedOptions.emplace_back(std::make_pair(option, entry->priority));
+void RuleTable::querySimple(QueryScratch& scratch, const DatabaseQuery& query,
+                            const std::unordered_set<std::string>& skip, const bool unique) const {
+    queryAll(scratch, query);
+    auto& options = scratch.simpleOptions;
+    options.clear();
+    for (const uint32_t index : scratch.matches) {
+        const ResponseSimple* simpleResponse = getSimpleResponse(*m_entries[index]->response);
+        if (simpleResponse == nullptr) {
+            continue;
+        }
+        for (const auto& option : simpleResponse->getOptions()) {
+            if (skip.find(option) == skip.end()) {
+                options.emplace_back(&option, m_entries[index]->priority);
             }
         }
     }
-    return {weightedOptions};
+    if (!unique || options.size() < 2) {
+        return;
+    }
+
+    // Keep only the first occurrence of each option. Sorting positions by option instead of hashing avoids
+    // allocating, and breaking ties by position keeps the first occurrence at the front of each run.
+    auto& order = scratch.order;
+    order.resize(options.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&options](const uint32_t a, const uint32_t b) {
+        int compare = options[a].first->compare(*options[b].first);
+        return compare < 0 || (compare == 0 && a < b);
+    });
+    auto& duplicates = scratch.duplicates;
+    duplicates.assign(options.size(), false);
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (*options[order[i]].first == *options[order[i - 1]].first) {
+            duplicates[order[i]] = true;
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < options.size(); ++i) {
+        if (!duplicates[i]) {
+            options[kept++] = options[i];
+        }
+    }
+    options.resize(kept);
 }
 
 size_t RuleTable::getNumEntries() const {
@@ -177,4 +231,61 @@ const std::vector<std::shared_ptr<RuleEntry>> RuleTable::getEntries() const {
     return m_entries;
 }
 
+const RuleEntry& RuleTable::getEntry(const size_t index) const {
+    return *m_entries[index];
+}
+
+void RuleTable::prepareState(QueryScratch& scratch, const DatabaseQuery& query) const {
+    if (m_cache == nullptr || !m_index.isBuilt()) {
+        m_index.resetState(scratch.indexState);
+        return;
+    }
+    if (!isFingerprintCurrent(scratch, query)) {
+        m_index.fingerprint(query, scratch.fingerprint);
+        scratch.fingerprintBuildId = m_index.getBuildId();
+        scratch.fingerprintVersions.clear();
+        for (const int tableId : m_index.getTableIds()) {
+            const ContextTable* contextTable = query.findContextTable(tableId);
+            scratch.fingerprintVersions.emplace_back(contextTable,
+                                                     contextTable == nullptr ? 0 : contextTable->getVersion());
+        }
+    }
+    if (m_cache->find(scratch.fingerprint, scratch.indexState.surviving)) {
+        scratch.indexState.predicatesResolved = true;
+        return;
+    }
+    m_index.resetState(scratch.indexState);
+    m_index.resolvePredicates(query, scratch.indexState);
+    m_cache->insert(scratch.fingerprint, scratch.indexState.surviving);
+}
+
+bool RuleTable::isFingerprintCurrent(const QueryScratch& scratch, const DatabaseQuery& query) const {
+    if (scratch.fingerprintBuildId != m_index.getBuildId()) {
+        return false;
+    }
+    const std::vector<int>& tableIds = m_index.getTableIds();
+    for (size_t i = 0; i < tableIds.size(); ++i) {
+        const ContextTable* contextTable = query.findContextTable(tableIds[i]);
+        const uint64_t version = contextTable == nullptr ? 0 : contextTable->getVersion();
+        if (scratch.fingerprintVersions[i] != std::make_pair(contextTable, version)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t RuleTable::nextCandidate(const size_t index, const QueryScratch& scratch) const {
+    if (m_index.isBuilt()) {
+        return m_index.findNext(index, scratch.indexState);
+    }
+    return index;
+}
+
+bool RuleTable::matchEntry(const size_t index, const DatabaseQuery& query, QueryScratch& scratch) const {
+    if (m_index.isBuilt()) {
+        return m_index.match(index, query, scratch.indexState);
+    }
+    return match(query, m_entries[index]->criteria);
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -1,35 +1,144 @@
 #include "StringTable.h"
 
+#include <functional>
+
 namespace Contextual {
 
 namespace {
-const uint32_t g_STARTING_ID = 1000;
+const uint32_t g_STARTING_ID = StringTable::g_FIRST_SYMBOL;
+const size_t g_FIRST_CHUNK_SIZE = 1024;
+const size_t g_INITIAL_CAPACITY = 1024;
+
+uint32_t hashString(const std::string_view str) {
+    // Never zero, so that an entry can never be mistaken for an empty slot
+    return static_cast<uint32_t>(std::hash<std::string_view>()(str)) | 1u;
+}
+
+// Chunk k holds g_FIRST_CHUNK_SIZE << k strings
+void locate(const uint32_t index, size_t& chunk, size_t& offset) {
+    const size_t n = index + g_FIRST_CHUNK_SIZE;
+    size_t bit = 63;
+    while (!(n >> bit)) {
+        --bit;
+    }
+    chunk = bit - 10;
+    offset = n - (size_t(1) << bit);
 }
 
-StringTable::StringTable() {
-    m_nextId = g_STARTING_ID;
+}  // namespace
+
+StringTable::HashIndex::HashIndex(const size_t capacity)
+    : mask(capacity - 1), slots(std::make_unique<std::atomic<uint64_t>[]>(capacity)) {
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(0, std::memory_order_relaxed);
+    }
 }
 
-int StringTable::cache(const std::string& str) {
-    auto got = m_cache.find(str);
-    if (got == m_cache.end()) {
-        m_cache.emplace(str, m_nextId);
-        m_lookup.emplace(m_nextId, str);
-        return m_nextId++;
+StringTable::StringTable() : m_size(0) {
+    for (auto& chunk : m_chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    m_indices.push_back(std::make_unique<HashIndex>(g_INITIAL_CAPACITY));
+    m_index.store(m_indices.back().get(), std::memory_order_release);
+}
+
+StringTable::~StringTable() {
+    for (auto& chunk : m_chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+int StringTable::cache(const std::string_view str) {
+    const uint32_t hash = hashString(str);
+    if (std::optional<int> symbol = find(str, hash)) {
+        return *symbol;
+    }
+
+    std::lock_guard lock(m_writeMutex);
+    // Another writer may have added it in the meantime
+    if (std::optional<int> symbol = find(str, hash)) {
+        return *symbol;
     }
-    return got->second;
+
+    // Store the string before publishing it
+    const uint32_t index = m_size.load(std::memory_order_relaxed);
+    size_t chunk;
+    size_t offset;
+    locate(index, chunk, offset);
+    std::string* strings = m_chunks[chunk].load(std::memory_order_relaxed);
+    if (strings == nullptr) {
+        strings = new std::string[g_FIRST_CHUNK_SIZE << chunk];
+        m_chunks[chunk].store(strings, std::memory_order_release);
+    }
+    strings[offset] = std::string(str);
+    m_size.store(index + 1, std::memory_order_release);
+
+    // Keep the load factor at most one half
+    HashIndex* hashIndex = m_index.load(std::memory_order_relaxed);
+    if ((index + 1) * 2 > hashIndex->mask + 1) {
+        auto grown = std::make_unique<HashIndex>((hashIndex->mask + 1) * 2);
+        for (size_t i = 0; i <= hashIndex->mask; ++i) {
+            uint64_t entry = hashIndex->slots[i].load(std::memory_order_relaxed);
+            if (entry != 0) {
+                insertIndex(*grown, entry);
+            }
+        }
+        hashIndex = grown.get();
+        m_indices.push_back(std::move(grown));
+        m_index.store(hashIndex, std::memory_order_release);
+    }
+
+    const int symbol = static_cast<int>(index + g_STARTING_ID);
+    insertIndex(*hashIndex, (static_cast<uint64_t>(hash) << 32) | static_cast<uint32_t>(symbol));
+    return symbol;
 }
 
-std::optional<std::string> StringTable::lookup(int symbol) const {
-    auto got = m_lookup.find(symbol);
-    if (got == m_lookup.end()) {
+std::optional<std::string_view> StringTable::lookup(const int symbol) const {
+    if (symbol < static_cast<int>(g_STARTING_ID)) {
+        return std::nullopt;
+    }
+    const auto index = static_cast<uint32_t>(symbol - g_STARTING_ID);
+    if (index >= m_size.load(std::memory_order_acquire)) {
         return std::nullopt;
     }
-    return got->second;
+    return *getString(index);
 }
 
 size_t StringTable::getSize() const {
-    return m_cache.size();
+    return m_size.load(std::memory_order_acquire);
+}
+
+std::optional<int> StringTable::find(const std::string_view str, const uint32_t hash) const {
+    const HashIndex* hashIndex = m_index.load(std::memory_order_acquire);
+    for (size_t i = hash & hashIndex->mask;; i = (i + 1) & hashIndex->mask) {
+        const uint64_t entry = hashIndex->slots[i].load(std::memory_order_acquire);
+        if (entry == 0) {
+            return std::nullopt;
+        }
+        if (static_cast<uint32_t>(entry >> 32) != hash) {
+            continue;
+        }
+        const auto symbol = static_cast<int>(static_cast<uint32_t>(entry));
+        if (*getString(symbol - g_STARTING_ID) == str) {
+            return symbol;
+        }
+    }
+}
+
+const std::string* StringTable::getString(const uint32_t index) const {
+    size_t chunk;
+    size_t offset;
+    locate(index, chunk, offset);
+    return m_chunks[chunk].load(std::memory_order_acquire) + offset;
+}
+
+void StringTable::insertIndex(HashIndex& index, const uint64_t entry) const {
+    for (size_t i = static_cast<uint32_t>(entry >> 32) & index.mask;; i = (i + 1) & index.mask) {
+        if (index.slots[i].load(std::memory_order_relaxed) == 0) {
+            index.slots[i].store(entry, std::memory_order_release);
+            return;
+        }
+    }
 }
 
 }  // namespace Contextual
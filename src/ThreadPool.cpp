@@ -0,0 +1,139 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace Contextual {
+
+namespace {
+
+// State of one parallelFor call
+class ParallelBatch {
+public:
+    ParallelBatch(const size_t count, const std::function<void(size_t)>& task) : m_count(count), m_task(task) {}
+
+    // Run tasks until the indices run out. The first exception stops the batch and is kept for the caller.
+    void drain() {
+        for (size_t i = m_nextIndex++; i < m_count; i = m_nextIndex++) {
+            try {
+                m_task(i);
+            } catch (...) {
+                m_nextIndex = m_count;
+                std::lock_guard lock(m_mutex);
+                if (!m_error) {
+                    m_error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    // Returns false once the caller has stopped waiting, in which case the task must not be touched
+    bool tryJoin() {
+        std::lock_guard lock(m_mutex);
+        if (m_closed || m_nextIndex >= m_count) {
+            return false;
+        }
+        ++m_numActive;
+        return true;
+    }
+
+    void leave() {
+        std::lock_guard lock(m_mutex);
+        if (--m_numActive == 0) {
+            m_condition.notify_one();
+        }
+    }
+
+    // Wait for the helpers that joined, then rethrow the first exception
+    void close() {
+        std::unique_lock lock(m_mutex);
+        m_closed = true;
+        m_condition.wait(lock, [this]() { return m_numActive == 0; });
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+private:
+    const size_t m_count;
+    const std::function<void(size_t)>& m_task;
+    std::atomic<size_t> m_nextIndex = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    size_t m_numActive = 0;
+    bool m_closed = false;
+    std::exception_ptr m_error;
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(const size_t numThreads) {
+    m_workers.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(const size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    // Shared with the queued helpers, which may only be dequeued after this call has returned
+    auto batch = std::make_shared<ParallelBatch>(count, task);
+
+    // Each helper pulls indices until none are left, so uneven tasks balance out
+    size_t numHelpers = std::min(m_workers.size(), count - 1);
+    {
+        std::lock_guard lock(m_mutex);
+        for (size_t i = 0; i < numHelpers; ++i) {
+            m_tasks.emplace([batch]() {
+                if (batch->tryJoin()) {
+                    batch->drain();
+                    batch->leave();
+                }
+            });
+        }
+    }
+    m_condition.notify_all();
+
+    // Helpers that have not started yet are turned away instead of waited for, so a task may call parallelFor
+    // on the same pool without every worker blocking on helpers that are stuck in the queue
+    batch->drain();
+    batch->close();
+}
+
+size_t ThreadPool::getNumThreads() const {
+    return m_workers.size();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+
+}  // namespace Contextual
\ No newline at end of file
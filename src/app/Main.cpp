@@ -3,6 +3,7 @@
 #include <plog/Init.h>
 #include <plog/Log.h>
 
+#include <filesystem>
 #include <functional>
 #include <iostream>
 #include <optional>
@@ -11,6 +12,7 @@
 
 #include "AppSettings.h"
 #include "ContextParser.h"
+#include "DatabaseCompiler.h"
 #include "DatabaseParser.h"
 #include "DefaultFunctionTable.h"
 #include "QueryParser.h"
@@ -19,6 +21,10 @@
 
 const std::string g_OP_QUERY = "query";
 const std::string g_OP_TEST = "test";
+const std::string g_OP_COMPILE = "compile";
+
+const std::string g_COMPILED_EXTENSION = ".ctxdb";
+const std::string g_COMPILED_NAME = "database" + g_COMPILED_EXTENSION;
 
 const std::string g_QUERY_BEST = "best";
 const std::string g_QUERY_ALL = "all";
@@ -32,6 +38,7 @@ const std::unordered_map<std::string, std::function<void(AppSettings&)>> NoArgHa
 
 const std::unordered_map<std::string, std::function<void(AppSettings&, const std::string&)>> OneArgHandles = {
     {"--input", [](AppSettings& s, const std::string& arg) { s.inputDir = arg; }},
+    {"--output", [](AppSettings& s, const std::string& arg) { s.outputFile = arg; }},
     {"--group", [](AppSettings& s, const std::string& arg) { s.group = arg; }},
     {"--category", [](AppSettings& s, const std::string& arg) { s.category = arg; }},
     {"--query", [](AppSettings& s, const std::string& arg) { s.queryType = arg; }},
@@ -76,7 +83,10 @@ void printUsage(const std::string& name) {
     PLOG_INFO << "Usage: " << name << " <operation>\n\n"
               << g_OP_QUERY
               << " <query_json> [path_to_rule_database]\n"
-                 "\tQueries the rule database with a group, category, and context.\n";
+                 "\tQueries the rule database with a group, category, and context.\n"
+              << g_OP_COMPILE
+              << " [--input json_directory] [--output compiled_file]\n"
+                 "\tCompiles a JSON rule database into a binary file that can be passed to --input.\n";
 }
 
 std::string tokensToString(const std::vector<std::shared_ptr<Contextual::SpeechToken>>& speechTokens) {
@@ -96,6 +106,20 @@ bool loadDatabase(std::shared_ptr<Contextual::RuleDatabase>& database, const App
     std::shared_ptr<Contextual::ContextManager> contextManager =
         std::make_shared<Contextual::ContextManager>(std::move(functionTable));
     database = std::make_shared<Contextual::RuleDatabase>(contextManager);
+
+    // Compiled databases are single files, JSON databases are directories
+    if (std::filesystem::path(settings.inputDir).extension() == g_COMPILED_EXTENSION) {
+        Contextual::DatabaseCompiler::CompileStats compileStats{};
+        Contextual::DatabaseCompiler::CompileResult result =
+            Contextual::DatabaseCompiler::loadDatabase(compileStats, *database, settings.inputDir);
+        if (result.code != Contextual::DatabaseCompiler::CompileReturnCode::kSuccess) {
+            PLOG_ERROR << result.errorMsg;
+            return false;
+        }
+        PLOG_DEBUG << "Loaded " << compileStats.numRules << " rules in " << compileStats.numTables << " tables";
+        return true;
+    }
+
     Contextual::DatabaseParser::DatabaseStats stats =
         Contextual::DatabaseParser::loadDatabase(*database, settings.inputDir);
     return stats.numLoaded > 0 && stats.numFailed == 0;
@@ -171,6 +195,26 @@ void doQuery(AppSettings& settings, const std::string& name) {
     }
 }
 
+void doCompile(AppSettings& settings, const std::string& name) {
+    std::shared_ptr<Contextual::RuleDatabase> database;
+    bool success = loadDatabase(database, settings);
+    if (!success) {
+        PLOG_ERROR << "Failed to load database";
+        return;
+    }
+
+    std::string outputFile =
+        settings.outputFile.value_or((std::filesystem::path(settings.inputDir) / g_COMPILED_NAME).string());
+    Contextual::DatabaseCompiler::CompileStats stats{};
+    Contextual::DatabaseCompiler::CompileResult result =
+        Contextual::DatabaseCompiler::writeDatabase(stats, *database, outputFile);
+    if (result.code != Contextual::DatabaseCompiler::CompileReturnCode::kSuccess) {
+        PLOG_ERROR << "Failed to compile database: " << result.errorMsg;
+        return;
+    }
+    PLOG_INFO << "Compiled " << stats.numRules << " rules in " << stats.numTables << " tables to " << outputFile;
+}
+
 void doTest(AppSettings& settings, const std::string& name) {
     PLOG_INFO << "TEST";
 }
@@ -195,6 +239,8 @@ int main(int argc, const char* argv[]) {
 
     if (*settings.operation == g_OP_QUERY) {
         doQuery(settings, argv[0]);
+    } else if (*settings.operation == g_OP_COMPILE) {
+        doCompile(settings, argv[0]);
     } else if (*settings.operation == g_OP_TEST) {
         doTest(settings, argv[0]);
     } else {
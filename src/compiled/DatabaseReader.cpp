@@ -0,0 +1,615 @@
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <string_view>
+
+#include "CompiledFormat.h"
+#include "CriterionAlternate.h"
+#include "CriterionDynamic.h"
+#include "CriterionEmpty.h"
+#include "CriterionExist.h"
+#include "CriterionFail.h"
+#include "CriterionIncludes.h"
+#include "CriterionStatic.h"
+#include "DatabaseCompiler.h"
+#include "FunctionTable.h"
+#include "MappedFile.h"
+#include "ResponseContextAdd.h"
+#include "ResponseContextInvert.h"
+#include "ResponseContextMultiply.h"
+#include "ResponseContextSetDynamic.h"
+#include "ResponseContextSetList.h"
+#include "ResponseContextSetStatic.h"
+#include "ResponseEvent.h"
+#include "ResponseMultiple.h"
+#include "ResponseSimple.h"
+#include "ResponseSpeech.h"
+#include "TextToken.h"
+#include "TokenBoolean.h"
+#include "TokenContext.h"
+#include "TokenFloat.h"
+#include "TokenFunction.h"
+#include "TokenInt.h"
+#include "TokenList.h"
+#include "TokenString.h"
+
+namespace Contextual::DatabaseCompiler {
+
+namespace {
+
+using CompiledFormat::CriterionTag;
+using CompiledFormat::ResponseTag;
+using CompiledFormat::TokenTag;
+
+const CompileResult g_RESULT_SUCCESS = {CompileReturnCode::kSuccess, ""};
+
+// Bounds-checked cursor over the mapped words. Any out of range read or index marks the cursor as failed and
+// returns zero, so callers only need to check once per object.
+class Cursor {
+public:
+    Cursor(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+    uint32_t next() {
+        if (m_failed || m_pos + sizeof(uint32_t) > m_size) {
+            m_failed = true;
+            return 0;
+        }
+        uint32_t value;
+        std::memcpy(&value, m_data + m_pos, sizeof(value));
+        m_pos += sizeof(value);
+        return value;
+    }
+
+    int nextInt() {
+        return static_cast<int>(next());
+    }
+
+    float nextFloat() {
+        uint32_t bits = next();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    bool nextBool() {
+        return next() != 0;
+    }
+
+    // Index into a pool that has already been read
+    uint32_t nextIndex(size_t poolSize) {
+        uint32_t index = next();
+        if (index >= poolSize) {
+            m_failed = true;
+            return 0;
+        }
+        return index;
+    }
+
+    // Element count that must fit in the remaining bytes, given the words per element
+    uint32_t nextCount(size_t wordsPerElement) {
+        uint32_t count = next();
+        if (wordsPerElement > 0 && count > (m_size - m_pos) / (wordsPerElement * sizeof(uint32_t))) {
+            m_failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    const char* take(size_t bytes) {
+        if (m_failed || m_pos + bytes > m_size) {
+            m_failed = true;
+            return nullptr;
+        }
+        const char* ptr = m_data + m_pos;
+        m_pos += bytes;
+        return ptr;
+    }
+
+    void fail() {
+        m_failed = true;
+    }
+
+    [[nodiscard]] bool failed() const {
+        return m_failed;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
+
+class Reader {
+public:
+    explicit Reader(Cursor& cursor) : m_cursor(cursor) {}
+
+    CompileResult readHeader(size_t fileSize) {
+        const char* magic = m_cursor.take(sizeof(CompiledFormat::g_MAGIC));
+        if (magic == nullptr || std::memcmp(magic, CompiledFormat::g_MAGIC, sizeof(CompiledFormat::g_MAGIC)) != 0) {
+            return {CompileReturnCode::kInvalidFormat, "Not a compiled rule database"};
+        }
+        uint32_t version = m_cursor.next();
+        uint32_t byteOrder = m_cursor.next();
+        uint32_t size = m_cursor.next();
+        if (version != CompiledFormat::g_VERSION) {
+            return {CompileReturnCode::kVersionMismatch, "Compiled database has version " + std::to_string(version) +
+                                                             ", expected " + std::to_string(CompiledFormat::g_VERSION)};
+        }
+        if (byteOrder != CompiledFormat::g_BYTE_ORDER_MARK) {
+            return {CompileReturnCode::kVersionMismatch, "Compiled database was written with a different byte order"};
+        }
+        if (size != fileSize) {
+            return {CompileReturnCode::kInvalidFormat, "Compiled database is truncated"};
+        }
+        return g_RESULT_SUCCESS;
+    }
+
+    // Strings are views into the mapping and are only copied when an object needs to own one
+    bool readStrings() {
+        uint32_t count = m_cursor.nextCount(2);
+        const char* header = m_cursor.take(static_cast<size_t>(count) * 2 * sizeof(uint32_t));
+        uint32_t blobSize = m_cursor.next();
+        const char* blob = m_cursor.take(blobSize);
+        if (m_cursor.failed()) {
+            return false;
+        }
+        m_strings.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t range[2];
+            std::memcpy(range, header + i * sizeof(range), sizeof(range));
+            if (static_cast<uint64_t>(range[0]) + range[1] > blobSize) {
+                return false;
+            }
+            m_strings.emplace_back(blob + range[0], range[1]);
+        }
+        return true;
+    }
+
+    // Symbols in the file are remapped to whatever IDs the live string table gives the same strings, so the table
+    // may already hold other strings, including those of another compiled database
+    bool readSymbols(StringTable& stringTable) {
+        uint32_t count = m_cursor.nextCount(1);
+        std::vector<std::string_view> symbols;
+        symbols.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            symbols.push_back(nextString());
+        }
+        // Only cache once the whole section is known to be valid
+        if (m_cursor.failed()) {
+            return false;
+        }
+        m_symbolIds.reserve(count);
+        for (std::string_view str : symbols) {
+            m_symbolIds.push_back(stringTable.cache(str));
+        }
+        return true;
+    }
+
+    bool readTokens(const FunctionTable& functionTable) {
+        uint32_t count = m_cursor.nextCount(2);
+        m_tokens.reserve(count);
+        m_symbolTokens.reserve(count);
+        for (uint32_t i = 0; i < count && !m_cursor.failed(); ++i) {
+            std::shared_ptr<SymbolToken> symbolToken;
+            std::shared_ptr<SpeechToken> textToken;
+            auto tag = static_cast<TokenTag>(m_cursor.next());
+            switch (tag) {
+                case TokenTag::kLiteral:
+                    textToken = std::make_shared<TextLiteral>(std::string(nextString()));
+                    break;
+                case TokenTag::kFormat:
+                    textToken = std::make_shared<TextFormat>(std::string(nextString()));
+                    break;
+                case TokenTag::kFormatBool: {
+                    std::string attribute(nextString());
+                    textToken = std::make_shared<TextFormatBool>(std::move(attribute), m_cursor.nextBool());
+                    break;
+                }
+                case TokenTag::kFormatFloat: {
+                    std::string attribute(nextString());
+                    textToken = std::make_shared<TextFormatFloat>(std::move(attribute), m_cursor.nextFloat());
+                    break;
+                }
+                case TokenTag::kFormatInt: {
+                    std::string attribute(nextString());
+                    textToken = std::make_shared<TextFormatInt>(std::move(attribute), m_cursor.nextInt());
+                    break;
+                }
+                case TokenTag::kFormatString: {
+                    std::string attribute(nextString());
+                    textToken = std::make_shared<TextFormatString>(std::move(attribute), std::string(nextString()));
+                    break;
+                }
+                case TokenTag::kBoolean:
+                    symbolToken = std::make_shared<TokenBoolean>(m_cursor.nextBool());
+                    break;
+                case TokenTag::kInt:
+                    symbolToken = std::make_shared<TokenInt>(m_cursor.nextInt());
+                    break;
+                case TokenTag::kFloat:
+                    symbolToken = std::make_shared<TokenFloat>(m_cursor.nextFloat());
+                    break;
+                case TokenTag::kString:
+                    symbolToken = std::make_shared<TokenString>(std::string(nextString()));
+                    break;
+                case TokenTag::kContext: {
+                    std::string table(nextString());
+                    symbolToken = std::make_shared<TokenContext>(std::move(table), std::string(nextString()));
+                    break;
+                }
+                case TokenTag::kFunction: {
+                    std::string name(nextString());
+                    std::vector<std::shared_ptr<SymbolToken>> args = nextSymbolTokens();
+                    // Bind the function now so evaluating the token never looks it up by name
+                    const std::unique_ptr<FunctionSig>& sig = functionTable.getSignature(name);
+                    if (sig == nullptr || !FunctionTable::validateArgs(sig, args)) {
+                        m_cursor.fail();
+                        break;
+                    }
+                    symbolToken = std::make_shared<TokenFunction>(std::move(name), std::move(args), sig.get());
+                    break;
+                }
+                case TokenTag::kList:
+                    symbolToken = std::make_shared<TokenList>(nextSymbolTokens());
+                    break;
+                default:
+                    m_cursor.fail();
+                    break;
+            }
+            m_symbolTokens.push_back(symbolToken);
+            m_tokens.push_back(symbolToken != nullptr ? symbolToken : textToken);
+        }
+        return !m_cursor.failed();
+    }
+
+    bool readCriterions() {
+        uint32_t count = m_cursor.nextCount(2);
+        m_criterions.reserve(count);
+        for (uint32_t i = 0; i < count && !m_cursor.failed(); ++i) {
+            std::shared_ptr<Criterion> criterion;
+            auto tag = static_cast<CriterionTag>(m_cursor.next());
+            switch (tag) {
+                case CriterionTag::kStatic: {
+                    float min = m_cursor.nextFloat();
+                    float max = m_cursor.nextFloat();
+                    bool invert = m_cursor.nextBool();
+                    bool isSymbol = m_cursor.nextBool();
+                    // Equality with a string compiles to a range holding only its symbol
+                    if (isSymbol) {
+                        min = max = mapSymbol(min);
+                    }
+                    criterion = std::make_shared<CriterionStatic>(min, max, invert, isSymbol);
+                    break;
+                }
+                case CriterionTag::kAlternate: {
+                    bool invert = m_cursor.nextBool();
+                    std::unordered_set<int> symbols;
+                    std::vector<int> options = nextOptions(symbols);
+                    criterion = std::make_shared<CriterionAlternate>(
+                        std::unordered_set<int>(options.begin(), options.end()), invert, std::move(symbols));
+                    break;
+                }
+                case CriterionTag::kDynamic: {
+                    float minDelta = m_cursor.nextFloat();
+                    float maxDelta = m_cursor.nextFloat();
+                    std::string otherTable(nextString());
+                    std::string otherKey(nextString());
+                    criterion = std::make_shared<CriterionDynamic>(minDelta, maxDelta, std::move(otherTable),
+                                                                   std::move(otherKey), m_cursor.nextBool());
+                    break;
+                }
+                case CriterionTag::kExist:
+                    criterion = std::make_shared<CriterionExist>(m_cursor.nextBool());
+                    break;
+                case CriterionTag::kIncludes: {
+                    bool invert = m_cursor.nextBool();
+                    std::unordered_set<int> symbols;
+                    std::vector<int> options = nextOptions(symbols);
+                    criterion = std::make_shared<CriterionIncludes>(std::move(options), invert, std::move(symbols));
+                    break;
+                }
+                case CriterionTag::kEmpty:
+                    criterion = std::make_shared<CriterionEmpty>(m_cursor.nextBool());
+                    break;
+                case CriterionTag::kFail:
+                    criterion = std::make_shared<CriterionFail>(m_cursor.nextFloat());
+                    break;
+                default:
+                    m_cursor.fail();
+                    break;
+            }
+            m_criterions.push_back(std::move(criterion));
+        }
+        return !m_cursor.failed();
+    }
+
+    bool readCriteria() {
+        uint32_t count = m_cursor.nextCount(3);
+        m_criteria.reserve(count);
+        for (uint32_t i = 0; i < count && !m_cursor.failed(); ++i) {
+            std::string table(nextString());
+            std::string key(nextString());
+            m_criteria.push_back(std::make_shared<Criteria>(std::move(table), std::move(key), nextRef(m_criterions)));
+        }
+        return !m_cursor.failed();
+    }
+
+    bool readResponses() {
+        uint32_t count = m_cursor.nextCount(2);
+        m_responses.reserve(count);
+        for (uint32_t i = 0; i < count && !m_cursor.failed(); ++i) {
+            m_responses.push_back(nextResponse());
+        }
+        return !m_cursor.failed();
+    }
+
+    bool readEntries() {
+        uint32_t count = m_cursor.nextCount(4);
+        m_entries.reserve(count);
+        for (uint32_t i = 0; i < count && !m_cursor.failed(); ++i) {
+            auto entry = std::make_shared<RuleEntry>();
+            entry->id = nextString();
+            entry->priority = m_cursor.nextInt();
+            uint32_t response = m_cursor.next();
+            if (response != CompiledFormat::g_NULL_INDEX) {
+                if (response >= m_responses.size()) {
+                    m_cursor.fail();
+                    break;
+                }
+                entry->response = m_responses[response];
+            }
+            uint32_t numCriteria = m_cursor.nextCount(1);
+            entry->criteria.reserve(numCriteria);
+            for (uint32_t j = 0; j < numCriteria; ++j) {
+                entry->criteria.push_back(nextRef(m_criteria));
+            }
+            m_entries.push_back(std::move(entry));
+        }
+        return !m_cursor.failed();
+    }
+
+    CompileResult readTables(CompileStats& stats, RuleDatabase& database) {
+        uint32_t count = m_cursor.nextCount(3);
+        std::set<std::pair<std::string, std::string>> names;
+        std::vector<RuleTableUpdate> updates;
+        updates.reserve(count);
+        for (uint32_t i = 0; i < count && !m_cursor.failed(); ++i) {
+            std::string group(nextString());
+            std::string category(nextString());
+            uint32_t numEntries = m_cursor.nextCount(1);
+            std::vector<std::shared_ptr<RuleEntry>> entries;
+            entries.reserve(numEntries);
+            for (uint32_t j = 0; j < numEntries; ++j) {
+                entries.push_back(nextRef(m_entries));
+            }
+            if (m_cursor.failed()) {
+                break;
+            }
+
+            // Entries were written in sorted order and the sort is stable, so this only builds the index
+            auto ruleTable = std::make_shared<RuleTable>();
+            ruleTable->addEntries(entries);
+            ruleTable->sortEntries();
+            ruleTable->enableCache(database.getCacheCapacity());
+            if (database.getRuleTable(group, category) != nullptr || !names.insert({group, category}).second) {
+                return {CompileReturnCode::kInvalidFormat,
+                        "Category \"" + category + "\" for group \"" + group + "\" is already defined"};
+            }
+            updates.push_back({group, category, std::move(ruleTable)});
+            ++stats.numTables;
+            stats.numRules += numEntries;
+        }
+        // Tables only become visible once the whole file has been read
+        if (!m_cursor.failed()) {
+            database.updateRuleTables(updates);
+        }
+        return g_RESULT_SUCCESS;
+    }
+
+private:
+    Cursor& m_cursor;
+    std::vector<std::string_view> m_strings;
+    // Live symbol of each symbol in the file, by file symbol index
+    std::vector<int> m_symbolIds;
+    std::vector<std::shared_ptr<SpeechToken>> m_tokens;
+    // Same indices as m_tokens, null for text tokens
+    std::vector<std::shared_ptr<SymbolToken>> m_symbolTokens;
+    std::vector<std::shared_ptr<Criterion>> m_criterions;
+    std::vector<std::shared_ptr<Criteria>> m_criteria;
+    std::vector<std::shared_ptr<Response>> m_responses;
+    std::vector<std::shared_ptr<RuleEntry>> m_entries;
+
+    // Reads an index into an earlier pool, returning an empty value once the cursor has failed
+    template <typename T>
+    T nextRef(const std::vector<T>& pool) {
+        uint32_t index = m_cursor.nextIndex(pool.size());
+        return m_cursor.failed() ? T() : pool[index];
+    }
+
+    std::string_view nextString() {
+        return nextRef(m_strings);
+    }
+
+    // Live symbol of a value the file marks as a symbol. A value outside the file's symbols is corrupt.
+    int mapSymbol(int value) {
+        int64_t index = static_cast<int64_t>(value) - StringTable::g_FIRST_SYMBOL;
+        if (index < 0 || index >= static_cast<int64_t>(m_symbolIds.size())) {
+            m_cursor.fail();
+            return value;
+        }
+        return m_symbolIds[index];
+    }
+
+    float mapSymbol(float value) {
+        const auto first = static_cast<float>(StringTable::g_FIRST_SYMBOL);
+        if (!(value >= first && value < first + static_cast<float>(m_symbolIds.size())) || value != std::floor(value)) {
+            m_cursor.fail();
+            return value;
+        }
+        return static_cast<float>(m_symbolIds[static_cast<size_t>(value - first)]);
+    }
+
+    // Options written by putOptions, with the symbols remapped and also collected into symbols
+    std::vector<int> nextOptions(std::unordered_set<int>& symbols) {
+        uint32_t count = m_cursor.nextCount(2);
+        std::vector<int> options;
+        options.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            int option = m_cursor.nextInt();
+            if (m_cursor.nextBool()) {
+                option = mapSymbol(option);
+                symbols.insert(option);
+            }
+            options.push_back(option);
+        }
+        return options;
+    }
+
+    std::vector<int> nextInts() {
+        uint32_t count = m_cursor.nextCount(1);
+        std::vector<int> values;
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(m_cursor.nextInt());
+        }
+        return values;
+    }
+
+    std::vector<std::shared_ptr<SymbolToken>> nextSymbolTokens() {
+        uint32_t count = m_cursor.nextCount(1);
+        std::vector<std::shared_ptr<SymbolToken>> tokens;
+        tokens.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            auto token = nextRef(m_symbolTokens);
+            if (token == nullptr) {
+                m_cursor.fail();
+                break;
+            }
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    std::shared_ptr<Response> nextResponse() {
+        auto tag = static_cast<ResponseTag>(m_cursor.next());
+        switch (tag) {
+            case ResponseTag::kSimple: {
+                uint32_t count = m_cursor.nextCount(1);
+                std::vector<std::string> options;
+                options.reserve(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    options.emplace_back(nextString());
+                }
+                return std::make_shared<ResponseSimple>(std::move(options));
+            }
+            case ResponseTag::kMultiple: {
+                uint32_t count = m_cursor.nextCount(1);
+                std::vector<std::shared_ptr<Response>> responses;
+                responses.reserve(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    responses.push_back(nextRef(m_responses));
+                }
+                return std::make_shared<ResponseMultiple>(std::move(responses));
+            }
+            case ResponseTag::kSpeech: {
+                uint32_t numLines = m_cursor.nextCount(1);
+                std::vector<std::vector<std::shared_ptr<SpeechToken>>> lines(numLines);
+                for (auto& line : lines) {
+                    uint32_t numTokens = m_cursor.nextCount(1);
+                    line.reserve(numTokens);
+                    for (uint32_t i = 0; i < numTokens; ++i) {
+                        line.push_back(nextRef(m_tokens));
+                    }
+                }
+                return std::make_shared<ResponseSpeech>(std::move(lines));
+            }
+            case ResponseTag::kEvent: {
+                std::string name(nextString());
+                uint32_t count = m_cursor.nextCount(1);
+                std::vector<std::string> args;
+                args.reserve(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    args.emplace_back(nextString());
+                }
+                return std::make_shared<ResponseEvent>(std::move(name), std::move(args));
+            }
+            default:
+                return nextContextResponse(tag);
+        }
+    }
+
+    std::shared_ptr<Response> nextContextResponse(ResponseTag tag) {
+        std::string table(nextString());
+        std::string key(nextString());
+        switch (tag) {
+            case ResponseTag::kContextSetStatic: {
+                auto type = static_cast<FactType>(m_cursor.next());
+                float value = m_cursor.nextFloat();
+                if (type == FactType::kString) {
+                    value = mapSymbol(value);
+                }
+                return std::make_shared<ResponseContextSetStatic>(std::move(table), std::move(key), type, value);
+            }
+            case ResponseTag::kContextSetDynamic: {
+                std::string otherTable(nextString());
+                return std::make_shared<ResponseContextSetDynamic>(std::move(table), std::move(key),
+                                                                   std::move(otherTable), std::string(nextString()));
+            }
+            case ResponseTag::kContextSetList: {
+                bool isStringList = m_cursor.nextBool();
+                FactList values;
+                for (int value : nextInts()) {
+                    values.insert(isStringList ? mapSymbol(value) : value);
+                }
+                return std::make_shared<ResponseContextSetList>(std::move(table), std::move(key), std::move(values),
+                                                                isStringList);
+            }
+            case ResponseTag::kContextAdd:
+                return std::make_shared<ResponseContextAdd>(std::move(table), std::move(key), m_cursor.nextFloat());
+            case ResponseTag::kContextMultiply:
+                return std::make_shared<ResponseContextMultiply>(std::move(table), std::move(key),
+                                                                 m_cursor.nextFloat());
+            case ResponseTag::kContextInvert:
+                return std::make_shared<ResponseContextInvert>(std::move(table), std::move(key));
+            default:
+                m_cursor.fail();
+                return nullptr;
+        }
+    }
+};
+
+}  // namespace
+
+CompileResult loadDatabase(CompileStats& stats, RuleDatabase& database, const std::string& path) {
+    stats = {0, 0};
+    MappedFile file;
+    if (!file.open(path)) {
+        return {CompileReturnCode::kInvalidPath, "No compiled database found at path \"" + path + "\""};
+    }
+
+    Cursor cursor(file.getData(), file.getSize());
+    Reader reader(cursor);
+    auto result = reader.readHeader(file.getSize());
+    if (result.code != CompileReturnCode::kSuccess) {
+        return result;
+    }
+    if (!reader.readStrings()) {
+        return {CompileReturnCode::kInvalidFormat, "Corrupt string section"};
+    }
+    if (!reader.readSymbols(database.getContextManager()->getStringTable()) ||
+        !reader.readTokens(*database.getContextManager()->getFunctionTable()) ||
+        !reader.readCriterions() || !reader.readCriteria() || !reader.readResponses() || !reader.readEntries()) {
+        return {CompileReturnCode::kInvalidFormat, "Corrupt compiled database"};
+    }
+    result = reader.readTables(stats, database);
+    if (result.code != CompileReturnCode::kSuccess) {
+        return result;
+    }
+    if (cursor.failed()) {
+        return {CompileReturnCode::kInvalidFormat, "Corrupt table section"};
+    }
+    return g_RESULT_SUCCESS;
+}
+
+}  // namespace Contextual::DatabaseCompiler
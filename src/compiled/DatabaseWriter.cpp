@@ -0,0 +1,529 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "CompiledFormat.h"
+#include "CriterionAlternate.h"
+#include "CriterionDynamic.h"
+#include "CriterionFail.h"
+#include "CriterionIncludes.h"
+#include "CriterionStatic.h"
+#include "DatabaseCompiler.h"
+#include "ResponseContextAdd.h"
+#include "ResponseContextInvert.h"
+#include "ResponseContextMultiply.h"
+#include "ResponseContextSetDynamic.h"
+#include "ResponseContextSetList.h"
+#include "ResponseContextSetStatic.h"
+#include "ResponseEvent.h"
+#include "ResponseMultiple.h"
+#include "ResponseSimple.h"
+#include "ResponseSpeech.h"
+#include "TextToken.h"
+#include "TokenBoolean.h"
+#include "TokenContext.h"
+#include "TokenFloat.h"
+#include "TokenFunction.h"
+#include "TokenInt.h"
+#include "TokenList.h"
+#include "TokenString.h"
+
+namespace Contextual::DatabaseCompiler {
+
+namespace {
+
+using CompiledFormat::CriterionTag;
+using CompiledFormat::ResponseTag;
+using CompiledFormat::TokenTag;
+
+// Append-only buffer of 32-bit words
+class Section {
+public:
+    void put(uint32_t value) {
+        m_words.push_back(value);
+    }
+
+    void putInt(int value) {
+        put(static_cast<uint32_t>(value));
+    }
+
+    void putFloat(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put(bits);
+    }
+
+    template <typename T>
+    void putTag(T tag) {
+        put(static_cast<uint32_t>(tag));
+    }
+
+    void write(std::ofstream& out, uint32_t count) const {
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(m_words.data()),
+                  static_cast<std::streamsize>(m_words.size() * sizeof(uint32_t)));
+    }
+
+    [[nodiscard]] size_t getByteSize() const {
+        return sizeof(uint32_t) + m_words.size() * sizeof(uint32_t);
+    }
+
+private:
+    std::vector<uint32_t> m_words;
+};
+
+class Writer {
+public:
+    CompileResult writeDatabase(CompileStats& stats, RuleDatabase& database) {
+        const StringTable& stringTable = database.getContextManager()->getStringTable();
+        for (size_t i = 0; i < stringTable.getSize(); ++i) {
+            const int symbol = StringTable::g_FIRST_SYMBOL + static_cast<int>(i);
+            m_symbols.put(addString(stringTable.lookup(symbol).value_or("")));
+        }
+        m_numSymbols = static_cast<uint32_t>(stringTable.getSize());
+
+        // Write one consistent version even if the database is reloaded meanwhile
+        std::shared_ptr<const DatabaseSnapshot> snapshot = database.getSnapshot();
+        for (const auto& [group, category] : snapshot->getTableNames()) {
+            const auto& ruleTable = snapshot->getRuleTable(group, category);
+            const auto entries = ruleTable->getEntries();
+            std::vector<uint32_t> entryIndices;
+            entryIndices.reserve(entries.size());
+            for (const auto& entry : entries) {
+                entryIndices.push_back(addEntry(entry));
+                if (!m_error.empty()) {
+                    return {CompileReturnCode::kUnsupportedType, m_error};
+                }
+            }
+            m_tables.put(addString(group));
+            m_tables.put(addString(category));
+            m_tables.put(static_cast<uint32_t>(entryIndices.size()));
+            for (uint32_t index : entryIndices) {
+                m_tables.put(index);
+            }
+            ++m_numTables;
+            stats.numRules += static_cast<uint32_t>(entries.size());
+        }
+        stats.numTables = m_numTables;
+        return {CompileReturnCode::kSuccess, ""};
+    }
+
+    bool writeFile(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        // String offsets are relative to the start of the blob
+        std::vector<uint32_t> stringHeader;
+        stringHeader.reserve(m_strings.size() * 2);
+        std::string blob;
+        for (const auto& str : m_strings) {
+            stringHeader.push_back(static_cast<uint32_t>(blob.size()));
+            stringHeader.push_back(static_cast<uint32_t>(str.size()));
+            blob += str;
+        }
+        blob.resize((blob.size() + 3) & ~static_cast<size_t>(3), '\0');
+
+        const size_t stringsSize = 2 * sizeof(uint32_t) + stringHeader.size() * sizeof(uint32_t) + blob.size();
+        const size_t fileSize = sizeof(CompiledFormat::g_MAGIC) + 3 * sizeof(uint32_t) + stringsSize +
+                                m_symbols.getByteSize() + m_tokens.getByteSize() + m_criterions.getByteSize() +
+                                m_criteria.getByteSize() + m_responses.getByteSize() + m_entries.getByteSize() +
+                                m_tables.getByteSize();
+
+        const uint32_t header[] = {CompiledFormat::g_VERSION, CompiledFormat::g_BYTE_ORDER_MARK,
+                                   static_cast<uint32_t>(fileSize)};
+        out.write(CompiledFormat::g_MAGIC, sizeof(CompiledFormat::g_MAGIC));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        const auto numStrings = static_cast<uint32_t>(m_strings.size());
+        const auto blobSize = static_cast<uint32_t>(blob.size());
+        out.write(reinterpret_cast<const char*>(&numStrings), sizeof(numStrings));
+        out.write(reinterpret_cast<const char*>(stringHeader.data()),
+                  static_cast<std::streamsize>(stringHeader.size() * sizeof(uint32_t)));
+        out.write(reinterpret_cast<const char*>(&blobSize), sizeof(blobSize));
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+
+        m_symbols.write(out, m_numSymbols);
+        m_tokens.write(out, static_cast<uint32_t>(m_tokenIndices.size()));
+        m_criterions.write(out, static_cast<uint32_t>(m_criterionIndices.size()));
+        m_criteria.write(out, static_cast<uint32_t>(m_criteriaIndices.size()));
+        m_responses.write(out, static_cast<uint32_t>(m_responseIndices.size()));
+        m_entries.write(out, static_cast<uint32_t>(m_entryIndices.size()));
+        m_tables.write(out, m_numTables);
+        return static_cast<bool>(out);
+    }
+
+private:
+    std::vector<std::string> m_strings;
+    std::unordered_map<std::string, uint32_t> m_stringIndices;
+    std::unordered_map<const void*, uint32_t> m_tokenIndices;
+    std::unordered_map<const void*, uint32_t> m_criterionIndices;
+    std::unordered_map<const void*, uint32_t> m_criteriaIndices;
+    std::unordered_map<const void*, uint32_t> m_responseIndices;
+    std::unordered_map<const void*, uint32_t> m_entryIndices;
+    Section m_symbols;
+    Section m_tokens;
+    Section m_criterions;
+    Section m_criteria;
+    Section m_responses;
+    Section m_entries;
+    Section m_tables;
+    uint32_t m_numSymbols = 0;
+    uint32_t m_numTables = 0;
+    std::string m_error;
+
+    uint32_t addString(std::string_view str) {
+        auto got = m_stringIndices.find(std::string(str));
+        if (got != m_stringIndices.end()) {
+            return got->second;
+        }
+        auto index = static_cast<uint32_t>(m_strings.size());
+        m_strings.emplace_back(str);
+        m_stringIndices.emplace(m_strings.back(), index);
+        return index;
+    }
+
+    // Children are always added before their parents, so the loader only ever looks backwards
+    uint32_t addToken(const std::shared_ptr<SpeechToken>& token) {
+        auto got = m_tokenIndices.find(token.get());
+        if (got != m_tokenIndices.end()) {
+            return got->second;
+        }
+
+        if (token->isSymbolToken()) {
+            const auto* symbolToken = static_cast<const SymbolToken*>(token.get());
+            switch (symbolToken->getType()) {
+                case TokenType::kBool:
+                    m_tokens.putTag(TokenTag::kBoolean);
+                    m_tokens.put(static_cast<const TokenBoolean*>(symbolToken)->getValue());
+                    break;
+                case TokenType::kInt:
+                    m_tokens.putTag(TokenTag::kInt);
+                    m_tokens.putInt(static_cast<const TokenInt*>(symbolToken)->getValue());
+                    break;
+                case TokenType::kFloat:
+                    m_tokens.putTag(TokenTag::kFloat);
+                    m_tokens.putFloat(static_cast<const TokenFloat*>(symbolToken)->getValue());
+                    break;
+                case TokenType::kString:
+                    m_tokens.putTag(TokenTag::kString);
+                    m_tokens.put(addString(static_cast<const TokenString*>(symbolToken)->getValue()));
+                    break;
+                case TokenType::kContext: {
+                    const auto* contextToken = static_cast<const TokenContext*>(symbolToken);
+                    m_tokens.putTag(TokenTag::kContext);
+                    m_tokens.put(addString(contextToken->getTable()));
+                    m_tokens.put(addString(contextToken->getKey()));
+                    break;
+                }
+                case TokenType::kFunction: {
+                    const auto* functionToken = static_cast<const TokenFunction*>(symbolToken);
+                    std::vector<uint32_t> args = addTokens(functionToken->getArgs());
+                    m_tokens.putTag(TokenTag::kFunction);
+                    m_tokens.put(addString(functionToken->getName()));
+                    putIndices(m_tokens, args);
+                    break;
+                }
+                case TokenType::kList: {
+                    std::vector<uint32_t> items = addTokens(static_cast<const TokenList*>(symbolToken)->getValue());
+                    m_tokens.putTag(TokenTag::kList);
+                    putIndices(m_tokens, items);
+                    break;
+                }
+                default:
+                    m_error = "Unsupported symbol token " + token->toString();
+                    return 0;
+            }
+        } else if (const auto* literal = dynamic_cast<const TextLiteral*>(token.get())) {
+            m_tokens.putTag(TokenTag::kLiteral);
+            m_tokens.put(addString(literal->value));
+        } else if (const auto* formatBool = dynamic_cast<const TextFormatBool*>(token.get())) {
+            m_tokens.putTag(TokenTag::kFormatBool);
+            m_tokens.put(addString(formatBool->attribute));
+            m_tokens.put(formatBool->value);
+        } else if (const auto* formatFloat = dynamic_cast<const TextFormatFloat*>(token.get())) {
+            m_tokens.putTag(TokenTag::kFormatFloat);
+            m_tokens.put(addString(formatFloat->attribute));
+            m_tokens.putFloat(formatFloat->value);
+        } else if (const auto* formatInt = dynamic_cast<const TextFormatInt*>(token.get())) {
+            m_tokens.putTag(TokenTag::kFormatInt);
+            m_tokens.put(addString(formatInt->attribute));
+            m_tokens.putInt(formatInt->value);
+        } else if (const auto* formatString = dynamic_cast<const TextFormatString*>(token.get())) {
+            m_tokens.putTag(TokenTag::kFormatString);
+            m_tokens.put(addString(formatString->attribute));
+            m_tokens.put(addString(formatString->value));
+        } else if (const auto* format = dynamic_cast<const TextFormat*>(token.get())) {
+            m_tokens.putTag(TokenTag::kFormat);
+            m_tokens.put(addString(format->attribute));
+        } else {
+            m_error = "Unsupported speech token " + token->toString();
+            return 0;
+        }
+
+        auto index = static_cast<uint32_t>(m_tokenIndices.size());
+        m_tokenIndices.emplace(token.get(), index);
+        return index;
+    }
+
+    template <typename T>
+    std::vector<uint32_t> addTokens(const std::vector<std::shared_ptr<T>>& tokens) {
+        std::vector<uint32_t> indices;
+        indices.reserve(tokens.size());
+        for (const auto& token : tokens) {
+            indices.push_back(addToken(token));
+        }
+        return indices;
+    }
+
+    static void putIndices(Section& section, const std::vector<uint32_t>& indices) {
+        section.put(static_cast<uint32_t>(indices.size()));
+        for (uint32_t index : indices) {
+            section.put(index);
+        }
+    }
+
+    template <typename Iterable>
+    static void putInts(Section& section, size_t size, const Iterable& values) {
+        section.put(static_cast<uint32_t>(size));
+        for (int value : values) {
+            section.putInt(value);
+        }
+    }
+
+    // Each option is followed by whether it is a string symbol, so the reader can remap exactly those
+    static void putOptions(Section& section, const std::vector<int>& options, const std::unordered_set<int>& symbols) {
+        section.put(static_cast<uint32_t>(options.size()));
+        for (int option : options) {
+            section.putInt(option);
+            section.put(symbols.find(option) != symbols.end());
+        }
+    }
+
+    uint32_t addCriterion(const std::shared_ptr<Criterion>& criterion) {
+        auto got = m_criterionIndices.find(criterion.get());
+        if (got != m_criterionIndices.end()) {
+            return got->second;
+        }
+
+        switch (criterion->getType()) {
+            case CriterionType::kStatic: {
+                const auto* typed = static_cast<const CriterionStatic*>(criterion.get());
+                m_criterions.putTag(CriterionTag::kStatic);
+                m_criterions.putFloat(typed->getMin());
+                m_criterions.putFloat(typed->getMax());
+                m_criterions.put(typed->isInverted());
+                m_criterions.put(typed->isSymbol());
+                break;
+            }
+            case CriterionType::kAlternate: {
+                const auto* typed = static_cast<const CriterionAlternate*>(criterion.get());
+                // Sorted so the same database always compiles to the same bytes
+                std::vector<int> options(typed->getOptions().begin(), typed->getOptions().end());
+                std::sort(options.begin(), options.end());
+                m_criterions.putTag(CriterionTag::kAlternate);
+                m_criterions.put(typed->isInverted());
+                putOptions(m_criterions, options, typed->getSymbols());
+                break;
+            }
+            case CriterionType::kDynamic: {
+                const auto* typed = static_cast<const CriterionDynamic*>(criterion.get());
+                m_criterions.putTag(CriterionTag::kDynamic);
+                m_criterions.putFloat(typed->getMinDelta());
+                m_criterions.putFloat(typed->getMaxDelta());
+                m_criterions.put(addString(typed->getOtherTable()));
+                m_criterions.put(addString(typed->getOtherKey()));
+                m_criterions.put(typed->isInverted());
+                break;
+            }
+            case CriterionType::kExist:
+                m_criterions.putTag(CriterionTag::kExist);
+                m_criterions.put(static_cast<const CriterionInvertible*>(criterion.get())->isInverted());
+                break;
+            case CriterionType::kIncludes: {
+                const auto* typed = static_cast<const CriterionIncludes*>(criterion.get());
+                m_criterions.putTag(CriterionTag::kIncludes);
+                m_criterions.put(typed->isInverted());
+                putOptions(m_criterions, typed->getOptions(), typed->getSymbols());
+                break;
+            }
+            case CriterionType::kEmpty:
+                m_criterions.putTag(CriterionTag::kEmpty);
+                m_criterions.put(static_cast<const CriterionInvertible*>(criterion.get())->isInverted());
+                break;
+            case CriterionType::kFail:
+                m_criterions.putTag(CriterionTag::kFail);
+                m_criterions.putFloat(static_cast<const CriterionFail*>(criterion.get())->getChanceToFail());
+                break;
+        }
+
+        auto index = static_cast<uint32_t>(m_criterionIndices.size());
+        m_criterionIndices.emplace(criterion.get(), index);
+        return index;
+    }
+
+    uint32_t addCriteria(const std::shared_ptr<Criteria>& criteria) {
+        auto got = m_criteriaIndices.find(criteria.get());
+        if (got != m_criteriaIndices.end()) {
+            return got->second;
+        }
+        uint32_t criterion = addCriterion(criteria->criterion);
+        m_criteria.put(addString(criteria->table));
+        m_criteria.put(addString(criteria->key));
+        m_criteria.put(criterion);
+
+        auto index = static_cast<uint32_t>(m_criteriaIndices.size());
+        m_criteriaIndices.emplace(criteria.get(), index);
+        return index;
+    }
+
+    void putContextTarget(ResponseTag tag, const ResponseContext& response) {
+        m_responses.putTag(tag);
+        m_responses.put(addString(response.getTable()));
+        m_responses.put(addString(response.getKey()));
+    }
+
+    bool addContextResponse(const Response* response) {
+        if (const auto* setStatic = dynamic_cast<const ResponseContextSetStatic*>(response)) {
+            putContextTarget(ResponseTag::kContextSetStatic, *setStatic);
+            m_responses.putTag(setStatic->getFactType());
+            m_responses.putFloat(setStatic->getValue());
+        } else if (const auto* setDynamic = dynamic_cast<const ResponseContextSetDynamic*>(response)) {
+            putContextTarget(ResponseTag::kContextSetDynamic, *setDynamic);
+            m_responses.put(addString(setDynamic->getOtherTable()));
+            m_responses.put(addString(setDynamic->getOtherKey()));
+        } else if (const auto* setList = dynamic_cast<const ResponseContextSetList*>(response)) {
+            putContextTarget(ResponseTag::kContextSetList, *setList);
+            m_responses.put(setList->isStringList());
+            putInts(m_responses, setList->getValue().size(), setList->getValue());
+        } else if (const auto* add = dynamic_cast<const ResponseContextAdd*>(response)) {
+            putContextTarget(ResponseTag::kContextAdd, *add);
+            m_responses.putFloat(add->getValue());
+        } else if (const auto* multiply = dynamic_cast<const ResponseContextMultiply*>(response)) {
+            putContextTarget(ResponseTag::kContextMultiply, *multiply);
+            m_responses.putFloat(multiply->getValue());
+        } else if (const auto* invert = dynamic_cast<const ResponseContextInvert*>(response)) {
+            putContextTarget(ResponseTag::kContextInvert, *invert);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t addResponse(const std::shared_ptr<Response>& response) {
+        if (response == nullptr) {
+            return CompiledFormat::g_NULL_INDEX;
+        }
+        auto got = m_responseIndices.find(response.get());
+        if (got != m_responseIndices.end()) {
+            return got->second;
+        }
+
+        switch (response->getType()) {
+            case ResponseType::kSimple: {
+                const auto& options = static_cast<const ResponseSimple*>(response.get())->getOptions();
+                m_responses.putTag(ResponseTag::kSimple);
+                m_responses.put(static_cast<uint32_t>(options.size()));
+                for (const auto& option : options) {
+                    m_responses.put(addString(option));
+                }
+                break;
+            }
+            case ResponseType::kMultiple: {
+                std::vector<uint32_t> children;
+                for (const auto& child : static_cast<const ResponseMultiple*>(response.get())->getResponses()) {
+                    children.push_back(addResponse(child));
+                }
+                m_responses.putTag(ResponseTag::kMultiple);
+                putIndices(m_responses, children);
+                break;
+            }
+            case ResponseType::kSpeech: {
+                const auto& lines = static_cast<const ResponseSpeech*>(response.get())->getSpeechLines();
+                std::vector<std::vector<uint32_t>> lineIndices;
+                lineIndices.reserve(lines.size());
+                for (const auto& line : lines) {
+                    lineIndices.push_back(addTokens(line));
+                }
+                m_responses.putTag(ResponseTag::kSpeech);
+                m_responses.put(static_cast<uint32_t>(lineIndices.size()));
+                for (const auto& indices : lineIndices) {
+                    putIndices(m_responses, indices);
+                }
+                break;
+            }
+            case ResponseType::kEvent: {
+                const auto* event = static_cast<const ResponseEvent*>(response.get());
+                m_responses.putTag(ResponseTag::kEvent);
+                m_responses.put(addString(event->getName()));
+                m_responses.put(static_cast<uint32_t>(event->getArgs().size()));
+                for (const auto& arg : event->getArgs()) {
+                    m_responses.put(addString(arg));
+                }
+                break;
+            }
+            case ResponseType::kContext:
+                if (!addContextResponse(response.get())) {
+                    m_error = "Unsupported context response";
+                    return 0;
+                }
+                break;
+        }
+
+        auto index = static_cast<uint32_t>(m_responseIndices.size());
+        m_responseIndices.emplace(response.get(), index);
+        return index;
+    }
+
+    uint32_t addEntry(const std::shared_ptr<RuleEntry>& entry) {
+        auto got = m_entryIndices.find(entry.get());
+        if (got != m_entryIndices.end()) {
+            return got->second;
+        }
+        std::vector<uint32_t> criteria;
+        criteria.reserve(entry->criteria.size());
+        for (const auto& item : entry->criteria) {
+            criteria.push_back(addCriteria(item));
+        }
+        uint32_t response = addResponse(entry->response);
+
+        m_entries.put(addString(entry->id));
+        m_entries.putInt(entry->priority);
+        m_entries.put(response);
+        putIndices(m_entries, criteria);
+
+        auto index = static_cast<uint32_t>(m_entryIndices.size());
+        m_entryIndices.emplace(entry.get(), index);
+        return index;
+    }
+};
+
+}  // namespace
+
+CompileResult writeDatabase(CompileStats& stats, RuleDatabase& database, const std::string& path) {
+    stats = {0, 0};
+    Writer writer;
+    auto result = writer.writeDatabase(stats, database);
+    if (result.code != CompileReturnCode::kSuccess) {
+        return result;
+    }
+
+    // Write next to the destination and swap it in, so readers never map a half-written file
+    const std::string tempPath = path + ".tmp";
+    if (!writer.writeFile(tempPath)) {
+        return {CompileReturnCode::kInvalidPath, "Failed to write compiled database to \"" + tempPath + "\""};
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        return {CompileReturnCode::kInvalidPath,
+                "Failed to move compiled database to \"" + path + "\": " + error.message()};
+    }
+    return {CompileReturnCode::kSuccess, ""};
+}
+
+}  // namespace Contextual::DatabaseCompiler
@@ -0,0 +1,158 @@
+#include "CompiledCriteria.h"
+
+#include <algorithm>
+
+#include "ContextIds.h"
+#include "CriterionAlternate.h"
+#include "CriterionDynamic.h"
+#include "CriterionFail.h"
+#include "CriterionIncludes.h"
+#include "CriterionStatic.h"
+
+namespace Contextual {
+
+namespace {
+
+// Below this many options a linear scan beats a binary search
+const uint32_t g_LINEAR_SEARCH_LIMIT = 8;
+
+}  // namespace
+
+CompiledCriterion CompiledCriteria::compile(const int tableId, const int keyId, const Criterion& criterion) {
+    CompiledCriterion compiled{};
+    compiled.type = criterion.getType();
+    compiled.tableId = tableId;
+    compiled.keyId = keyId;
+    switch (compiled.type) {
+        case CriterionType::kStatic: {
+            const auto& staticCriterion = static_cast<const CriterionStatic&>(criterion);
+            compiled.invert = staticCriterion.isInverted();
+            compiled.range = {staticCriterion.getMin(), staticCriterion.getMax()};
+            break;
+        }
+        case CriterionType::kAlternate: {
+            const auto& alternate = static_cast<const CriterionAlternate&>(criterion);
+            compiled.invert = alternate.isInverted();
+            std::vector<int> options(alternate.getOptions().begin(), alternate.getOptions().end());
+            std::sort(options.begin(), options.end());
+            compiled.options = {static_cast<uint32_t>(m_options.size()), static_cast<uint32_t>(options.size())};
+            m_options.insert(m_options.end(), options.begin(), options.end());
+            break;
+        }
+        case CriterionType::kIncludes: {
+            const auto& includes = static_cast<const CriterionIncludes&>(criterion);
+            compiled.invert = includes.isInverted();
+            compiled.options = {static_cast<uint32_t>(m_options.size()),
+                                static_cast<uint32_t>(includes.getOptions().size())};
+            m_options.insert(m_options.end(), includes.getOptions().begin(), includes.getOptions().end());
+            break;
+        }
+        case CriterionType::kDynamic: {
+            const auto& dynamic = static_cast<const CriterionDynamic&>(criterion);
+            compiled.invert = dynamic.isInverted();
+            compiled.dynamic = {dynamic.getMinDelta(), dynamic.getMaxDelta(),
+                                ContextIds::getTableId(dynamic.getOtherTable()),
+                                ContextIds::getKeyId(dynamic.getOtherKey())};
+            break;
+        }
+        case CriterionType::kExist:
+        case CriterionType::kEmpty:
+            compiled.invert = static_cast<const CriterionInvertible&>(criterion).isInverted();
+            break;
+        case CriterionType::kFail:
+            compiled.chanceToFail = static_cast<const CriterionFail&>(criterion).getChanceToFail();
+            break;
+    }
+    return compiled;
+}
+
+void CompiledCriteria::clear() {
+    m_options.clear();
+}
+
+bool CompiledCriteria::evaluate(const CompiledCriterion& criterion, const DatabaseQuery& query) const {
+    if (criterion.type == CriterionType::kFail) {
+        DatabaseQuery::WillFail failType = query.willFail();
+        if (failType == DatabaseQuery::WillFail::kNormal) {
+            return query.getRandom().randFloat(0.0f, 1.0f) >= criterion.chanceToFail;
+        }
+        return failType == DatabaseQuery::WillFail::kNever;
+    }
+
+    const ContextTable* contextTable = query.findContextTable(criterion.tableId);
+    switch (criterion.type) {
+        case CriterionType::kStatic:
+        case CriterionType::kAlternate:
+            if (contextTable != nullptr) {
+                if (std::optional<float> value = contextTable->getRawValue(criterion.keyId)) {
+                    return compareValue(criterion, *value);
+                }
+            }
+            return false;
+        case CriterionType::kIncludes:
+        case CriterionType::kEmpty:
+            if (contextTable != nullptr) {
+                if (const FactList* list = contextTable->getList(criterion.keyId)) {
+                    return compareList(criterion, *list);
+                }
+            }
+            return false;
+        case CriterionType::kExist:
+            return compareExists(criterion, contextTable != nullptr && contextTable->hasKey(criterion.keyId));
+        case CriterionType::kDynamic:
+            if (contextTable != nullptr) {
+                const ContextTable* otherTable = query.findContextTable(criterion.dynamic.otherTableId);
+                if (otherTable != nullptr) {
+                    std::optional<float> value = contextTable->getRawValue(criterion.keyId);
+                    std::optional<float> otherValue = otherTable->getRawValue(criterion.dynamic.otherKeyId);
+                    if (value && otherValue) {
+                        return compareValue(criterion, *value - *otherValue);
+                    }
+                }
+            }
+            return false;
+        case CriterionType::kFail:
+            break;
+    }
+    return false;
+}
+
+bool CompiledCriteria::compareValue(const CompiledCriterion& criterion, const float value) const {
+    switch (criterion.type) {
+        case CriterionType::kStatic:
+            return criterion.invert != (criterion.range.min <= value && value <= criterion.range.max);
+        case CriterionType::kAlternate:
+            return criterion.invert != containsOption(criterion.options, static_cast<int>(value));
+        case CriterionType::kDynamic:
+            return criterion.invert != (criterion.dynamic.minDelta <= value && value <= criterion.dynamic.maxDelta);
+        default:
+            return false;
+    }
+}
+
+bool CompiledCriteria::compareList(const CompiledCriterion& criterion, const FactList& list) const {
+    if (criterion.type == CriterionType::kEmpty) {
+        return criterion.invert != list.empty();
+    }
+    bool included = false;
+    const int* options = m_options.data() + criterion.options.begin;
+    for (uint32_t i = 0; i < criterion.options.count && !included; ++i) {
+        included = list.contains(options[i]);
+    }
+    return criterion.invert != included;
+}
+
+bool CompiledCriteria::compareExists(const CompiledCriterion& criterion, const bool exists) {
+    return criterion.invert != exists;
+}
+
+bool CompiledCriteria::containsOption(const CompiledCriterion::Options& options, const int value) const {
+    const int* begin = m_options.data() + options.begin;
+    const int* end = begin + options.count;
+    if (options.count <= g_LINEAR_SEARCH_LIMIT) {
+        return std::find(begin, end, value) != end;
+    }
+    return std::binary_search(begin, end, value);
+}
+
+}  // namespace Contextual
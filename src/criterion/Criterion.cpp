@@ -2,7 +2,7 @@
 
 namespace Contextual {
 
-int Criterion::count = 0;
+std::atomic<int> Criterion::count = 0;
 
 int Criterion::getCount() {
     return Criterion::count;
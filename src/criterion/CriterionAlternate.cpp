@@ -4,13 +4,13 @@
 
 namespace Contextual {
 
-CriterionAlternate::CriterionAlternate(std::unordered_set<int> options, bool invert)
-    : CriterionFloatComparable(invert), m_options(std::move(options)) {}
+CriterionAlternate::CriterionAlternate(std::unordered_set<int> options, bool invert, std::unordered_set<int> symbols)
+    : CriterionFloatComparable(invert), m_options(std::move(options)), m_symbols(std::move(symbols)) {}
 
-bool CriterionAlternate::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(table);
+bool CriterionAlternate::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
+    const ContextTable* contextTable = query.findContextTable(tableId);
     if (contextTable != nullptr) {
-        std::optional<float> value = contextTable->getRawValue(key);
+        std::optional<float> value = contextTable->getRawValue(keyId);
         if (value) {
             return compare(*value);
         }
@@ -26,4 +26,16 @@ int CriterionAlternate::getPriority() const {
     return 2;
 }
 
+CriterionType CriterionAlternate::getType() const {
+    return CriterionType::kAlternate;
+}
+
+const std::unordered_set<int>& CriterionAlternate::getOptions() const {
+    return m_options;
+}
+
+const std::unordered_set<int>& CriterionAlternate::getSymbols() const {
+    return m_symbols;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <utility>
 
+#include "ContextIds.h"
+
 namespace Contextual {
 
 CriterionDynamic::CriterionDynamic(const float min, const float max, std::string otherTable, std::string otherKey,
@@ -10,13 +12,15 @@ CriterionDynamic::CriterionDynamic(const float min, const float max, std::string
       m_minDelta(min),
       m_maxDelta(max),
       m_otherTable(std::move(otherTable)),
-      m_otherKey(std::move(otherKey)) {}
+      m_otherKey(std::move(otherKey)),
+      m_otherTableId(ContextIds::getTableId(m_otherTable)),
+      m_otherKeyId(ContextIds::getKeyId(m_otherKey)) {}
 
-bool CriterionDynamic::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
-    if (std::shared_ptr<ContextTable> contextTable1 = query.getContextTable(table)) {
-        if (std::shared_ptr<ContextTable> contextTable2 = query.getContextTable(m_otherTable)) {
-            if (std::optional<float> value1 = contextTable1->getRawValue(key)) {
-                if (std::optional<float> value2 = contextTable2->getRawValue(m_otherKey)) {
+bool CriterionDynamic::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
+    if (const ContextTable* contextTable1 = query.findContextTable(tableId)) {
+        if (const ContextTable* contextTable2 = query.findContextTable(m_otherTableId)) {
+            if (std::optional<float> value1 = contextTable1->getRawValue(keyId)) {
+                if (std::optional<float> value2 = contextTable2->getRawValue(m_otherKeyId)) {
                     const float delta = *value1 - *value2;
                     return compare(delta);
                 }
@@ -34,4 +38,24 @@ int CriterionDynamic::getPriority() const {
     return 3;
 }
 
+CriterionType CriterionDynamic::getType() const {
+    return CriterionType::kDynamic;
+}
+
+float CriterionDynamic::getMinDelta() const {
+    return m_minDelta;
+}
+
+float CriterionDynamic::getMaxDelta() const {
+    return m_maxDelta;
+}
+
+const std::string& CriterionDynamic::getOtherTable() const {
+    return m_otherTable;
+}
+
+const std::string& CriterionDynamic::getOtherKey() const {
+    return m_otherKey;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -4,10 +4,10 @@ namespace Contextual {
 
 CriterionEmpty::CriterionEmpty(bool invert) : CriterionListComparable(invert) {}
 
-bool CriterionEmpty::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(table);
+bool CriterionEmpty::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
+    const ContextTable* contextTable = query.findContextTable(tableId);
     if (contextTable != nullptr) {
-        const std::unique_ptr<std::unordered_set<int>>& value = contextTable->getList(key);
+        const FactList* value = contextTable->getList(keyId);
         if (value != nullptr) {
             return compare(*value);
         }
@@ -15,7 +15,7 @@ bool CriterionEmpty::evaluate(const std::string& table, const std::string& key,
     return false;
 }
 
-bool CriterionEmpty::compare(const std::unordered_set<int>& value) const {
+bool CriterionEmpty::compare(const FactList& value) const {
     return m_invert != value.empty();
 }
 
@@ -23,4 +23,8 @@ int CriterionEmpty::getPriority() const {
     return 4;
 }
 
+CriterionType CriterionEmpty::getType() const {
+    return CriterionType::kEmpty;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -4,16 +4,24 @@ namespace Contextual {
 
 CriterionExist::CriterionExist(const bool invert) : CriterionInvertible(invert) {}
 
-bool CriterionExist::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(table);
+bool CriterionExist::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
+    const ContextTable* contextTable = query.findContextTable(tableId);
     if (contextTable != nullptr) {
-        return m_invert != contextTable->hasKey(key);
+        return compare(contextTable->hasKey(keyId));
     }
-    return m_invert;
+    return compare(false);
+}
+
+bool CriterionExist::compare(const bool hasKey) const {
+    return m_invert != hasKey;
 }
 
 int CriterionExist::getPriority() const {
     return 4;
 }
 
+CriterionType CriterionExist::getType() const {
+    return CriterionType::kExist;
+}
+
 }  // namespace Contextual
\ No newline at end of file
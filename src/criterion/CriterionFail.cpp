@@ -1,7 +1,5 @@
 #include "CriterionFail.h"
 
-#include "MathUtils.h"
-
 namespace Contextual {
 
 CriterionFail::CriterionFail(const float chanceToFail) : m_chanceToFail(chanceToFail) {}
@@ -10,10 +8,14 @@ int CriterionFail::getPriority() const {
     return 5;
 }
 
-bool CriterionFail::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
+CriterionType CriterionFail::getType() const {
+    return CriterionType::kFail;
+}
+
+bool CriterionFail::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
     DatabaseQuery::WillFail failType = query.willFail();
     if (failType == DatabaseQuery::WillFail::kNormal) {
-        return MathUtils::randFloat(0.0f, 1.0f) >= m_chanceToFail;
+        return query.getRandom().randFloat(0.0f, 1.0f) >= m_chanceToFail;
     }
     if (failType == DatabaseQuery::WillFail::kNever) {
         return true;
@@ -22,4 +24,8 @@ bool CriterionFail::evaluate(const std::string& table, const std::string& key, c
     return false;
 }
 
+float CriterionFail::getChanceToFail() const {
+    return m_chanceToFail;
+}
+
 }  // namespace Contextual
\ No newline at end of file
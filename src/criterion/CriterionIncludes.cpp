@@ -4,13 +4,13 @@
 
 namespace Contextual {
 
-CriterionIncludes::CriterionIncludes(std::vector<int> options, bool invert)
-    : CriterionListComparable(invert), m_options(std::move(options)) {}
+CriterionIncludes::CriterionIncludes(std::vector<int> options, bool invert, std::unordered_set<int> symbols)
+    : CriterionListComparable(invert), m_options(std::move(options)), m_symbols(std::move(symbols)) {}
 
-bool CriterionIncludes::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(table);
+bool CriterionIncludes::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
+    const ContextTable* contextTable = query.findContextTable(tableId);
     if (contextTable != nullptr) {
-        const std::unique_ptr<std::unordered_set<int>>& value = contextTable->getList(key);
+        const FactList* value = contextTable->getList(keyId);
         if (value != nullptr) {
             return compare(*value);
         }
@@ -18,10 +18,10 @@ bool CriterionIncludes::evaluate(const std::string& table, const std::string& ke
     return false;
 }
 
-bool CriterionIncludes::compare(const std::unordered_set<int>& value) const {
+bool CriterionIncludes::compare(const FactList& value) const {
     bool included = false;
     for (const int option : m_options) {
-        if (value.find(option) != value.end()) {
+        if (value.contains(option)) {
             included = true;
             break;
         }
@@ -33,4 +33,16 @@ int CriterionIncludes::getPriority() const {
     return 1;
 }
 
+CriterionType CriterionIncludes::getType() const {
+    return CriterionType::kIncludes;
+}
+
+const std::vector<int>& CriterionIncludes::getOptions() const {
+    return m_options;
+}
+
+const std::unordered_set<int>& CriterionIncludes::getSymbols() const {
+    return m_symbols;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "CriterionInterner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "ContextIds.h"
+#include "CriterionAlternate.h"
+#include "CriterionDynamic.h"
+#include "CriterionFail.h"
+#include "CriterionIncludes.h"
+#include "CriterionStatic.h"
+
+namespace Contextual {
+
+namespace {
+
+void addFloat(std::vector<uint32_t>& signature, const float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    signature.push_back(bits);
+}
+
+void addInts(std::vector<uint32_t>& signature, std::vector<int> values) {
+    // Both alternate and includes criteria match if any option does, so option order does not matter
+    std::sort(values.begin(), values.end());
+    signature.push_back(static_cast<uint32_t>(values.size()));
+    for (const int value : values) {
+        signature.push_back(static_cast<uint32_t>(value));
+    }
+}
+
+// Two criteria with the same signature always evaluate the same
+std::vector<uint32_t> getSignature(const Criterion& criterion) {
+    std::vector<uint32_t> signature;
+    const CriterionType type = criterion.getType();
+    signature.push_back(static_cast<uint32_t>(type));
+    if (type != CriterionType::kFail) {
+        signature.push_back(static_cast<const CriterionInvertible&>(criterion).isInverted());
+    }
+    switch (type) {
+        case CriterionType::kStatic: {
+            const auto& staticCriterion = static_cast<const CriterionStatic&>(criterion);
+            addFloat(signature, staticCriterion.getMin());
+            addFloat(signature, staticCriterion.getMax());
+            signature.push_back(staticCriterion.isSymbol());
+            break;
+        }
+        case CriterionType::kAlternate: {
+            const auto& alternate = static_cast<const CriterionAlternate&>(criterion);
+            addInts(signature, std::vector<int>(alternate.getOptions().begin(), alternate.getOptions().end()));
+            addInts(signature, std::vector<int>(alternate.getSymbols().begin(), alternate.getSymbols().end()));
+            break;
+        }
+        case CriterionType::kIncludes: {
+            const auto& includes = static_cast<const CriterionIncludes&>(criterion);
+            addInts(signature, includes.getOptions());
+            addInts(signature, std::vector<int>(includes.getSymbols().begin(), includes.getSymbols().end()));
+            break;
+        }
+        case CriterionType::kDynamic: {
+            const auto& dynamic = static_cast<const CriterionDynamic&>(criterion);
+            addFloat(signature, dynamic.getMinDelta());
+            addFloat(signature, dynamic.getMaxDelta());
+            signature.push_back(static_cast<uint32_t>(ContextIds::getTableId(dynamic.getOtherTable())));
+            signature.push_back(static_cast<uint32_t>(ContextIds::getKeyId(dynamic.getOtherKey())));
+            break;
+        }
+        case CriterionType::kFail:
+            addFloat(signature, static_cast<const CriterionFail&>(criterion).getChanceToFail());
+            break;
+        case CriterionType::kExist:
+        case CriterionType::kEmpty:
+            break;
+    }
+    return signature;
+}
+
+}  // namespace
+
+size_t CriterionInterner::SignatureHash::operator()(const std::vector<uint32_t>& signature) const {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (const uint32_t word : signature) {
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+std::shared_ptr<Criterion> CriterionInterner::intern(const std::shared_ptr<Criterion>& criterion) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return internLocked(criterion);
+}
+
+std::shared_ptr<Criteria> CriterionInterner::intern(const std::string& table, const std::string& key,
+                                                    const std::shared_ptr<Criterion>& criterion) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_ptr<Criterion> stored = internLocked(criterion);
+    const auto id = std::make_tuple(ContextIds::getTableId(table), ContextIds::getKeyId(key), stored.get());
+    auto got = m_criteria.find(id);
+    if (got != m_criteria.end()) {
+        return got->second;
+    }
+    auto criteria = std::make_shared<Criteria>(table, key, std::move(stored));
+    m_criteria.emplace(id, criteria);
+    return criteria;
+}
+
+void CriterionInterner::prune() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Criteria first, since they hold on to their criterion
+    for (auto iter = m_criteria.begin(); iter != m_criteria.end();) {
+        iter = iter->second.use_count() == 1 ? m_criteria.erase(iter) : std::next(iter);
+    }
+    for (auto iter = m_criterions.begin(); iter != m_criterions.end();) {
+        iter = iter->second.use_count() == 1 ? m_criterions.erase(iter) : std::next(iter);
+    }
+}
+
+size_t CriterionInterner::getNumCriterions() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_criterions.size();
+}
+
+size_t CriterionInterner::getNumCriteria() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_criteria.size();
+}
+
+std::shared_ptr<Criterion> CriterionInterner::internLocked(const std::shared_ptr<Criterion>& criterion) {
+    return m_criterions.try_emplace(getSignature(*criterion), criterion).first->second;
+}
+
+}  // namespace Contextual
@@ -4,4 +4,8 @@ namespace Contextual {
 
 CriterionInvertible::CriterionInvertible(const bool invert) : m_invert(invert) {}
 
+bool CriterionInvertible::isInverted() const {
+    return m_invert;
+}
+
 }  // namespace Contextual
\ No newline at end of file
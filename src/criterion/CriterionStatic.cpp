@@ -7,13 +7,13 @@
 
 namespace Contextual {
 
-CriterionStatic::CriterionStatic(const float min, const float max, const bool invert)
-    : CriterionFloatComparable(invert), m_min(min), m_max(max) {}
+CriterionStatic::CriterionStatic(const float min, const float max, const bool invert, const bool isSymbol)
+    : CriterionFloatComparable(invert), m_min(min), m_max(max), m_isSymbol(isSymbol) {}
 
-bool CriterionStatic::evaluate(const std::string& table, const std::string& key, const DatabaseQuery& query) const {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(table);
+bool CriterionStatic::evaluate(const int tableId, const int keyId, const DatabaseQuery& query) const {
+    const ContextTable* contextTable = query.findContextTable(tableId);
     if (contextTable != nullptr) {
-        std::optional<float> value = contextTable->getRawValue(key);
+        std::optional<float> value = contextTable->getRawValue(keyId);
         if (value) {
             return compare(*value);
         }
@@ -29,4 +29,20 @@ int CriterionStatic::getPriority() const {
     return 3;
 }
 
+CriterionType CriterionStatic::getType() const {
+    return CriterionType::kStatic;
+}
+
+float CriterionStatic::getMin() const {
+    return m_min;
+}
+
+float CriterionStatic::getMax() const {
+    return m_max;
+}
+
+bool CriterionStatic::isSymbol() const {
+    return m_isSymbol;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "DefaultFunctionTable.h"
 
 #include <algorithm>
+#include <cstdint>
 
-#include "MathUtils.h"
 #include "SpeechGenerator.h"
 
 namespace Contextual {
@@ -17,6 +17,12 @@ const std::string g_OBJECTIVE[] = {"them", "him", "her"};
 const std::string g_POSSESSIVE[] = {"theirs", "his", "hers"};
 const std::string g_REFLEXIVE[] = {"themself", "himself", "herself"};
 
+enum class FunctionId : uint8_t {
+    kCapitalize, kUncapitalize, kUpper, kLower, kSubjective, kObjective, kPossessive, kReflexive, kListConcat, kPrev,
+    kPrevMatch, kPluralize, kCount, kConcat, kAdd, kSub, kMult, kDiv, kDivInt, kMod, kRandInt, kNum, kOrd, kGender,
+    kIfElse, kAnd, kOr, kNot, kContext, kRawNum
+};
+
 int genderToInt(const std::string& gender) {
     if (gender == g_GENDER_NONE) {
         return 0;
@@ -36,7 +42,7 @@ FunctionVal capitalize(std::string str) {
         return FunctionVal();
     }
     str[0] = static_cast<char>(std::toupper(str[0]));
-    return FunctionVal(str);
+    return FunctionVal(std::move(str));
 }
 
 FunctionVal uncapitalize(std::string str) {
@@ -44,17 +50,17 @@ FunctionVal uncapitalize(std::string str) {
         return FunctionVal();
     }
     str[0] = static_cast<char>(std::tolower(str[0]));
-    return FunctionVal(str);
+    return FunctionVal(std::move(str));
 }
 
 FunctionVal upper(std::string str) {
     std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::toupper(c); });
-    return FunctionVal(str);
+    return FunctionVal(std::move(str));
 }
 
 FunctionVal lower(std::string str) {
     std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
-    return FunctionVal(str);
+    return FunctionVal(std::move(str));
 }
 
 FunctionVal subjective(const std::string& gender) {
@@ -89,24 +95,10 @@ FunctionVal reflexive(const std::string& gender) {
     return FunctionVal(g_REFLEXIVE[index]);
 }
 
-FunctionVal listConcat(const std::vector<std::vector<int>>& lists, bool isStringList) {
-    size_t size = 0;
-    for (const auto& list : lists) {
-        size += list.size();
-    }
-
-    std::vector<int> result;
-    result.reserve(size);
-    for (const auto& list : lists) {
-        result.insert(result.end(), list.begin(), list.end());
-    }
-    return FunctionVal(result, isStringList);
-}
-
 FunctionVal prev(int index, DatabaseQuery& query) {
     std::optional<std::string> prevChoice = query.getPrevChoice(index - 1);
     if (prevChoice) {
-        return FunctionVal(*prevChoice);
+        return FunctionVal(std::move(*prevChoice));
     }
     return FunctionVal();
 }
@@ -116,9 +108,9 @@ FunctionVal prevMatch(int index, const std::vector<int>& list, DatabaseQuery& qu
     if (prevChoiceIndex) {
         if (*prevChoiceIndex < list.size()) {
             // Guaranteed to be a string list
-            std::optional<std::string> str = query.getStringTable().lookup(list[*prevChoiceIndex]);
+            std::optional<std::string_view> str = query.getStringTable().lookup(list[*prevChoiceIndex]);
             if (str) {
-                return FunctionVal(*str);
+                return FunctionVal(std::string(*str));
             }
         }
     }
@@ -132,18 +124,6 @@ FunctionVal pluralize(int count, std::string singular, std::string plural) {
     return FunctionVal(std::move(plural));
 }
 
-FunctionVal count(const std::vector<int>& list) {
-    return FunctionVal(static_cast<int>(list.size()));
-}
-
-FunctionVal concat(const std::vector<std::string>& strings) {
-    std::string result;
-    for (const auto& str : strings) {
-        result += str;
-    }
-    return FunctionVal(result);
-}
-
 FunctionVal add(float a, float b) {
     return FunctionVal(a + b);
 }
@@ -177,8 +157,8 @@ FunctionVal mod(int a, int b) {
     return FunctionVal(a % b);
 }
 
-FunctionVal randInt(int min, int max) {
-    return FunctionVal(MathUtils::randInt(min, max));
+FunctionVal randInt(int min, int max, DatabaseQuery& query) {
+    return FunctionVal(query.getRandom().randInt(min, max));
 }
 
 FunctionVal num(int num) {
@@ -186,7 +166,7 @@ FunctionVal num(int num) {
     if (word.empty()) {
         return FunctionVal();
     }
-    return FunctionVal(word);
+    return FunctionVal(std::move(word));
 }
 
 FunctionVal ord(int num) {
@@ -194,7 +174,7 @@ FunctionVal ord(int num) {
     if (word.empty()) {
         return FunctionVal();
     }
-    return FunctionVal(word);
+    return FunctionVal(std::move(word));
 }
 
 FunctionVal gender(const std::string& gender, std::string neutralStr, std::string maleStr, std::string femaleStr) {
@@ -231,7 +211,7 @@ FunctionVal boolNot(const bool a) {
 }
 
 FunctionVal context(const std::string& table, const std::string& key, DatabaseQuery& query) {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(table);
+    const ContextTable* contextTable = query.findContextTable(table);
     if (contextTable == nullptr) {
         return FunctionVal();
     }
@@ -239,10 +219,10 @@ FunctionVal context(const std::string& table, const std::string& key, DatabaseQu
     if (type == FactType::kString) {
         std::optional<std::string> value = contextTable->getString(key);
         if (value) {
-            return FunctionVal(*value);
+            return FunctionVal(std::move(*value));
         }
     } else if (type == FactType::kList) {
-        const std::unique_ptr<std::unordered_set<int>>& value = contextTable->getList(key);
+        const FactList* value = contextTable->getList(key);
         if (value != nullptr) {
             bool isStringList = contextTable->isStringList(key);
             std::vector<int> intList;
@@ -271,291 +251,293 @@ FunctionVal rawNum(int num) {
 }  // namespace
 
 void DefaultFunctionTable::initialize() {
-    registerFunction("capitalize", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("uncapitalize", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("upper", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("lower", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("subjective", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("objective", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("possessive", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("reflexive", TokenType::kString, std::vector<TokenType>{TokenType::kString}, false);
-    registerFunction("list_concat", TokenType::kList, std::vector<TokenType>{TokenType::kList}, true);
-    registerFunction("prev", TokenType::kString, std::vector<TokenType>{TokenType::kInt}, false);
-    registerFunction("prev_match", TokenType::kString, std::vector<TokenType>{TokenType::kInt, TokenType::kList},
-                     false);
-    registerFunction("pluralize", TokenType::kString,
-                     std::vector<TokenType>{TokenType::kInt, TokenType::kString, TokenType::kString}, false);
-    registerFunction("count", TokenType::kInt, std::vector<TokenType>{TokenType::kList}, false);
-    registerFunction("concat", TokenType::kString, std::vector<TokenType>{TokenType::kList}, true);
-    registerFunction("add", TokenType::kFloat, std::vector<TokenType>{TokenType::kFloat, TokenType::kFloat}, false);
-    registerFunction("sub", TokenType::kFloat, std::vector<TokenType>{TokenType::kFloat, TokenType::kFloat}, false);
-    registerFunction("mult", TokenType::kFloat, std::vector<TokenType>{TokenType::kFloat, TokenType::kFloat}, false);
-    registerFunction("div", TokenType::kFloat, std::vector<TokenType>{TokenType::kFloat, TokenType::kFloat}, false);
-    registerFunction("div_int", TokenType::kInt, std::vector<TokenType>{TokenType::kInt, TokenType::kInt}, false);
-    registerFunction("mod", TokenType::kInt, std::vector<TokenType>{TokenType::kInt, TokenType::kInt}, false);
-    registerFunction("rand_int", TokenType::kInt, std::vector<TokenType>{TokenType::kInt, TokenType::kInt}, false);
-    registerFunction("num", TokenType::kString, std::vector<TokenType>{TokenType::kInt}, false);
-    registerFunction("ord", TokenType::kString, std::vector<TokenType>{TokenType::kInt}, false);
-    registerFunction(
-        "gender", TokenType::kString,
-        std::vector<TokenType>{TokenType::kString, TokenType::kString, TokenType::kString, TokenType::kString}, false);
-    registerFunction("if_else", TokenType::kString,
-                     std::vector<TokenType>{TokenType::kBool, TokenType::kString, TokenType::kString}, false);
-    registerFunction("and", TokenType::kBool, std::vector<TokenType>{TokenType::kBool, TokenType::kBool}, false);
-    registerFunction("or", TokenType::kBool, std::vector<TokenType>{TokenType::kBool, TokenType::kBool}, false);
-    registerFunction("not", TokenType::kBool, std::vector<TokenType>{TokenType::kBool}, false);
-    registerFunction("context", TokenType::kContext, std::vector<TokenType>{TokenType::kString, TokenType::kString},
-                     false);
-    registerFunction("raw_num", TokenType::kString, std::vector<TokenType>{TokenType::kInt}, false);
-}
-
-FunctionVal DefaultFunctionTable::doCall(const std::string& name, const std::vector<std::shared_ptr<SymbolToken>>& args,
+    const auto add = [this](FunctionId id, std::string name, TokenType returnType, std::vector<TokenType> argTypes,
+                            bool hasVarArgs, bool isPure) {
+        registerFunction(static_cast<int>(id), std::move(name), returnType, std::move(argTypes), hasVarArgs, isPure);
+    };
+    add(FunctionId::kCapitalize, "capitalize", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kUncapitalize, "uncapitalize", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kUpper, "upper", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kLower, "lower", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kSubjective, "subjective", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kObjective, "objective", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kPossessive, "possessive", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kReflexive, "reflexive", TokenType::kString, {TokenType::kString}, false, true);
+    add(FunctionId::kListConcat, "list_concat", TokenType::kList, {TokenType::kList}, true, true);
+    add(FunctionId::kPrev, "prev", TokenType::kString, {TokenType::kInt}, false, false);
+    add(FunctionId::kPrevMatch, "prev_match", TokenType::kString, {TokenType::kInt, TokenType::kList}, false, false);
+    add(FunctionId::kPluralize, "pluralize", TokenType::kString,
+        {TokenType::kInt, TokenType::kString, TokenType::kString}, false, true);
+    add(FunctionId::kCount, "count", TokenType::kInt, {TokenType::kList}, false, true);
+    add(FunctionId::kConcat, "concat", TokenType::kString, {TokenType::kList}, true, true);
+    add(FunctionId::kAdd, "add", TokenType::kFloat, {TokenType::kFloat, TokenType::kFloat}, false, true);
+    add(FunctionId::kSub, "sub", TokenType::kFloat, {TokenType::kFloat, TokenType::kFloat}, false, true);
+    add(FunctionId::kMult, "mult", TokenType::kFloat, {TokenType::kFloat, TokenType::kFloat}, false, true);
+    add(FunctionId::kDiv, "div", TokenType::kFloat, {TokenType::kFloat, TokenType::kFloat}, false, true);
+    add(FunctionId::kDivInt, "div_int", TokenType::kInt, {TokenType::kInt, TokenType::kInt}, false, true);
+    add(FunctionId::kMod, "mod", TokenType::kInt, {TokenType::kInt, TokenType::kInt}, false, true);
+    add(FunctionId::kRandInt, "rand_int", TokenType::kInt, {TokenType::kInt, TokenType::kInt}, false, false);
+    add(FunctionId::kNum, "num", TokenType::kString, {TokenType::kInt}, false, true);
+    add(FunctionId::kOrd, "ord", TokenType::kString, {TokenType::kInt}, false, true);
+    add(FunctionId::kGender, "gender", TokenType::kString,
+        {TokenType::kString, TokenType::kString, TokenType::kString, TokenType::kString}, false, true);
+    add(FunctionId::kIfElse, "if_else", TokenType::kString,
+        {TokenType::kBool, TokenType::kString, TokenType::kString}, false, true);
+    add(FunctionId::kAnd, "and", TokenType::kBool, {TokenType::kBool, TokenType::kBool}, false, true);
+    add(FunctionId::kOr, "or", TokenType::kBool, {TokenType::kBool, TokenType::kBool}, false, true);
+    add(FunctionId::kNot, "not", TokenType::kBool, {TokenType::kBool}, false, true);
+    add(FunctionId::kContext, "context", TokenType::kContext, {TokenType::kString, TokenType::kString}, false, false);
+    add(FunctionId::kRawNum, "raw_num", TokenType::kString, {TokenType::kInt}, false, true);
+}
+
+FunctionVal DefaultFunctionTable::doCall(const int functionId, const std::vector<std::shared_ptr<SymbolToken>>& args,
                                          DatabaseQuery& query) const {
     // After many days yonder wandering the arid highlands, pondering
     // the nature of reflection--I happened upon nothing worthy of song.
     // Herein lies a much more drab tale, yet perhaps the long-winded
     // road brought me the good fortune of simplicity after all.
-    if (name == "capitalize") {
-        std::optional<std::string> str = argToString(args[0], query);
-        if (!str) {
-            return FunctionVal();
-        }
-        return capitalize(*str);
-    }
-    if (name == "uncapitalize") {
-        std::optional<std::string> str = argToString(args[0], query);
-        if (!str) {
-            return FunctionVal();
+    switch (static_cast<FunctionId>(functionId)) {
+        case FunctionId::kCapitalize: {
+            std::optional<std::string> str = argToString(args[0], query);
+            if (!str) {
+                return FunctionVal();
+            }
+            return capitalize(std::move(*str));
         }
-        return uncapitalize(*str);
-    }
-    if (name == "upper") {
-        std::optional<std::string> str = argToString(args[0], query);
-        if (!str) {
-            return FunctionVal();
+        case FunctionId::kUncapitalize: {
+            std::optional<std::string> str = argToString(args[0], query);
+            if (!str) {
+                return FunctionVal();
+            }
+            return uncapitalize(std::move(*str));
         }
-        return upper(*str);
-    }
-    if (name == "lower") {
-        std::optional<std::string> str = argToString(args[0], query);
-        if (!str) {
-            return FunctionVal();
+        case FunctionId::kUpper: {
+            std::optional<std::string> str = argToString(args[0], query);
+            if (!str) {
+                return FunctionVal();
+            }
+            return upper(std::move(*str));
         }
-        return lower(*str);
-    }
-    if (name == "subjective") {
-        std::optional<std::string> gender = argToString(args[0], query);
-        if (!gender) {
-            return FunctionVal();
+        case FunctionId::kLower: {
+            std::optional<std::string> str = argToString(args[0], query);
+            if (!str) {
+                return FunctionVal();
+            }
+            return lower(std::move(*str));
         }
-        return subjective(*gender);
-    }
-    if (name == "objective") {
-        std::optional<std::string> gender = argToString(args[0], query);
-        if (!gender) {
-            return FunctionVal();
+        case FunctionId::kSubjective: {
+            std::optional<std::string> gender = argToString(args[0], query);
+            if (!gender) {
+                return FunctionVal();
+            }
+            return subjective(*gender);
         }
-        return objective(*gender);
-    }
-    if (name == "possessive") {
-        std::optional<std::string> gender = argToString(args[0], query);
-        if (!gender) {
-            return FunctionVal();
+        case FunctionId::kObjective: {
+            std::optional<std::string> gender = argToString(args[0], query);
+            if (!gender) {
+                return FunctionVal();
+            }
+            return objective(*gender);
         }
-        return possessive(*gender);
-    }
-    if (name == "reflexive") {
-        std::optional<std::string> gender = argToString(args[0], query);
-        if (!gender) {
-            return FunctionVal();
+        case FunctionId::kPossessive: {
+            std::optional<std::string> gender = argToString(args[0], query);
+            if (!gender) {
+                return FunctionVal();
+            }
+            return possessive(*gender);
         }
-        return reflexive(*gender);
-    }
-    if (name == "list_concat") {
-        std::vector<std::vector<int>> lists;
-        lists.reserve(args.size());
-        bool isStringList = true;
-        for (const auto& arg : args) {
-            std::optional<std::pair<std::vector<int>, bool>> list = argToList(arg, query);
-            if (!list) {
+        case FunctionId::kReflexive: {
+            std::optional<std::string> gender = argToString(args[0], query);
+            if (!gender) {
                 return FunctionVal();
             }
-            lists.push_back(std::move(list->first));
-            if (!list->second) {
-                isStringList = false;
+            return reflexive(*gender);
+        }
+        case FunctionId::kListConcat: {
+            // Append each list as it is evaluated instead of holding on to all of them
+            std::vector<int> result;
+            bool isStringList = true;
+            for (const auto& arg : args) {
+                std::optional<std::pair<std::vector<int>, bool>> list = argToList(arg, query);
+                if (!list) {
+                    return FunctionVal();
+                }
+                result.insert(result.end(), list->first.begin(), list->first.end());
+                if (!list->second) {
+                    isStringList = false;
+                }
             }
+            return FunctionVal(std::move(result), isStringList);
         }
-        return listConcat(lists, isStringList);
-    }
-    if (name == "prev") {
-        std::optional<int> index = argToInt(args[0], query);
-        if (!index) {
-            return FunctionVal();
+        case FunctionId::kPrev: {
+            std::optional<int> index = argToInt(args[0], query);
+            if (!index) {
+                return FunctionVal();
+            }
+            return prev(*index, query);
         }
-        return prev(*index, query);
-    }
-    if (name == "prev_match") {
-        std::optional<int> index = argToInt(args[0], query);
-        std::optional<std::pair<std::vector<int>, bool>> list = argToList(args[1], query);
-        if (!index || !list || !list->second) {
-            return FunctionVal();
+        case FunctionId::kPrevMatch: {
+            std::optional<int> index = argToInt(args[0], query);
+            std::optional<std::pair<std::vector<int>, bool>> list = argToList(args[1], query);
+            if (!index || !list || !list->second) {
+                return FunctionVal();
+            }
+            return prevMatch(*index, list->first, query);
         }
-        return prevMatch(*index, list->first, query);
-    }
-    if (name == "pluralize") {
-        std::optional<int> count = argToInt(args[0], query);
-        std::optional<std::string> singular = argToString(args[1], query);
-        std::optional<std::string> plural = argToString(args[2], query);
-        if (!count || !singular || !plural) {
-            return FunctionVal();
-        }
-        return pluralize(*count, *singular, *plural);
-    }
-    if (name == "count") {
-        std::optional<std::pair<std::vector<int>, bool>> list = argToList(args[1], query);
-        if (!list) {
-            return FunctionVal();
+        case FunctionId::kPluralize: {
+            std::optional<int> count = argToInt(args[0], query);
+            std::optional<std::string> singular = argToString(args[1], query);
+            std::optional<std::string> plural = argToString(args[2], query);
+            if (!count || !singular || !plural) {
+                return FunctionVal();
+            }
+            return pluralize(*count, std::move(*singular), std::move(*plural));
         }
-        return count(list->first);
-    }
-    if (name == "concat") {
-        std::vector<std::string> strings;
-        strings.reserve(args.size());
-        for (const auto& arg : args) {
-            std::optional<std::string> str = argToString(arg, query);
-            if (!str) {
+        case FunctionId::kCount: {
+            std::optional<size_t> size = argToListSize(args[0], query);
+            if (!size) {
                 return FunctionVal();
             }
-            strings.push_back(std::move(*str));
+            return FunctionVal(static_cast<int>(*size));
+        }
+        case FunctionId::kConcat: {
+            std::string result;
+            for (const auto& arg : args) {
+                std::optional<std::string> str = argToString(arg, query);
+                if (!str) {
+                    return FunctionVal();
+                }
+                result += *str;
+            }
+            return FunctionVal(std::move(result));
         }
-        return concat(strings);
-    }
-    if (name == "add") {
-        std::optional<float> a = argToFloat(args[0], query);
-        std::optional<float> b = argToFloat(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kAdd: {
+            std::optional<float> a = argToFloat(args[0], query);
+            std::optional<float> b = argToFloat(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return add(*a, *b);
         }
-        return add(*a, *b);
-    }
-    if (name == "sub") {
-        std::optional<float> a = argToFloat(args[0], query);
-        std::optional<float> b = argToFloat(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kSub: {
+            std::optional<float> a = argToFloat(args[0], query);
+            std::optional<float> b = argToFloat(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return sub(*a, *b);
         }
-        return sub(*a, *b);
-    }
-    if (name == "mult") {
-        std::optional<float> a = argToFloat(args[0], query);
-        std::optional<float> b = argToFloat(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kMult: {
+            std::optional<float> a = argToFloat(args[0], query);
+            std::optional<float> b = argToFloat(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return mult(*a, *b);
         }
-        return mult(*a, *b);
-    }
-    if (name == "div") {
-        std::optional<float> a = argToFloat(args[0], query);
-        std::optional<float> b = argToFloat(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kDiv: {
+            std::optional<float> a = argToFloat(args[0], query);
+            std::optional<float> b = argToFloat(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return div(*a, *b);
         }
-        return div(*a, *b);
-    }
-    if (name == "div_int") {
-        std::optional<int> a = argToInt(args[0], query);
-        std::optional<int> b = argToInt(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kDivInt: {
+            std::optional<int> a = argToInt(args[0], query);
+            std::optional<int> b = argToInt(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return divInt(*a, *b);
         }
-        return divInt(*a, *b);
-    }
-    if (name == "mod") {
-        std::optional<int> a = argToInt(args[0], query);
-        std::optional<int> b = argToInt(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kMod: {
+            std::optional<int> a = argToInt(args[0], query);
+            std::optional<int> b = argToInt(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return mod(*a, *b);
         }
-        return mod(*a, *b);
-    }
-    if (name == "rand_int") {
-        std::optional<int> min = argToInt(args[0], query);
-        std::optional<int> max = argToInt(args[1], query);
-        if (!min || !max) {
-            return FunctionVal();
+        case FunctionId::kRandInt: {
+            std::optional<int> min = argToInt(args[0], query);
+            std::optional<int> max = argToInt(args[1], query);
+            if (!min || !max) {
+                return FunctionVal();
+            }
+            return randInt(*min, *max, query);
         }
-        return randInt(*min, *max);
-    }
-    if (name == "num") {
-        std::optional<int> n = argToInt(args[0], query);
-        if (!n) {
-            return FunctionVal();
+        case FunctionId::kNum: {
+            std::optional<int> n = argToInt(args[0], query);
+            if (!n) {
+                return FunctionVal();
+            }
+            return num(*n);
         }
-        return num(*n);
-    }
-    if (name == "ord") {
-        std::optional<int> n = argToInt(args[0], query);
-        if (!n) {
-            return FunctionVal();
+        case FunctionId::kOrd: {
+            std::optional<int> n = argToInt(args[0], query);
+            if (!n) {
+                return FunctionVal();
+            }
+            return ord(*n);
+        }
+        case FunctionId::kGender: {
+            std::optional<std::string> genderStr = argToString(args[0], query);
+            std::optional<std::string> neutralStr = argToString(args[1], query);
+            std::optional<std::string> maleStr = argToString(args[2], query);
+            std::optional<std::string> femaleStr = argToString(args[3], query);
+            if (!genderStr || !neutralStr || !maleStr || !femaleStr) {
+                return FunctionVal();
+            }
+            return gender(*genderStr, std::move(*neutralStr), std::move(*maleStr), std::move(*femaleStr));
         }
-        return ord(*n);
-    }
-    if (name == "gender") {
-        std::optional<std::string> genderStr = argToString(args[0], query);
-        std::optional<std::string> neutralStr = argToString(args[1], query);
-        std::optional<std::string> maleStr = argToString(args[2], query);
-        std::optional<std::string> femaleStr = argToString(args[3], query);
-        if (!genderStr || !neutralStr || !maleStr || !femaleStr) {
-            return FunctionVal();
-        }
-        return gender(*genderStr, *neutralStr, *maleStr, *femaleStr);
-    }
-    if (name == "if_else") {
-        std::optional<bool> condition = argToBool(args[0], query);
-        std::optional<std::string> ifTrue = argToString(args[1], query);
-        std::optional<std::string> ifFalse = argToString(args[2], query);
-        if (!condition || !ifTrue || !ifFalse) {
-            return FunctionVal();
-        }
-        return ifElse(*condition, *ifTrue, *ifFalse);
-    }
-    if (name == "and") {
-        std::optional<bool> a = argToBool(args[0], query);
-        std::optional<bool> b = argToBool(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kIfElse: {
+            std::optional<bool> condition = argToBool(args[0], query);
+            std::optional<std::string> ifTrue = argToString(args[1], query);
+            std::optional<std::string> ifFalse = argToString(args[2], query);
+            if (!condition || !ifTrue || !ifFalse) {
+                return FunctionVal();
+            }
+            return ifElse(*condition, std::move(*ifTrue), std::move(*ifFalse));
         }
-        return boolAnd(*a, *b);
-    }
-    if (name == "or") {
-        std::optional<bool> a = argToBool(args[0], query);
-        std::optional<bool> b = argToBool(args[1], query);
-        if (!a || !b) {
-            return FunctionVal();
+        case FunctionId::kAnd: {
+            std::optional<bool> a = argToBool(args[0], query);
+            std::optional<bool> b = argToBool(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return boolAnd(*a, *b);
         }
-        return boolOr(*a, *b);
-    }
-    if (name == "not") {
-        std::optional<bool> a = argToBool(args[0], query);
-        if (!a) {
-            return FunctionVal();
+        case FunctionId::kOr: {
+            std::optional<bool> a = argToBool(args[0], query);
+            std::optional<bool> b = argToBool(args[1], query);
+            if (!a || !b) {
+                return FunctionVal();
+            }
+            return boolOr(*a, *b);
         }
-        return boolNot(*a);
-    }
-    if (name == "context") {
-        std::optional<std::string> table = argToString(args[0], query);
-        std::optional<std::string> key = argToString(args[1], query);
-        if (!table || !key) {
-            return FunctionVal();
+        case FunctionId::kNot: {
+            std::optional<bool> a = argToBool(args[0], query);
+            if (!a) {
+                return FunctionVal();
+            }
+            return boolNot(*a);
         }
-        return context(*table, *key, query);
-    }
-    if (name == "raw_num") {
-        std::optional<int> n = argToInt(args[0], query);
-        if (!n) {
-            return FunctionVal();
+        case FunctionId::kContext: {
+            std::optional<std::string> table = argToString(args[0], query);
+            std::optional<std::string> key = argToString(args[1], query);
+            if (!table || !key) {
+                return FunctionVal();
+            }
+            return context(*table, *key, query);
+        }
+        case FunctionId::kRawNum: {
+            std::optional<int> n = argToInt(args[0], query);
+            if (!n) {
+                return FunctionVal();
+            }
+            return rawNum(*n);
         }
-        return rawNum(*n);
     }
     return FunctionVal();
 }
@@ -1,5 +1,6 @@
 #include "FunctionTable.h"
 
+#include "SpeechGenerator.h"
 #include "SymbolParser.h"
 #include "TokenBoolean.h"
 #include "TokenContext.h"
@@ -13,7 +14,7 @@ namespace Contextual {
 
 namespace {
 
-const std::unique_ptr<FunctionSig> g_NOT_FOUND = std::make_unique<FunctionSig>();
+const std::unique_ptr<FunctionSig> g_NOT_FOUND = nullptr;
 
 }  // namespace
 
@@ -45,7 +46,7 @@ bool FunctionTable::validateArgs(const std::unique_ptr<FunctionSig>& sig,
         return args.empty();
     } else {
         // Check size
-        if (args.size() != sig->argTypes.size() || (sig->hasVarArgs && args.size() < sig->argTypes.size())) {
+        if (sig->hasVarArgs ? args.size() < sig->argTypes.size() : args.size() != sig->argTypes.size()) {
             // Incorrect number of arguments
             return false;
         }
@@ -84,25 +85,95 @@ FunctionVal FunctionTable::call(const std::string& name, const std::vector<std::
     if (!validateArgs(sig, args)) {
         return FunctionVal();
     }
+    return call(*sig, args, query);
+}
 
-    // Call function
-    FunctionVal result = doCall(name, args, query);
+FunctionVal FunctionTable::call(const FunctionSig& sig, const std::vector<std::shared_ptr<SymbolToken>>& args,
+                                DatabaseQuery& query) const {
+    FunctionVal result = doCall(sig.id, args, query);
 
     // Check return type
-    if (result.error || !matches(sig->returnType, result.type)) {
+    if (result.error || !matches(sig.returnType, result.type)) {
         return FunctionVal();
     }
     return result;
 }
 
-void FunctionTable::registerFunction(std::string name, TokenType returnType, std::vector<TokenType> argTypes,
-                                     bool hasVarArgs) {
-    FunctionSig sig = {returnType, std::move(argTypes), hasVarArgs};
+FunctionVal FunctionTable::call(const TokenFunction& token, DatabaseQuery& query) const {
+    if (const FunctionSig* sig = token.getSignature()) {
+        return call(*sig, token.getArgs(), query);
+    }
+    return call(token.getName(), token.getArgs(), query);
+}
+
+void FunctionTable::registerFunction(const int id, std::string name, TokenType returnType,
+                                     std::vector<TokenType> argTypes, bool hasVarArgs, bool isPure) {
+    FunctionSig sig = {returnType, std::move(argTypes), hasVarArgs, isPure, id};
     m_functionLookup.emplace(std::move(name), std::make_unique<FunctionSig>(sig));
 }
 
+std::shared_ptr<SymbolToken> FunctionTable::fold(const FunctionSig& sig,
+                                                const std::vector<std::shared_ptr<SymbolToken>>& args,
+                                                std::shared_ptr<ContextManager>& contextManager) const {
+    if (!sig.isPure) {
+        return nullptr;
+    }
+    for (const auto& arg : args) {
+        const TokenType type = arg->getType();
+        if (type != TokenType::kString && type != TokenType::kInt && type != TokenType::kFloat &&
+            type != TokenType::kBool) {
+            return nullptr;
+        }
+    }
+
+    // Literal arguments never read a context table, so the query only needs the manager's string table
+    DatabaseQuery query(contextManager);
+    FunctionVal result = call(sig, args, query);
+    if (result.error) {
+        return nullptr;
+    }
+    switch (result.type) {
+        case TokenType::kString:
+            return std::make_shared<TokenString>(std::move(result.stringVal));
+        case TokenType::kInt:
+            return std::make_shared<TokenInt>(result.intVal);
+        case TokenType::kFloat:
+            return std::make_shared<TokenFloat>(result.floatVal);
+        case TokenType::kBool:
+            return std::make_shared<TokenBoolean>(result.boolVal);
+        default:
+            return nullptr;
+    }
+}
+
+std::optional<std::string> FunctionTable::valueToString(FunctionVal&& val, DatabaseQuery& query) {
+    if (val.error) {
+        return std::nullopt;
+    }
+    if (val.type == TokenType::kList && val.isStringList && !val.listVal.empty()) {
+        size_t index = query.getRandom().randUInt(0, val.listVal.size() - 1);
+        return std::string(query.getStringTable().lookup(val.listVal[index]).value_or("NULL"));
+    }
+    if (val.type == TokenType::kString) {
+        return std::move(val.stringVal);
+    }
+    if (val.type == TokenType::kInt) {
+        return SpeechGenerator::integerToWord(val.intVal);
+    }
+    if (val.type == TokenType::kFloat) {
+        int intVal = static_cast<int>(val.floatVal);
+        return SpeechGenerator::integerToWord(intVal);
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> FunctionTable::argToString(const std::shared_ptr<SymbolToken>& token,
                                                       DatabaseQuery& query) const {
+    if (token->getType() == TokenType::kFunction) {
+        // Hand the nested result over directly instead of copying it out of TokenFunction::evaluate
+        const auto& functionToken = std::static_pointer_cast<TokenFunction>(token);
+        return valueToString(call(*functionToken, query), query);
+    }
     return token->evaluate(query);
 }
 
@@ -110,11 +181,11 @@ std::optional<std::pair<std::vector<int>, bool>> FunctionTable::argToList(const
                                                                           DatabaseQuery& query) const {
     if (token->getType() == TokenType::kContext) {
         const auto& contextToken = std::static_pointer_cast<TokenContext>(token);
-        const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(contextToken->getTable());
+        const ContextTable* contextTable = query.findContextTable(contextToken->getTableId());
         if (contextTable == nullptr) {
             return std::nullopt;
         }
-        const auto& ptr = contextTable->getList(contextToken->getKey());
+        const FactList* ptr = contextTable->getList(contextToken->getKeyId());
         if (ptr == nullptr) {
             return std::nullopt;
         }
@@ -123,14 +194,14 @@ std::optional<std::pair<std::vector<int>, bool>> FunctionTable::argToList(const
         for (const auto& item : *ptr) {
             vec.push_back(item);
         }
-        bool isStringList = contextTable->isStringList(contextToken->getKey());
-        return std::make_pair(vec, isStringList);
+        bool isStringList = contextTable->isStringList(contextToken->getKeyId());
+        return std::make_pair(std::move(vec), isStringList);
     }
     if (token->getType() == TokenType::kFunction) {
         const auto& functionToken = std::static_pointer_cast<TokenFunction>(token);
-        FunctionVal result = call(functionToken->getName(), functionToken->getArgs(), query);
+        FunctionVal result = call(*functionToken, query);
         if (!result.error && result.type == TokenType::kList) {
-            return std::make_pair(result.listVal, result.isStringList);
+            return std::make_pair(std::move(result.listVal), result.isStringList);
         }
         return std::nullopt;
     }
@@ -151,29 +222,50 @@ std::optional<std::pair<std::vector<int>, bool>> FunctionTable::argToList(const
                 return std::nullopt;
             }
         }
-        return std::make_pair(result, allStrings);
+        return std::make_pair(std::move(result), allStrings);
     }
     return std::nullopt;
 }
 
+std::optional<size_t> FunctionTable::argToListSize(const std::shared_ptr<SymbolToken>& token,
+                                                   DatabaseQuery& query) const {
+    if (token->getType() == TokenType::kContext) {
+        const auto& contextToken = std::static_pointer_cast<TokenContext>(token);
+        const ContextTable* contextTable = query.findContextTable(contextToken->getTableId());
+        if (contextTable == nullptr) {
+            return std::nullopt;
+        }
+        const FactList* ptr = contextTable->getList(contextToken->getKeyId());
+        if (ptr == nullptr) {
+            return std::nullopt;
+        }
+        return ptr->size();
+    }
+    std::optional<std::pair<std::vector<int>, bool>> list = argToList(token, query);
+    if (!list) {
+        return std::nullopt;
+    }
+    return list->first.size();
+}
+
 std::optional<int> FunctionTable::argToListItem(bool& isString, const std::shared_ptr<SymbolToken>& token,
                                                 DatabaseQuery& query) const {
     if (token->getType() == TokenType::kContext) {
         const auto& contextToken = std::static_pointer_cast<TokenContext>(token);
-        const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(contextToken->getTable());
+        const ContextTable* contextTable = query.findContextTable(contextToken->getTableId());
         if (contextTable == nullptr) {
             return std::nullopt;
         }
-        FactType type = contextTable->getType(contextToken->getKey());
+        FactType type = contextTable->getType(contextToken->getKeyId());
         if (type == FactType::kNumber || type == FactType::kString) {
             isString = type == FactType::kString;
-            return contextTable->getRawValue(contextToken->getKey());
+            return contextTable->getRawValue(contextToken->getKeyId());
         }
         return std::nullopt;
     }
     if (token->getType() == TokenType::kFunction) {
         const auto& functionToken = std::static_pointer_cast<TokenFunction>(token);
-        FunctionVal result = call(functionToken->getName(), functionToken->getArgs(), query);
+        FunctionVal result = call(*functionToken, query);
         if (!result.error) {
             if (result.type == TokenType::kInt) {
                 return result.intVal;
@@ -207,15 +299,15 @@ std::optional<int> FunctionTable::argToListItem(bool& isString, const std::share
 std::optional<int> FunctionTable::argToInt(const std::shared_ptr<SymbolToken>& token, DatabaseQuery& query) const {
     if (token->getType() == TokenType::kContext) {
         const auto& contextToken = std::static_pointer_cast<TokenContext>(token);
-        const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(contextToken->getTable());
+        const ContextTable* contextTable = query.findContextTable(contextToken->getTableId());
         if (contextTable == nullptr) {
             return std::nullopt;
         }
-        return contextTable->getInt(contextToken->getKey());
+        return contextTable->getInt(contextToken->getKeyId());
     }
     if (token->getType() == TokenType::kFunction) {
         const auto& functionToken = std::static_pointer_cast<TokenFunction>(token);
-        FunctionVal result = call(functionToken->getName(), functionToken->getArgs(), query);
+        FunctionVal result = call(*functionToken, query);
         if (!result.error) {
             if (result.type == TokenType::kInt) {
                 return result.intVal;
@@ -240,15 +332,15 @@ std::optional<int> FunctionTable::argToInt(const std::shared_ptr<SymbolToken>& t
 std::optional<float> FunctionTable::argToFloat(const std::shared_ptr<SymbolToken>& token, DatabaseQuery& query) const {
     if (token->getType() == TokenType::kContext) {
         const auto& contextToken = std::static_pointer_cast<TokenContext>(token);
-        const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(contextToken->getTable());
+        const ContextTable* contextTable = query.findContextTable(contextToken->getTableId());
         if (contextTable == nullptr) {
             return std::nullopt;
         }
-        return contextTable->getFloat(contextToken->getKey());
+        return contextTable->getFloat(contextToken->getKeyId());
     }
     if (token->getType() == TokenType::kFunction) {
         const auto& functionToken = std::static_pointer_cast<TokenFunction>(token);
-        FunctionVal result = call(functionToken->getName(), functionToken->getArgs(), query);
+        FunctionVal result = call(*functionToken, query);
         if (!result.error) {
             if (result.type == TokenType::kInt) {
                 return result.intVal;
@@ -273,15 +365,15 @@ std::optional<float> FunctionTable::argToFloat(const std::shared_ptr<SymbolToken
 std::optional<bool> FunctionTable::argToBool(const std::shared_ptr<SymbolToken>& token, DatabaseQuery& query) const {
     if (token->getType() == TokenType::kContext) {
         const auto& contextToken = std::static_pointer_cast<TokenContext>(token);
-        const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(contextToken->getTable());
+        const ContextTable* contextTable = query.findContextTable(contextToken->getTableId());
         if (contextTable == nullptr) {
             return std::nullopt;
         }
-        return contextTable->getBool(contextToken->getKey());
+        return contextTable->getBool(contextToken->getKeyId());
     }
     if (token->getType() == TokenType::kFunction) {
         const auto& functionToken = std::static_pointer_cast<TokenFunction>(token);
-        FunctionVal result = call(functionToken->getName(), functionToken->getArgs(), query);
+        FunctionVal result = call(*functionToken, query);
         if (!result.error) {
             if (result.type == TokenType::kBool) {
                 return result.boolVal;
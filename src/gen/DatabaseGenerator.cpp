@@ -0,0 +1,380 @@
+#include "DatabaseGenerator.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "Random.h"
+
+namespace Contextual::Gen {
+
+namespace {
+
+const std::string g_PRESET_CATEGORY = "Preset";
+const std::string g_KEY_NAME = "Name";
+const std::string g_KEY_TAGS = "Tags";
+const std::string g_EXT_JSON = ".json";
+
+const std::vector<std::string> g_WORDS = {
+    "hello", "there", "friend", "the",   "road",  "is",    "long", "and",   "dark", "we",    "should", "move",
+    "on",    "before", "night", "falls", "I",     "think", "you",  "were", "right", "about", "this",   "place",
+    "watch", "your",  "step",   "keep",  "quiet", "still", "not",  "yet",  "come",  "here", "again",  "soon"};
+const std::vector<std::string> g_STRING_FUNCTIONS = {"upper", "lower", "capitalize"};
+const std::vector<std::string> g_INT_FUNCTIONS = {"num", "ord"};
+const std::vector<std::string> g_COMPARE_TYPES = {"Lt", "Le", "Gt", "Ge"};
+const std::vector<std::string> g_RANGE_TYPES = {"LtLt", "LtLe", "LeLt", "LeLe"};
+const std::vector<std::string> g_DYNAMIC_TYPES = {"Eq", "Lt", "Le", "Gt", "Ge"};
+
+enum class CriterionKind { kEquals, kAlternate, kRange, kCompare, kDynamic, kExists, kIncludes, kEmpty, kNamed, kFail };
+
+// Each group gets its own stream so groups can be generated independently and in any order
+uint64_t groupSeed(uint64_t seed, uint32_t groupIndex) {
+    return seed ^ ((static_cast<uint64_t>(groupIndex) + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+template <typename T>
+const T& pick(Random& random, const std::vector<T>& options) {
+    return options[random.randUInt(0, options.size() - 1)];
+}
+
+bool chance(Random& random, float probability) {
+    return random.randFloat(0.0f, 1.0f) < probability;
+}
+
+class GroupWriter {
+public:
+    GroupWriter(const GeneratorSettings& settings, uint32_t groupIndex)
+        : m_settings(settings), m_random(groupSeed(settings.seed, groupIndex)), m_groupIndex(groupIndex) {
+        const auto& mix = settings.criterionMix;
+        m_weights = {{CriterionKind::kEquals, mix.equals},     {CriterionKind::kAlternate, mix.alternate},
+                     {CriterionKind::kRange, mix.range},       {CriterionKind::kCompare, mix.compare},
+                     {CriterionKind::kDynamic, mix.dynamic},   {CriterionKind::kExists, mix.exists},
+                     {CriterionKind::kIncludes, mix.includes}, {CriterionKind::kEmpty, mix.empty},
+                     {CriterionKind::kNamed, settings.numPresets > 0 ? mix.named : 0},
+                     {CriterionKind::kFail, mix.fail}};
+        for (const auto& weight : m_weights) {
+            m_totalWeight += std::max(weight.second, 0);
+        }
+    }
+
+    std::string write() {
+        m_out.clear();
+        m_out += "{\n  \"Name\": \"" + getGroupName(m_groupIndex) + "\",\n";
+        if (m_settings.inheritanceDepth > 1 && m_groupIndex % m_settings.inheritanceDepth != 0) {
+            m_out += "  \"Parent\": \"" + getGroupName(m_groupIndex - 1) + "\",\n";
+        }
+        m_out += "  \"Type\": \"Speech\",\n";
+        writeSymbols();
+        m_out += "  \"Categories\": [\n";
+        writePresets();
+        for (uint32_t c = 0; c < m_settings.numCategories; ++c) {
+            m_out += ",\n";
+            writeCategory(c);
+        }
+        m_out += "\n  ]\n}\n";
+        return m_out;
+    }
+
+private:
+    const GeneratorSettings& m_settings;
+    Random m_random;
+    uint32_t m_groupIndex;
+    std::vector<std::pair<CriterionKind, int>> m_weights;
+    int m_totalWeight = 0;
+    std::string m_out;
+
+    const std::string& randomTable() {
+        return pick(m_random, m_settings.tables);
+    }
+
+    std::string randomKey() {
+        return "Key" + std::to_string(m_random.randUInt(0, m_settings.numKeys - 1));
+    }
+
+    int randomValue() {
+        return m_random.randInt(0, static_cast<int>(m_settings.numValues) - 1);
+    }
+
+    std::string randomTag() {
+        return "Tag" + std::to_string(randomValue());
+    }
+
+    // Symbols are inherited by child groups and cannot be redefined, so each group gets its own names
+    std::string symbolName(size_t symbolIndex) {
+        return "sym" + std::to_string(m_groupIndex) + "_" + std::to_string(symbolIndex);
+    }
+
+    std::string tableKey(const std::string& table, const std::string& key) {
+        return "\"Table\": \"" + table + "\", \"Key\": \"" + key + "\"";
+    }
+
+    CriterionKind randomKind() {
+        if (m_totalWeight <= 0) {
+            return CriterionKind::kEquals;
+        }
+        int roll = m_random.randInt(0, m_totalWeight - 1);
+        for (const auto& weight : m_weights) {
+            if (weight.second <= 0) {
+                continue;
+            }
+            if (roll < weight.second) {
+                return weight.first;
+            }
+            roll -= weight.second;
+        }
+        return CriterionKind::kEquals;
+    }
+
+    void writeSymbols() {
+        if (m_settings.numSymbols == 0) {
+            return;
+        }
+        m_out += "  \"Symbols\": [\n";
+        for (uint32_t i = 0; i < m_settings.numSymbols; ++i) {
+            if (i > 0) {
+                m_out += ",\n";
+            }
+            m_out += "    {\"Name\": \"" + symbolName(i) + "\", ";
+            switch (i % 4) {
+                case 0:
+                    m_out += "\"Type\": \"Context\", \"Value\": {" + tableKey(randomTable(), g_KEY_NAME) + "}}";
+                    break;
+                case 1: {
+                    m_out += "\"Type\": \"List\", \"Value\": [";
+                    size_t count = m_random.randUInt(2, 5);
+                    for (size_t j = 0; j < count; ++j) {
+                        if (j > 0) {
+                            m_out += ", ";
+                        }
+                        m_out += "{\"Type\": \"String\", \"Value\": \"" + pick(m_random, g_WORDS) + "\"}";
+                    }
+                    m_out += "]}";
+                    break;
+                }
+                case 2:
+                    m_out += "\"Type\": \"Function\", \"Value\": {\"Name\": \"" + pick(m_random, g_STRING_FUNCTIONS) +
+                             "\", \"Args\": [{\"Type\": \"Context\", \"Value\": {" +
+                             tableKey(randomTable(), g_KEY_NAME) + "}}]}}";
+                    break;
+                default:
+                    m_out += "\"Type\": \"String\", \"Value\": \"" + pick(m_random, g_WORDS) + "\"}";
+                    break;
+            }
+        }
+        m_out += "\n  ],\n";
+    }
+
+    // Presets are named rules without a response, so they only exist to be referenced by Named criteria
+    void writePresets() {
+        m_out += "    {\"Name\": \"" + g_PRESET_CATEGORY + "\", \"Rules\": [";
+        for (uint32_t i = 0; i < m_settings.numPresets; ++i) {
+            m_out += i > 0 ? ",\n      " : "\n      ";
+            m_out += "{\"Name\": \"Preset" + std::to_string(i) + "\", \"Criteria\": [";
+            writeSimpleCriterion(CriterionKind::kEquals);
+            m_out += "]}";
+        }
+        m_out += "\n    ]}";
+    }
+
+    void writeCategory(uint32_t categoryIndex) {
+        m_out += "    {\"Name\": \"" + getCategoryName(categoryIndex) + "\", ";
+        if (m_groupIndex % std::max(m_settings.inheritanceDepth, 1u) != 0 &&
+            chance(m_random, m_settings.noInheritChance)) {
+            m_out += "\"Inherit\": false, ";
+        }
+        m_out += "\"Rules\": [";
+        for (uint32_t r = 0; r < m_settings.rulesPerCategory; ++r) {
+            m_out += r > 0 ? ",\n      " : "\n      ";
+            writeRule();
+        }
+        m_out += "\n    ]}";
+    }
+
+    void writeRule() {
+        m_out += "{\"Criteria\": [";
+        size_t numCriteria = m_random.randUInt(m_settings.minCriteria, m_settings.maxCriteria);
+        for (size_t i = 0; i < numCriteria; ++i) {
+            if (i > 0) {
+                m_out += ", ";
+            }
+            writeSimpleCriterion(randomKind());
+        }
+        m_out += "], \"Response\": [{\"Type\": \"Text\", \"Value\": [";
+        for (uint32_t i = 0; i < m_settings.linesPerRule; ++i) {
+            if (i > 0) {
+                m_out += ", ";
+            }
+            m_out += "\"" + randomSpeechLine() + "\"";
+        }
+        m_out += "]}]}";
+    }
+
+    void writeSimpleCriterion(CriterionKind kind) {
+        const std::string invert = chance(m_random, 0.1f) ? ", \"Invert\": true" : "";
+        switch (kind) {
+            case CriterionKind::kEquals:
+                m_out += "{\"Type\": \"Eq\", " + tableKey(randomTable(), randomKey()) +
+                         ", \"Value\": " + std::to_string(randomValue()) + invert + "}";
+                break;
+            case CriterionKind::kAlternate: {
+                m_out += "{\"Type\": \"Eq\", " + tableKey(randomTable(), randomKey()) + ", \"Value\": [";
+                size_t count = m_random.randUInt(2, 4);
+                for (size_t i = 0; i < count; ++i) {
+                    m_out += (i > 0 ? ", " : "") + std::to_string(randomValue());
+                }
+                m_out += "]" + invert + "}";
+                break;
+            }
+            case CriterionKind::kRange: {
+                int a = randomValue();
+                int b = randomValue();
+                m_out += "{\"Type\": \"" + pick(m_random, g_RANGE_TYPES) + "\", " +
+                         tableKey(randomTable(), randomKey()) + ", \"Value\": [" + std::to_string(std::min(a, b)) +
+                         ", " + std::to_string(std::max(a, b)) + "]" + invert + "}";
+                break;
+            }
+            case CriterionKind::kCompare:
+                m_out += "{\"Type\": \"" + pick(m_random, g_COMPARE_TYPES) + "\", " +
+                         tableKey(randomTable(), randomKey()) + ", \"Value\": " + std::to_string(randomValue()) +
+                         invert + "}";
+                break;
+            case CriterionKind::kDynamic:
+                m_out += "{\"Type\": \"" + pick(m_random, g_DYNAMIC_TYPES) + "\", " +
+                         tableKey(randomTable(), randomKey()) + ", \"Value\": {" +
+                         tableKey(randomTable(), randomKey()) + "}" + invert + "}";
+                break;
+            case CriterionKind::kExists:
+                m_out += "{\"Type\": \"Exists\", " + tableKey(randomTable(), randomKey()) + invert + "}";
+                break;
+            case CriterionKind::kIncludes: {
+                m_out += "{\"Type\": \"Includes\", " + tableKey(randomTable(), g_KEY_TAGS) + ", \"Value\": [";
+                size_t count = m_random.randUInt(1, 3);
+                for (size_t i = 0; i < count; ++i) {
+                    m_out += (i > 0 ? ", \"" : "\"") + randomTag() + "\"";
+                }
+                m_out += "]" + invert + "}";
+                break;
+            }
+            case CriterionKind::kEmpty:
+                m_out += "{\"Type\": \"Empty\", " + tableKey(randomTable(), g_KEY_TAGS) + invert + "}";
+                break;
+            case CriterionKind::kNamed:
+                m_out += "{\"Type\": \"Named\", \"Value\": \"Preset" +
+                         std::to_string(m_random.randUInt(0, m_settings.numPresets - 1)) + "\"}";
+                break;
+            case CriterionKind::kFail:
+                m_out += "{\"Type\": \"Fail\", \"Value\": " + std::to_string(m_random.randInt(1, 9) / 10.0f) + "}";
+                break;
+        }
+    }
+
+    std::string randomWords(size_t min, size_t max) {
+        std::string words;
+        size_t count = m_random.randUInt(min, max);
+        for (size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                words += " ";
+            }
+            words += pick(m_random, g_WORDS);
+        }
+        return words;
+    }
+
+    std::string randomSpeechLine() {
+        std::string line;
+        size_t numTokens = m_random.randUInt(m_settings.minLineTokens, m_settings.maxLineTokens);
+        for (size_t i = 0; i < numTokens; ++i) {
+            if (i > 0) {
+                line += " ";
+            }
+            switch (m_random.randInt(0, 5)) {
+                case 0:
+                    line += "#" + randomTable() + "." + (chance(m_random, 0.5f) ? g_KEY_NAME : randomKey());
+                    break;
+                case 1:
+                    if (m_settings.numSymbols > 0) {
+                        line += "@" + symbolName(m_random.randUInt(0, m_settings.numSymbols - 1));
+                    } else {
+                        line += randomWords(1, 3);
+                    }
+                    break;
+                case 2:
+                    if (chance(m_random, 0.5f)) {
+                        line += "@" + pick(m_random, g_STRING_FUNCTIONS) + "(#" + randomTable() + "." + g_KEY_NAME +
+                                ")";
+                    } else {
+                        line += "@" + pick(m_random, g_INT_FUNCTIONS) + "(#" + randomTable() + "." + randomKey() + ")";
+                    }
+                    break;
+                case 3:
+                    line += chance(m_random, 0.5f)
+                                ? "*" + randomWords(1, 2) + "*"
+                                : "{speed=" + std::to_string(m_random.randInt(1, 5)) + "}" + randomWords(1, 2);
+                    break;
+                default:
+                    line += randomWords(1, 4);
+                    break;
+            }
+        }
+        line += ".";
+        return line;
+    }
+};
+
+GeneratorResult validateSettings(const GeneratorSettings& settings) {
+    if (settings.minCriteria > settings.maxCriteria) {
+        return {GeneratorReturnCode::kInvalidSettings, "Minimum criteria count is larger than the maximum"};
+    }
+    if (settings.minLineTokens > settings.maxLineTokens || settings.minLineTokens == 0) {
+        return {GeneratorReturnCode::kInvalidSettings, "Speech line token range must be nonempty and start above 0"};
+    }
+    if (settings.tables.empty() || settings.numKeys == 0 || settings.numValues == 0) {
+        return {GeneratorReturnCode::kInvalidSettings, "Tables, keys and values must all be nonempty"};
+    }
+    if (settings.linesPerRule == 0) {
+        return {GeneratorReturnCode::kInvalidSettings, "Rules must have at least one speech line"};
+    }
+    return {GeneratorReturnCode::kSuccess, ""};
+}
+
+}  // namespace
+
+std::string getGroupName(uint32_t groupIndex) {
+    return "Group" + std::to_string(groupIndex);
+}
+
+std::string getCategoryName(uint32_t categoryIndex) {
+    return "Category" + std::to_string(categoryIndex);
+}
+
+std::string generateGroup(const GeneratorSettings& settings, uint32_t groupIndex) {
+    return GroupWriter(settings, groupIndex).write();
+}
+
+GeneratorResult generateDatabase(GeneratorStats& stats, const GeneratorSettings& settings, const std::string& outDir) {
+    stats = {0, 0, 0};
+    auto result = validateSettings(settings);
+    if (result.code != GeneratorReturnCode::kSuccess) {
+        return result;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(outDir, error);
+    if (error) {
+        return {GeneratorReturnCode::kInvalidPath, "Failed to create directory \"" + outDir + "\": " + error.message()};
+    }
+
+    for (uint32_t g = 0; g < settings.numGroups; ++g) {
+        const auto path = std::filesystem::path(outDir) / (getGroupName(g) + g_EXT_JSON);
+        std::ofstream file(path);
+        if (!file) {
+            return {GeneratorReturnCode::kInvalidPath, "Failed to open \"" + path.string() + "\" for writing"};
+        }
+        file << generateGroup(settings, g);
+        ++stats.numGroups;
+        stats.numCategories += settings.numCategories;
+        stats.numRules += settings.numCategories * settings.rulesPerCategory;
+    }
+    return {GeneratorReturnCode::kSuccess, ""};
+}
+
+}  // namespace Contextual::Gen
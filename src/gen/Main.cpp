@@ -0,0 +1,132 @@
+#include <plog/Appenders/ColorConsoleAppender.h>
+#include <plog/Formatters/MessageOnlyFormatter.h>
+#include <plog/Init.h>
+#include <plog/Log.h>
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "DatabaseGenerator.h"
+
+struct GenSettings {
+    bool help{false};
+    std::string outputDir = "./generated/synthetic";
+    Contextual::Gen::GeneratorSettings generator;
+};
+
+uint32_t toCount(const std::string& arg) {
+    return static_cast<uint32_t>(std::stoul(arg));
+}
+
+const std::unordered_map<std::string, std::function<void(GenSettings&)>> NoArgHandles = {
+    {"--help", [](GenSettings& s) { s.help = true; }}};
+
+const std::unordered_map<std::string, std::function<void(GenSettings&, const std::string&)>> OneArgHandles = {
+    {"--output", [](GenSettings& s, const std::string& arg) { s.outputDir = arg; }},
+    {"--seed", [](GenSettings& s, const std::string& arg) { s.generator.seed = std::stoull(arg); }},
+    {"--groups", [](GenSettings& s, const std::string& arg) { s.generator.numGroups = toCount(arg); }},
+    {"--depth", [](GenSettings& s, const std::string& arg) { s.generator.inheritanceDepth = toCount(arg); }},
+    {"--categories", [](GenSettings& s, const std::string& arg) { s.generator.numCategories = toCount(arg); }},
+    {"--rules", [](GenSettings& s, const std::string& arg) { s.generator.rulesPerCategory = toCount(arg); }},
+    {"--min-criteria", [](GenSettings& s, const std::string& arg) { s.generator.minCriteria = toCount(arg); }},
+    {"--max-criteria", [](GenSettings& s, const std::string& arg) { s.generator.maxCriteria = toCount(arg); }},
+    {"--presets", [](GenSettings& s, const std::string& arg) { s.generator.numPresets = toCount(arg); }},
+    {"--symbols", [](GenSettings& s, const std::string& arg) { s.generator.numSymbols = toCount(arg); }},
+    {"--lines", [](GenSettings& s, const std::string& arg) { s.generator.linesPerRule = toCount(arg); }},
+    {"--min-tokens", [](GenSettings& s, const std::string& arg) { s.generator.minLineTokens = toCount(arg); }},
+    {"--max-tokens", [](GenSettings& s, const std::string& arg) { s.generator.maxLineTokens = toCount(arg); }},
+    {"--keys", [](GenSettings& s, const std::string& arg) { s.generator.numKeys = toCount(arg); }},
+    {"--values", [](GenSettings& s, const std::string& arg) { s.generator.numValues = toCount(arg); }},
+    {"--no-inherit", [](GenSettings& s, const std::string& arg) { s.generator.noInheritChance = std::stof(arg); }},
+    // Comma-separated weights in the order of CriterionMix
+    {"--mix", [](GenSettings& s, const std::string& arg) {
+         auto& mix = s.generator.criterionMix;
+         int* weights[] = {&mix.equals, &mix.alternate, &mix.range,    &mix.compare, &mix.dynamic,
+                           &mix.exists, &mix.includes,  &mix.empty, &mix.named,   &mix.fail};
+         size_t start = 0;
+         for (int* weight : weights) {
+             if (start > arg.size()) {
+                 break;
+             }
+             size_t end = arg.find(',', start);
+             *weight = std::stoi(arg.substr(start, end - start));
+             start = end == std::string::npos ? arg.size() + 1 : end + 1;
+         }
+     }}};
+
+bool parseFlags(GenSettings& flags, int argc, const char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+
+        auto noArg = NoArgHandles.find(option);
+        if (noArg != NoArgHandles.end()) {
+            noArg->second(flags);
+            continue;
+        }
+
+        auto oneArg = OneArgHandles.find(option);
+        if (oneArg != OneArgHandles.end()) {
+            if (++i >= argc) {
+                std::cerr << "Missing parameter after " << option << std::endl;
+                return false;
+            }
+            try {
+                oneArg->second(flags, argv[i]);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value \"" << argv[i] << "\" for " << option << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        std::cerr << "Unrecognized command line option " << option << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void printUsage(const std::string& name) {
+    PLOG_INFO << "Usage: " << name << " [options]\n\n"
+              << "Writes a synthetic rule database readable by context-app.\n\n"
+                 "\t--output <dir>        Output directory (default ./generated/synthetic)\n"
+                 "\t--seed <n>            Seed, the same seed and options always give the same files\n"
+                 "\t--groups <n>          Number of groups\n"
+                 "\t--depth <n>           Length of each Parent inheritance chain\n"
+                 "\t--categories <n>      Categories per group\n"
+                 "\t--rules <n>           Rules per category\n"
+                 "\t--min-criteria <n>    Fewest criteria per rule\n"
+                 "\t--max-criteria <n>    Most criteria per rule\n"
+                 "\t--mix <w,w,...>       Criterion weights: Eq,Alternate,Range,Compare,Dynamic,Exists,Includes,\n"
+                 "\t                      Empty,Named,Fail\n"
+                 "\t--presets <n>         Named preset rules per group\n"
+                 "\t--symbols <n>         Symbols per group\n"
+                 "\t--lines <n>           Speech lines per rule\n"
+                 "\t--min-tokens <n>      Fewest pieces per speech line\n"
+                 "\t--max-tokens <n>      Most pieces per speech line\n"
+                 "\t--keys <n>            Numeric context keys per table\n"
+                 "\t--values <n>          Distinct values per key\n"
+                 "\t--no-inherit <p>      Chance that a child category does not inherit its parent's rules\n";
+}
+
+int main(int argc, const char* argv[]) {
+    static plog::ColorConsoleAppender<plog::MessageOnlyFormatter> consoleAppender;
+    plog::init(plog::info, &consoleAppender);
+
+    GenSettings settings;
+    if (!parseFlags(settings, argc, argv) || settings.help) {
+        printUsage(argv[0]);
+        return settings.help ? 0 : -1;
+    }
+
+    Contextual::Gen::GeneratorStats stats{};
+    auto result = Contextual::Gen::generateDatabase(stats, settings.generator, settings.outputDir);
+    if (result.code != Contextual::Gen::GeneratorReturnCode::kSuccess) {
+        PLOG_ERROR << "Failed to generate database: " << result.errorMsg;
+        return -1;
+    }
+    PLOG_INFO << "Generated " << stats.numRules << " rules in " << stats.numCategories << " categories across "
+              << stats.numGroups << " groups in " << settings.outputDir;
+    return 0;
+}
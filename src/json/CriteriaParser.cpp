@@ -1,5 +1,7 @@
 #include "CriteriaParser.h"
 
+#include "CriterionInterner.h"
+
 #include "CriterionAlternate.h"
 #include "CriterionDynamic.h"
 #include "CriterionEmpty.h"
@@ -83,9 +85,9 @@ JsonParseResult getInvert(bool& invert, const rapidjson::Value& root) {
 }
 
 // Precondition: value is an object
-JsonParseResult parseDynamicCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                      const rapidjson::Value& value, const std::string& table, const std::string& key,
-                                      const bool invert, const DynamicComparisonType type) {
+JsonParseResult parseDynamicCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                      int& priority, const rapidjson::Value& value, const std::string& table,
+                                      const std::string& key, const bool invert, const DynamicComparisonType type) {
     std::string otherTable;
     std::string otherKey;
     auto result = getTableKey(otherTable, otherKey, value);
@@ -120,61 +122,66 @@ JsonParseResult parseDynamicCriterion(std::vector<std::shared_ptr<Criteria>>& cr
             return {JsonParseReturnCode::kInvalidValue, "Invalid dynamic comparison type"};
     }
 
-    criteria.push_back(std::make_shared<Criteria>(
+    criteria.push_back(interner.intern(
         table, key,
         std::make_shared<CriterionDynamic>(minDelta, maxDelta, std::move(otherTable), std::move(otherKey), invert)));
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseExistsCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                     const std::string& table, const std::string& key, const bool invert) {
+JsonParseResult parseExistsCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                     int& priority, const std::string& table, const std::string& key,
+                                     const bool invert) {
     if (invert) {
-        criteria.push_back(std::make_shared<Criteria>(table, key, g_CRITERION_EXISTS_FALSE));
+        criteria.push_back(interner.intern(table, key, g_CRITERION_EXISTS_FALSE));
     } else {
-        criteria.push_back(std::make_shared<Criteria>(table, key, g_CRITERION_EXISTS_TRUE));
+        criteria.push_back(interner.intern(table, key, g_CRITERION_EXISTS_TRUE));
     }
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseEmptyCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                    const std::string& table, const std::string& key, const bool invert) {
+JsonParseResult parseEmptyCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                    int& priority, const std::string& table, const std::string& key,
+                                    const bool invert) {
     if (invert) {
-        criteria.push_back(std::make_shared<Criteria>(table, key, g_CRITERION_EMPTY_FALSE));
+        criteria.push_back(interner.intern(table, key, g_CRITERION_EMPTY_FALSE));
     } else {
-        criteria.push_back(std::make_shared<Criteria>(table, key, g_CRITERION_EMPTY_TRUE));
+        criteria.push_back(interner.intern(table, key, g_CRITERION_EMPTY_TRUE));
     }
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseEqualsCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                     StringTable& stringTable, const rapidjson::Value& value, const std::string& table,
-                                     const std::string& key, const bool invert) {
+JsonParseResult parseEqualsCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                     int& priority, StringTable& stringTable, const rapidjson::Value& value,
+                                     const std::string& table, const std::string& key, const bool invert) {
     if (value.IsObject()) {
-        return parseDynamicCriterion(criteria, priority, value, table, key, invert, DynamicComparisonType::kEquals);
+        return parseDynamicCriterion(criteria, interner, priority, value, table, key, invert,
+                                     DynamicComparisonType::kEquals);
     }
     if (value.IsString()) {
         const std::string& strValue = value.GetString();
         auto cachedValue = static_cast<float>(stringTable.cache(strValue));
-        criteria.push_back(std::make_shared<Criteria>(
-            table, key, std::make_shared<CriterionStatic>(cachedValue - g_EPSILON, cachedValue + g_EPSILON, invert)));
+        criteria.push_back(interner.intern(
+            table, key,
+            std::make_shared<CriterionStatic>(cachedValue - g_EPSILON, cachedValue + g_EPSILON, invert, true)));
     } else if (value.IsNumber()) {
         float numValue = value.GetFloat();
-        criteria.push_back(std::make_shared<Criteria>(
+        criteria.push_back(interner.intern(
             table, key, std::make_shared<CriterionStatic>(numValue - g_EPSILON, numValue + g_EPSILON, invert)));
     } else if (value.IsBool()) {
         if (value.GetBool() != invert) {
-            criteria.push_back(std::make_shared<Criteria>(table, key, g_CRITERION_EQUALS_TRUE));
+            criteria.push_back(interner.intern(table, key, g_CRITERION_EQUALS_TRUE));
         } else {
-            criteria.push_back(std::make_shared<Criteria>(table, key, g_CRITERION_EQUALS_FALSE));
+            criteria.push_back(interner.intern(table, key, g_CRITERION_EQUALS_FALSE));
         }
     } else if (value.IsArray()) {
         // List of primitives
         std::unordered_set<int> options;
+        std::unordered_set<int> symbols;
         options.reserve(value.Size());
-        for (auto iter = value.Begin(); iter != value.Begin(); ++iter) {
+        for (auto iter = value.Begin(); iter != value.End(); ++iter) {
             const auto& option = *iter;
             if (option.IsNumber()) {
                 options.insert(option.GetInt());
@@ -183,13 +190,14 @@ JsonParseResult parseEqualsCriterion(std::vector<std::shared_ptr<Criteria>>& cri
             } else if (option.IsString()) {
                 int cachedValue = stringTable.cache(option.GetString());
                 options.insert(cachedValue);
+                symbols.insert(cachedValue);
             } else {
                 return {JsonParseReturnCode::kInvalidType,
                         "Alternate criterion options must be a numerical value, booleans, or strings"};
             }
         }
-        criteria.push_back(
-            std::make_shared<Criteria>(table, key, std::make_shared<CriterionAlternate>(std::move(options), invert)));
+        criteria.push_back(interner.intern(
+            table, key, std::make_shared<CriterionAlternate>(std::move(options), invert, std::move(symbols))));
     } else {
         return {JsonParseReturnCode::kInvalidValue,
                 "Unsupported value type for equals criterion: \"" + std::to_string(value.GetType()) + "\""};
@@ -199,12 +207,12 @@ JsonParseResult parseEqualsCriterion(std::vector<std::shared_ptr<Criteria>>& cri
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseLessThanCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                       const rapidjson::Value& value, const std::string& table, const std::string& key,
-                                       const bool invert, bool equals) {
+JsonParseResult parseLessThanCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                       int& priority, const rapidjson::Value& value, const std::string& table,
+                                       const std::string& key, const bool invert, bool equals) {
     if (value.IsObject()) {
         DynamicComparisonType type = equals ? DynamicComparisonType::kLessEqual : DynamicComparisonType::kLessThan;
-        return parseDynamicCriterion(criteria, priority, value, table, key, invert, type);
+        return parseDynamicCriterion(criteria, interner, priority, value, table, key, invert, type);
     }
     if (!value.IsNumber()) {
         return {JsonParseReturnCode::kInvalidType, "Comparison criterion must have a numeric value"};
@@ -216,18 +224,18 @@ JsonParseResult parseLessThanCriterion(std::vector<std::shared_ptr<Criteria>>& c
         max -= g_EPSILON;
     }
     criteria.push_back(
-        std::make_shared<Criteria>(table, key, std::make_shared<CriterionStatic>(-g_INFINITY, max, invert)));
+        interner.intern(table, key, std::make_shared<CriterionStatic>(-g_INFINITY, max, invert)));
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseGreaterThanCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                          const rapidjson::Value& value, const std::string& table,
+JsonParseResult parseGreaterThanCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                          int& priority, const rapidjson::Value& value, const std::string& table,
                                           const std::string& key, const bool invert, bool equals) {
     if (value.IsObject()) {
         DynamicComparisonType type =
             equals ? DynamicComparisonType::kGreaterEqual : DynamicComparisonType::kGreaterThan;
-        return parseDynamicCriterion(criteria, priority, value, table, key, invert, type);
+        return parseDynamicCriterion(criteria, interner, priority, value, table, key, invert, type);
     }
     if (!value.IsNumber()) {
         return {JsonParseReturnCode::kInvalidType, "Comparison criterion must have a numeric value"};
@@ -239,14 +247,15 @@ JsonParseResult parseGreaterThanCriterion(std::vector<std::shared_ptr<Criteria>>
         min += g_EPSILON;
     }
     criteria.push_back(
-        std::make_shared<Criteria>(table, key, std::make_shared<CriterionStatic>(min, g_INFINITY, invert)));
+        interner.intern(table, key, std::make_shared<CriterionStatic>(min, g_INFINITY, invert)));
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseRangeCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                    const rapidjson::Value& value, const std::string& table, const std::string& key,
-                                    const bool invert, const bool equalsMin, const bool equalsMax) {
+JsonParseResult parseRangeCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                    int& priority, const rapidjson::Value& value, const std::string& table,
+                                    const std::string& key, const bool invert, const bool equalsMin,
+                                    const bool equalsMax) {
     if (!value.IsArray() || value.Size() != 2 || !value[0].IsNumber() || !value[1].IsNumber()) {
         return {JsonParseReturnCode::kInvalidType, "Range criterion must have an array of exactly 2 numeric values"};
     }
@@ -265,19 +274,20 @@ JsonParseResult parseRangeCriterion(std::vector<std::shared_ptr<Criteria>>& crit
         max -= g_EPSILON;
     }
 
-    criteria.push_back(std::make_shared<Criteria>(table, key, std::make_shared<CriterionStatic>(min, max, invert)));
+    criteria.push_back(interner.intern(table, key, std::make_shared<CriterionStatic>(min, max, invert)));
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseIncludesCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                       StringTable& stringTable, const rapidjson::Value& value,
+JsonParseResult parseIncludesCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                       int& priority, StringTable& stringTable, const rapidjson::Value& value,
                                        const std::string& table, const std::string& key, const bool invert) {
     if (!value.IsArray() || value.Empty()) {
         return {JsonParseReturnCode::kInvalidType, "Includes criterion must have a nonempty array value"};
     }
 
     std::vector<int> options;
+    std::unordered_set<int> symbols;
     options.reserve(value.Size());
     for (auto iter = value.Begin(); iter != value.End(); ++iter) {
         const auto& option = *iter;
@@ -288,14 +298,15 @@ JsonParseResult parseIncludesCriterion(std::vector<std::shared_ptr<Criteria>>& c
         } else if (option.IsString()) {
             int cachedValue = stringTable.cache(option.GetString());
             options.push_back(cachedValue);
+            symbols.insert(cachedValue);
         } else {
             return {JsonParseReturnCode::kInvalidType,
                     "Includes criterion options must be a numerical value, booleans, or strings"};
         }
     }
 
-    criteria.push_back(
-        std::make_shared<Criteria>(table, key, std::make_shared<CriterionIncludes>(std::move(options), invert)));
+    criteria.push_back(interner.intern(
+        table, key, std::make_shared<CriterionIncludes>(std::move(options), invert, std::move(symbols))));
     ++priority;
     return JsonUtils::g_RESULT_SUCCESS;
 }
@@ -326,7 +337,8 @@ JsonParseResult parseDummyCriterion(int& priority, const rapidjson::Value& value
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseFailCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, const rapidjson::Value& value) {
+JsonParseResult parseFailCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                   const rapidjson::Value& value) {
     if (!value.IsNumber()) {
         return {JsonParseReturnCode::kInvalidType, "Fail criterion must have a numeric value"};
     }
@@ -336,12 +348,12 @@ JsonParseResult parseFailCriterion(std::vector<std::shared_ptr<Criteria>>& crite
     }
 
     // Table and key should be unused
-    criteria.push_back(std::make_shared<Criteria>("", "", std::make_shared<CriterionFail>(numValue)));
+    criteria.push_back(interner.intern("", "", std::make_shared<CriterionFail>(numValue)));
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseSpecialCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                                      const std::string& type, const rapidjson::Value& root,
+JsonParseResult parseSpecialCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                                      int& priority, const std::string& type, const rapidjson::Value& root,
                                       const std::unordered_map<std::string, RuleInfo>& namedRules) {
     if (!root.HasMember(g_KEY_CRITERION_VALUE)) {
         return {JsonParseReturnCode::kMissingKey, "Criterion must specify key \"" + g_KEY_CRITERION_VALUE + "\""};
@@ -356,13 +368,13 @@ JsonParseResult parseSpecialCriterion(std::vector<std::shared_ptr<Criteria>>& cr
         return parseDummyCriterion(priority, value);
     }
     if (type == g_TYPE_FAIL) {
-        return parseFailCriterion(criteria, value);
+        return parseFailCriterion(criteria, interner, value);
     }
     return {JsonParseReturnCode::kInvalidValue, "Unrecognized special criterion type \"" + type + "\""};
 }
 
-JsonParseResult parseCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority,
-                               StringTable& stringTable, const rapidjson::Value& root,
+JsonParseResult parseCriterion(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                               int& priority, StringTable& stringTable, const rapidjson::Value& root,
                                const std::unordered_map<std::string, RuleInfo>& namedRules) {
     if (!root.IsObject()) {
         return {JsonParseReturnCode::kInvalidType, "Criterion must be a JSON object"};
@@ -380,7 +392,7 @@ JsonParseResult parseCriterion(std::vector<std::shared_ptr<Criteria>>& criteria,
 
     // Special types that do not need context info
     if (g_SPECIAL_TYPES.find(type) != g_SPECIAL_TYPES.end()) {
-        return parseSpecialCriterion(criteria, priority, type, root, namedRules);
+        return parseSpecialCriterion(criteria, interner, priority, type, root, namedRules);
     }
 
     std::string table;
@@ -397,10 +409,10 @@ JsonParseResult parseCriterion(std::vector<std::shared_ptr<Criteria>>& criteria,
 
     // Exists and empty type do not need a value
     if (type == g_TYPE_EXISTS) {
-        return parseExistsCriterion(criteria, priority, table, key, invert);
+        return parseExistsCriterion(criteria, interner, priority, table, key, invert);
     }
     if (type == g_TYPE_EMPTY) {
-        return parseEmptyCriterion(criteria, priority, table, key, invert);
+        return parseEmptyCriterion(criteria, interner, priority, table, key, invert);
     }
 
     // Get value
@@ -410,42 +422,42 @@ JsonParseResult parseCriterion(std::vector<std::shared_ptr<Criteria>>& criteria,
     const auto& value = root[g_KEY_CRITERION_VALUE];
 
     if (type == g_TYPE_EQUALS) {
-        return parseEqualsCriterion(criteria, priority, stringTable, value, table, key, invert);
+        return parseEqualsCriterion(criteria, interner, priority, stringTable, value, table, key, invert);
     }
     if (type == g_TYPE_LESS_THAN) {
-        return parseLessThanCriterion(criteria, priority, value, table, key, invert, false);
+        return parseLessThanCriterion(criteria, interner, priority, value, table, key, invert, false);
     }
     if (type == g_TYPE_LESS_EQUAL) {
-        return parseLessThanCriterion(criteria, priority, value, table, key, invert, true);
+        return parseLessThanCriterion(criteria, interner, priority, value, table, key, invert, true);
     }
     if (type == g_TYPE_GREATER_THAN) {
-        return parseGreaterThanCriterion(criteria, priority, value, table, key, invert, false);
+        return parseGreaterThanCriterion(criteria, interner, priority, value, table, key, invert, false);
     }
     if (type == g_TYPE_GREATER_EQUAL) {
-        return parseGreaterThanCriterion(criteria, priority, value, table, key, invert, true);
+        return parseGreaterThanCriterion(criteria, interner, priority, value, table, key, invert, true);
     }
     if (type == g_TYPE_LT_LT) {
-        return parseRangeCriterion(criteria, priority, value, table, key, invert, false, false);
+        return parseRangeCriterion(criteria, interner, priority, value, table, key, invert, false, false);
     }
     if (type == g_TYPE_LT_LE) {
-        return parseRangeCriterion(criteria, priority, value, table, key, invert, false, true);
+        return parseRangeCriterion(criteria, interner, priority, value, table, key, invert, false, true);
     }
     if (type == g_TYPE_LE_LT) {
-        return parseRangeCriterion(criteria, priority, value, table, key, invert, true, false);
+        return parseRangeCriterion(criteria, interner, priority, value, table, key, invert, true, false);
     }
     if (type == g_TYPE_LE_LE) {
-        return parseRangeCriterion(criteria, priority, value, table, key, invert, true, true);
+        return parseRangeCriterion(criteria, interner, priority, value, table, key, invert, true, true);
     }
     if (type == g_TYPE_INCLUDES) {
-        return parseIncludesCriterion(criteria, priority, stringTable, value, table, key, invert);
+        return parseIncludesCriterion(criteria, interner, priority, stringTable, value, table, key, invert);
     }
     return {JsonParseReturnCode::kInvalidValue, "Unrecognized criterion type \"" + type + "\""};
 }
 
 }  // namespace
 
-JsonParseResult parseCriteria(std::vector<std::shared_ptr<Criteria>>& criteria, int& priority, StringTable& stringTable,
-                              const rapidjson::Value& root,
+JsonParseResult parseCriteria(std::vector<std::shared_ptr<Criteria>>& criteria, CriterionInterner& interner,
+                              int& priority, StringTable& stringTable, const rapidjson::Value& root,
                               const std::unordered_map<std::string, RuleInfo>& namedRules) {
     if (root.HasMember(g_KEY_CRITERIA)) {
         const auto& value = root[g_KEY_CRITERIA];
@@ -453,7 +465,7 @@ JsonParseResult parseCriteria(std::vector<std::shared_ptr<Criteria>>& criteria,
             return {JsonParseReturnCode::kInvalidType, "Key \"" + g_KEY_CRITERIA + "\" must be an array"};
         }
         for (auto iter = value.Begin(); iter != value.End(); ++iter) {
-            auto result = parseCriterion(criteria, priority, stringTable, *iter, namedRules);
+            auto result = parseCriterion(criteria, interner, priority, stringTable, *iter, namedRules);
             if (result.code != JsonParseReturnCode::kSuccess) {
                 return result;
             }
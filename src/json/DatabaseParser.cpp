@@ -1,8 +1,13 @@
 #include "DatabaseParser.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <mutex>
 #include <optional>
-#include <queue>
+#include <utility>
+#include <vector>
 
 #define RAPIDJSON_HAS_STDSTRING 1
 #include <plog/Log.h>
@@ -40,24 +45,55 @@ struct ParsedGroup {
     std::string name;
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>> symbols;
     std::unordered_map<std::string, RuleInfo> namedRules;
+    // Same tables as in the database, kept here so children can inherit from them before they are published
+    std::unordered_map<std::string, std::shared_ptr<const RuleTable>> tables;
+};
+
+// Everything built for one group. Tables are only added to the database once the whole group has parsed, so groups
+// can be built concurrently and a group that fails leaves nothing behind.
+struct BuiltGroup {
+    ParsedGroup group;
+    uint32_t numRules = 0;
 };
 
 struct QueuedGroup {
-    rapidjson::Value& value;
+    // Owns the parsed file, since it outlives the call that read it
+    std::shared_ptr<rapidjson::Document> document;
     std::string name;
     std::string path;
-    std::string parentName;
+    std::optional<std::string> parentName;
+};
+
+struct LoadedGroup {
+    // Kept so that children can be rebuilt without touching their files when this group is reloaded
+    QueuedGroup source;
+    ParsedGroup group;
 };
 
 struct ParsedData {
+    explicit ParsedData(RuleDatabase& database) : database(database) {}
+
     RuleDatabase& database;
-    std::queue<QueuedGroup> queuedGroups;
-    std::unordered_map<std::string, ParsedGroup> parsedGroups;
+    std::unordered_map<std::string, LoadedGroup> groups;
+    // Shared by every group, including reloaded ones, so identical criteria are stored once per database
+    std::unique_ptr<CriterionInterner> interner = std::make_unique<CriterionInterner>();
     DatabaseStats stats = {0, 0, 0, 0};
 };
 
 // Helper methods
 
+std::vector<std::string> findFiles(const std::string& dirPath) {
+    std::vector<std::string> paths;
+    for (const auto& file : std::filesystem::recursive_directory_iterator(dirPath)) {
+        if (file.path().extension().string() == g_EXT_JSON) {
+            paths.push_back(file.path().string());
+        }
+    }
+    // Directory order is unspecified, so sort to keep loading deterministic
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
 // Parsing methods
 
 JsonParseResult getParsingType(ParsingType& type, const rapidjson::Value& root) {
@@ -82,10 +118,10 @@ JsonParseResult getParsingType(ParsingType& type, const rapidjson::Value& root)
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseCategory(ParsedData& parsedData, std::unordered_map<std::string, RuleInfo>& namedRules,
+JsonParseResult parseCategory(BuiltGroup& builtGroup, RuleDatabase& database, CriterionInterner& interner,
                               const ParsingType parsingType, const rapidjson::Value& root,
                               const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
-                              const std::string& groupName, const std::optional<ParsedGroup>& parsedParent) {
+                              const ParsedGroup* parsedParent) {
     if (!root.IsObject()) {
         return {JsonParseReturnCode::kInvalidType, "Category must be a JSON object"};
     }
@@ -97,12 +133,13 @@ JsonParseResult parseCategory(ParsedData& parsedData, std::unordered_map<std::st
     }
 
     // Get category name
+    const std::string& groupName = builtGroup.group.name;
     std::string categoryName;
     auto result = JsonUtils::getString(categoryName, root, g_KEY_CATEGORY_NAME);
     if (result.code != JsonParseReturnCode::kSuccess) {
         return result;
     }
-    if (parsedData.database.getRuleTable(groupName, categoryName) != nullptr) {
+    if (builtGroup.group.tables.find(categoryName) != builtGroup.group.tables.end()) {
         return {JsonParseReturnCode::kAlreadyDefined,
                 "Category \"" + categoryName + "\" for group \"" + groupName + "\" is already defined"};
     }
@@ -117,14 +154,13 @@ JsonParseResult parseCategory(ParsedData& parsedData, std::unordered_map<std::st
         inheritParent = inheritValue.GetBool();
     }
 
-    auto ruleTable = std::make_unique<RuleTable>();
+    auto ruleTable = std::make_shared<RuleTable>();
 
     // If Inherit is true, then add all the rules of the parent if it exists
-    if (inheritParent && parsedParent) {
-        const std::unique_ptr<RuleTable>& parentTable =
-            parsedData.database.getRuleTable(parsedParent->name, categoryName);
-        if (parentTable != nullptr) {
-            ruleTable->addEntries(parentTable->getEntries());
+    if (inheritParent && parsedParent != nullptr) {
+        auto parentTable = parsedParent->tables.find(categoryName);
+        if (parentTable != parsedParent->tables.end()) {
+            ruleTable->addEntries(parentTable->second->getEntries());
         }
     }
 
@@ -136,11 +172,11 @@ JsonParseResult parseCategory(ParsedData& parsedData, std::unordered_map<std::st
         }
         int nextId = 0;  // ID used for unnamed rules
         const std::string idPrefix = groupName + "." + categoryName + ".";
-        StringTable& stringTable = parsedData.database.getContextManager()->getStringTable();
+        StringTable& stringTable = database.getContextManager()->getStringTable();
         for (auto iter = rulesValue.Begin(); iter != rulesValue.End(); ++iter) {
             std::shared_ptr<RuleEntry> ruleEntry;
-            result = RuleParser::parseRule(stringTable, ruleEntry, namedRules, nextId, *iter, idPrefix, parsingType,
-                                           symbols, parsedData.database.getContextManager()->getFunctionTable());
+            result = RuleParser::parseRule(stringTable, interner, ruleEntry, builtGroup.group.namedRules, nextId,
+                                           *iter, idPrefix, parsingType, symbols, database.getContextManager());
             if (result.code == JsonParseReturnCode::kSkipCreation) {
                 continue;
             }
@@ -148,30 +184,30 @@ JsonParseResult parseCategory(ParsedData& parsedData, std::unordered_map<std::st
                 return result;
             }
             ruleTable->addEntry(ruleEntry);
-            ++parsedData.stats.numRules;
+            ++builtGroup.numRules;
         }
     }
 
-    // If rule table is not empty, add it
+    // If rule table is not empty, keep it
     if (ruleTable->getNumEntries() > 0) {
         ruleTable->sortEntries();
-        parsedData.database.addRuleTable(groupName, categoryName, ruleTable);
-        ++parsedData.stats.numTables;
+        ruleTable->enableCache(database.getCacheCapacity());
+        builtGroup.group.tables.emplace(categoryName, std::move(ruleTable));
     }
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseCategories(ParsedData& parsedData, std::unordered_map<std::string, RuleInfo>& namedRules,
+JsonParseResult parseCategories(BuiltGroup& builtGroup, RuleDatabase& database, CriterionInterner& interner,
                                 const ParsingType parsingType, const rapidjson::Value& root,
                                 const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
-                                const std::string& groupName, const std::optional<ParsedGroup>& parsedParent) {
+                                const ParsedGroup* parsedParent) {
     if (root.HasMember(g_KEY_CATEGORIES)) {
         const auto& value = root[g_KEY_CATEGORIES];
         if (!value.IsArray()) {
             return {JsonParseReturnCode::kInvalidType, "Key \"" + g_KEY_CATEGORIES + "\" must be an array"};
         }
         for (auto iter = value.Begin(); iter != value.End(); ++iter) {
-            auto result = parseCategory(parsedData, namedRules, parsingType, *iter, symbols, groupName, parsedParent);
+            auto result = parseCategory(builtGroup, database, interner, parsingType, *iter, symbols, parsedParent);
             if (result.code != JsonParseReturnCode::kSuccess) {
                 return result;
             }
@@ -180,8 +216,11 @@ JsonParseResult parseCategories(ParsedData& parsedData, std::unordered_map<std::
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
-JsonParseResult parseGroup(ParsedData& parsedData, const rapidjson::Value& root, const std::string& name,
-                           const std::optional<ParsedGroup>& parsedParent) {
+// Never touches the database tables, so groups whose parents are already built can be parsed concurrently
+JsonParseResult parseGroup(BuiltGroup& builtGroup, RuleDatabase& database, CriterionInterner& interner,
+                           const rapidjson::Value& root, const std::string& name, const ParsedGroup* parsedParent) {
+    builtGroup.group.name = name;
+
     // Type
     ParsingType parsingType;
     auto result = getParsingType(parsingType, root);
@@ -190,34 +229,52 @@ JsonParseResult parseGroup(ParsedData& parsedData, const rapidjson::Value& root,
     }
 
     // Symbols
-    std::unordered_map<std::string, std::shared_ptr<SymbolToken>> symbols;
+    auto& symbols = builtGroup.group.symbols;
     // Simple groups do not use symbols
     if (parsingType != ParsingType::kSimple) {
         // Copy over parent symbols
-        if (parsedParent) {
+        if (parsedParent != nullptr) {
             symbols.insert(parsedParent->symbols.begin(), parsedParent->symbols.end());
         }
-        result = SymbolParser::parseSymbols(symbols, root, std::nullopt,
-                                            parsedData.database.getContextManager()->getFunctionTable());
+        result = SymbolParser::parseSymbols(symbols, root, std::nullopt, database.getContextManager());
         if (result.code != JsonParseReturnCode::kSuccess) {
             return result;
         }
     }
 
-    std::unordered_map<std::string, RuleInfo> namedRules;
-    result = parseCategories(parsedData, namedRules, parsingType, root, symbols, name, parsedParent);
-    if (result.code != JsonParseReturnCode::kSuccess) {
-        return result;
-    }
+    return parseCategories(builtGroup, database, interner, parsingType, root, symbols, parsedParent);
+}
 
-    parsedData.parsedGroups.insert({name, {name, symbols, namedRules}});
+// Queues the tables of a built group for the database. Needs exclusive access to the parsed data.
+JsonParseResult commitGroup(ParsedData& parsedData, std::vector<RuleTableUpdate>& updates, QueuedGroup& source,
+                            BuiltGroup& builtGroup) {
+    const std::string name = builtGroup.group.name;
+    auto got = parsedData.groups.find(name);
+    if (got != parsedData.groups.end()) {
+        return {JsonParseReturnCode::kAlreadyDefined,
+                "Group \"" + name + "\" is already defined in " + got->second.source.path};
+    }
+    for (const auto& [category, table] : builtGroup.group.tables) {
+        if (parsedData.database.getRuleTable(name, category) != nullptr) {
+            return {JsonParseReturnCode::kAlreadyDefined,
+                    "Category \"" + category + "\" for group \"" + name + "\" is already defined"};
+        }
+    }
+    for (const auto& [category, table] : builtGroup.group.tables) {
+        updates.push_back({name, category, table});
+    }
+    parsedData.stats.numTables += builtGroup.group.tables.size();
+    parsedData.stats.numRules += builtGroup.numRules;
+    parsedData.groups.emplace(name, LoadedGroup{std::move(source), std::move(builtGroup.group)});
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
 // Main methods
 
-JsonParseResult readGroup(ParsedData& parsedData, const std::string& path, bool allowMissingParent) {
-    rapidjson::Document document;
+JsonParseResult readDocument(QueuedGroup& queuedGroup, const std::string& path) {
+    queuedGroup.path = path;
+    queuedGroup.document = std::make_shared<rapidjson::Document>();
+    rapidjson::Document& document = *queuedGroup.document;
     bool fileExists = JsonUtils::readFile(path, document);
     if (!fileExists) {
         return {JsonParseReturnCode::kInvalidPath, "No file found at path \"" + path + "\""};
@@ -233,120 +290,345 @@ JsonParseResult readGroup(ParsedData& parsedData, const std::string& path, bool
     if (!document.HasMember(g_KEY_NAME)) {
         return {JsonParseReturnCode::kMissingKey, "Group must specify key \"" + g_KEY_NAME + "\""};
     }
-    std::string name;
-    auto result = JsonUtils::getString(name, document, g_KEY_NAME);
+    auto result = JsonUtils::getString(queuedGroup.name, document, g_KEY_NAME);
     if (result.code != JsonParseReturnCode::kSuccess) {
         return result;
     }
 
     // Parent
-    std::optional<ParsedGroup> parsedParent;
     if (document.HasMember(g_KEY_PARENT)) {
         std::string parentName;
         result = JsonUtils::getString(parentName, document, g_KEY_PARENT);
         if (result.code != JsonParseReturnCode::kSuccess) {
             return result;
         }
-        auto got = parsedData.parsedGroups.find(parentName);
-        if (got == parsedData.parsedGroups.end()) {
-            if (!allowMissingParent) {
-                // Parent is not loaded yet, add to queue
-                parsedData.queuedGroups.push({document, name, path, parentName});
-                return {JsonParseReturnCode::kSkipCreation, ""};
-            }
-        } else {
-            parsedParent = got->second;
-        }
+        queuedGroup.parentName = parentName;
     }
+    return JsonUtils::g_RESULT_SUCCESS;
+}
 
-    return parseGroup(parsedData, document, name, parsedParent);
+void logResult(ParsedData& parsedData, const std::string& path, const JsonParseResult& result) {
+    if (result.code == JsonParseReturnCode::kSuccess) {
+        PLOG_INFO << "Successfully parsed " << path;
+        ++parsedData.stats.numLoaded;
+    } else if (result.code != JsonParseReturnCode::kSkipCreation) {
+        PLOG_ERROR << "Failed to parse " << path << ": " << result.errorMsg;
+        ++parsedData.stats.numFailed;
+    }
 }
 
-void resolveQueuedGroups(ParsedData& parsedData) {
-    // There's probably a less brute-force way to do this
-    // But do I look that fancy?
-    auto& queue = parsedData.queuedGroups;
-    size_t checkAfter = queue.size();
-    bool changed = false;
+// Builds each group as soon as its own parent has been committed, so independent groups and whole inheritance
+// subtrees are built in parallel, without waiting for unrelated groups, while inheritance still sees finished parent
+// tables. Children inherit from the parent's ParsedGroup, so the database only publishes once, when every group is
+// done.
+void resolveQueuedGroups(ParsedData& parsedData, std::vector<QueuedGroup>& queue, ThreadPool& threadPool) {
+    // Decide up front, in file order, which file defines each group, so duplicates resolve the same way every time
+    std::unordered_map<std::string, size_t> definitions;
+    std::vector<bool> handled(queue.size(), false);
+    for (size_t i = 0; i < queue.size(); ++i) {
+        auto loaded = parsedData.groups.find(queue[i].name);
+        auto defined = definitions.find(queue[i].name);
+        if (loaded != parsedData.groups.end() || defined != definitions.end()) {
+            const std::string& otherPath =
+                loaded != parsedData.groups.end() ? loaded->second.source.path : queue[defined->second].path;
+            logResult(parsedData, queue[i].path,
+                      {JsonParseReturnCode::kAlreadyDefined,
+                       "Group \"" + queue[i].name + "\" is already defined in " + otherPath});
+            handled[i] = true;
+        } else {
+            definitions.emplace(queue[i].name, i);
+        }
+    }
 
-    while (!queue.empty()) {
-        const auto& item = queue.front();
+    // Groups whose parent is missing or circular never become ready
+    std::vector<std::vector<size_t>> children(queue.size());
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        if (handled[i]) {
+            continue;
+        }
+        const auto& parentName = queue[i].parentName;
+        if (!parentName || parsedData.groups.find(*parentName) != parsedData.groups.end()) {
+            ready.push_back(i);
+            handled[i] = true;
+        } else if (auto parent = definitions.find(*parentName); parent != definitions.end()) {
+            children[parent->second].push_back(i);
+        }
+    }
 
-        auto got = parsedData.parsedGroups.find(item.parentName);
-        if (got == parsedData.parsedGroups.end()) {
-            // Parent still not loaded, add back to queue
-            queue.push(item);
-        } else {
-            // Parent now loaded, proceed with parsing group
-            auto result = parseGroup(parsedData, item.value, item.name, got->second);
+    // Every slot builds ready groups until none are left and none are being built, which could make more ready.
+    // Everything but parseGroup runs under the mutex.
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t numBuilding = 0;
+    std::vector<RuleTableUpdate> updates;
+    threadPool.parallelFor(threadPool.getNumThreads() + 1, [&](size_t) {
+        std::unique_lock lock(mutex);
+        while (true) {
+            condition.wait(lock, [&]() { return !ready.empty() || numBuilding == 0; });
+            if (ready.empty()) {
+                return;
+            }
+            QueuedGroup& item = queue[ready.front()];
+            const std::vector<size_t>& itemChildren = children[ready.front()];
+            ready.pop_front();
+            ++numBuilding;
+            const ParsedGroup* parsedParent = item.parentName ? &parsedData.groups.at(*item.parentName).group : nullptr;
+            lock.unlock();
+
+            BuiltGroup builtGroup;
+            auto result = parseGroup(builtGroup, parsedData.database, *parsedData.interner, *item.document, item.name,
+                                     parsedParent);
+
+            lock.lock();
+            const std::string path = item.path;
             if (result.code == JsonParseReturnCode::kSuccess) {
-                PLOG_INFO << "Successfully parsed " << item.path;
-                ++parsedData.stats.numLoaded;
-            } else if (result.code != JsonParseReturnCode::kSkipCreation) {
-                PLOG_ERROR << "Failed to parse " << item.path << ": " << result.errorMsg;
-                ++parsedData.stats.numFailed;
+                result = commitGroup(parsedData, updates, item, builtGroup);
             }
-            changed = true;
-        }
-        queue.pop();  // Make sure to pop only AFTER we're done using the item
-
-        // After going through the entire queue once, check if any groups were
-        // successfully loaded. If not, then all that's left are missing/circular
-        // dependencies.
-        if (--checkAfter == 0) {
-            if (!changed) {
-                // Gather list of all failed groups
-                parsedData.stats.numFailed += queue.size();
-                while (!queue.empty()) {
-                    const auto& failedItem = queue.front();
-                    PLOG_ERROR << "Failed to parse " << failedItem.path
-                               << ": Unknown parent \"" + failedItem.parentName +
-                                      "\" (is it missing or circular reference)?";
-                    queue.pop();
+            if (result.code == JsonParseReturnCode::kSuccess) {
+                for (const size_t child : itemChildren) {
+                    ready.push_back(child);
+                    handled[child] = true;
                 }
             }
-            // Reset counters--probably leads to some repetitions if there are multiple successes in a loop but oh well
-            checkAfter = queue.size();
-            changed = false;
+            logResult(parsedData, path, result);
+            --numBuilding;
+            condition.notify_all();
+        }
+    });
+    if (!updates.empty()) {
+        parsedData.database.updateRuleTables(updates);
+    }
+
+    // Whatever was never handled is missing its parent or part of a cycle
+    for (size_t i = 0; i < queue.size(); ++i) {
+        if (!handled[i]) {
+            ++parsedData.stats.numFailed;
+            PLOG_ERROR << "Failed to parse " << queue[i].path
+                       << ": Unknown parent \"" + *queue[i].parentName + "\" (is it missing or circular reference)?";
         }
     }
 }
 
-void readAllFiles(ParsedData& parsedData, const std::string& dirPath) {
+void readAllFiles(ParsedData& parsedData, const std::string& dirPath, ThreadPool& threadPool) {
     if (!std::filesystem::is_directory(dirPath)) {
         PLOG_ERROR << "No directory found at path \"" << dirPath << "\"";
         return;
     }
 
-    const auto& dir = std::filesystem::recursive_directory_iterator(dirPath);
-    for (const auto& file : dir) {
-        const std::string& extension = file.path().extension().string();
-        if (extension == g_EXT_JSON) {
-            const std::string& path = file.path().string();
-            auto result = readGroup(parsedData, path, false);
-            if (result.code == JsonParseReturnCode::kSuccess) {
-                PLOG_INFO << "Successfully parsed " << path;
-                ++parsedData.stats.numLoaded;
-            } else if (result.code != JsonParseReturnCode::kSkipCreation) {
-                PLOG_ERROR << "Failed to parse " << path << ": " << result.errorMsg;
-                ++parsedData.stats.numFailed;
+    // Reading and parsing the JSON of each file is independent
+    const std::vector<std::string> paths = findFiles(dirPath);
+    std::vector<QueuedGroup> documents(paths.size());
+    std::vector<JsonParseResult> results(paths.size());
+    threadPool.parallelFor(paths.size(), [&](const size_t i) { results[i] = readDocument(documents[i], paths[i]); });
+
+    std::vector<QueuedGroup> queue;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (results[i].code == JsonParseReturnCode::kSuccess) {
+            queue.push_back(std::move(documents[i]));
+        } else {
+            logResult(parsedData, paths[i], results[i]);
+        }
+    }
+    resolveQueuedGroups(parsedData, queue, threadPool);
+}
+
+// Every group that inherits from the given one, directly or not, grouped by distance from it
+std::vector<std::vector<std::string>> findDescendants(const ParsedData& parsedData, const std::string& name) {
+    std::unordered_map<std::string, std::vector<std::string>> children;
+    for (const auto& [childName, loadedGroup] : parsedData.groups) {
+        if (loadedGroup.source.parentName) {
+            children[*loadedGroup.source.parentName].push_back(childName);
+        }
+    }
+    std::vector<std::vector<std::string>> levels;
+    std::vector<std::string> level = {name};
+    while (true) {
+        std::vector<std::string> next;
+        for (const auto& parentName : level) {
+            auto got = children.find(parentName);
+            if (got != children.end()) {
+                next.insert(next.end(), got->second.begin(), got->second.end());
             }
         }
+        if (next.empty()) {
+            return levels;
+        }
+        std::sort(next.begin(), next.end());
+        levels.push_back(next);
+        level = std::move(next);
     }
-    resolveQueuedGroups(parsedData);
 }
 
 }  // namespace
 
+struct DatabaseLoader::State {
+    ParsedData parsedData;
+    std::unique_ptr<ThreadPool> ownedThreadPool;
+    ThreadPool& threadPool;
+};
+
+DatabaseLoader::DatabaseLoader(RuleDatabase& database) {
+    auto threadPool = std::make_unique<ThreadPool>();
+    ThreadPool& threadPoolRef = *threadPool;
+    m_state = std::make_unique<State>(State{ParsedData(database), std::move(threadPool), threadPoolRef});
+}
+
+DatabaseLoader::DatabaseLoader(RuleDatabase& database, ThreadPool& threadPool)
+    : m_state(std::make_unique<State>(State{ParsedData(database), nullptr, threadPool})) {}
+
+DatabaseLoader::~DatabaseLoader() = default;
+
+DatabaseStats DatabaseLoader::loadDatabase(const std::string& dirPath) {
+    ParsedData& parsedData = m_state->parsedData;
+    parsedData.stats = {0, 0, 0, 0};
+    readAllFiles(parsedData, dirPath, m_state->threadPool);
+    return parsedData.stats;
+}
+
+JsonParseResult DatabaseLoader::reloadGroup(DatabaseStats& stats, const std::string& path) {
+    auto result = rebuildGroup(stats, path);
+    // Drop the criteria that only the replaced tables, or a failed rebuild, still used
+    m_state->parsedData.interner->prune();
+    return result;
+}
+
+JsonParseResult DatabaseLoader::rebuildGroup(DatabaseStats& stats, const std::string& path) {
+    ParsedData& parsedData = m_state->parsedData;
+    stats = {0, 0, 0, 0};
+
+    QueuedGroup source;
+    auto result = readDocument(source, path);
+    if (result.code != JsonParseReturnCode::kSuccess) {
+        return result;
+    }
+    const std::string name = source.name;
+    auto existing = parsedData.groups.find(name);
+    if (existing != parsedData.groups.end() && existing->second.source.path != path) {
+        return {JsonParseReturnCode::kAlreadyDefined,
+                "Group \"" + name + "\" is already defined in " + existing->second.source.path};
+    }
+    for (const auto& [otherName, loadedGroup] : parsedData.groups) {
+        if (loadedGroup.source.path == path && otherName != name) {
+            return {JsonParseReturnCode::kInvalidValue,
+                    "Group \"" + otherName + "\" was renamed to \"" + name + "\", which requires a full reload"};
+        }
+    }
+
+    // Children keep their own files, so only the groups below this one are rebuilt, from the documents kept in memory
+    std::vector<std::vector<std::string>> levels;
+    if (existing != parsedData.groups.end()) {
+        levels = findDescendants(parsedData, name);
+    }
+    if (source.parentName) {
+        if (parsedData.groups.find(*source.parentName) == parsedData.groups.end() && *source.parentName != name) {
+            return {JsonParseReturnCode::kMissingKey, "Unknown parent \"" + *source.parentName + "\""};
+        }
+        bool circular = *source.parentName == name;
+        for (const auto& level : levels) {
+            circular = circular || std::find(level.begin(), level.end(), *source.parentName) != level.end();
+        }
+        if (circular) {
+            return {JsonParseReturnCode::kInvalidValue, "Parent \"" + *source.parentName + "\" is circular"};
+        }
+    }
+
+    // Build the reloaded group, then each level of descendants in parallel
+    std::unordered_map<std::string, BuiltGroup> builtGroups;
+    BuiltGroup& builtGroup = builtGroups[name];
+    const ParsedGroup* parsedParent =
+        source.parentName ? &parsedData.groups.at(*source.parentName).group : nullptr;
+    result = parseGroup(builtGroup, parsedData.database, *parsedData.interner, *source.document, name, parsedParent);
+    if (result.code != JsonParseReturnCode::kSuccess) {
+        return result;
+    }
+    for (const auto& level : levels) {
+        std::vector<BuiltGroup*> levelGroups;
+        for (const auto& childName : level) {
+            levelGroups.push_back(&builtGroups[childName]);
+        }
+        std::vector<JsonParseResult> results(level.size());
+        m_state->threadPool.parallelFor(level.size(), [&](const size_t i) {
+            const QueuedGroup& childSource = parsedData.groups.at(level[i]).source;
+            const ParsedGroup* childParent = &builtGroups.at(*childSource.parentName).group;
+            results[i] = parseGroup(*levelGroups[i], parsedData.database, *parsedData.interner,
+                                    *childSource.document, level[i], childParent);
+        });
+        for (size_t i = 0; i < level.size(); ++i) {
+            if (results[i].code != JsonParseReturnCode::kSuccess) {
+                const std::string& childPath = parsedData.groups.at(level[i]).source.path;
+                return {results[i].code, "Failed to rebuild " + childPath + ": " + results[i].errorMsg};
+            }
+        }
+    }
+
+    // Swap every affected table at once, removing categories that no longer exist
+    std::vector<RuleTableUpdate> updates;
+    for (auto& [groupName, group] : builtGroups) {
+        auto loaded = parsedData.groups.find(groupName);
+        if (loaded != parsedData.groups.end()) {
+            for (const auto& [category, table] : loaded->second.group.tables) {
+                if (group.group.tables.find(category) == group.group.tables.end()) {
+                    updates.push_back({groupName, category, nullptr});
+                }
+            }
+        } else {
+            for (const auto& [category, table] : group.group.tables) {
+                if (parsedData.database.getRuleTable(groupName, category) != nullptr) {
+                    return {JsonParseReturnCode::kAlreadyDefined,
+                            "Category \"" + category + "\" for group \"" + groupName + "\" is already defined"};
+                }
+            }
+        }
+        for (const auto& [category, table] : group.group.tables) {
+            updates.push_back({groupName, category, table});
+        }
+        stats.numTables += group.group.tables.size();
+        stats.numRules += group.numRules;
+        ++stats.numLoaded;
+    }
+    parsedData.database.updateRuleTables(updates);
+
+    for (auto& [groupName, group] : builtGroups) {
+        auto loaded = parsedData.groups.find(groupName);
+        if (loaded == parsedData.groups.end()) {
+            parsedData.groups.emplace(groupName, LoadedGroup{std::move(source), std::move(group.group)});
+        } else {
+            if (groupName == name) {
+                loaded->second.source = std::move(source);
+            }
+            loaded->second.group = std::move(group.group);
+        }
+    }
+    PLOG_INFO << "Successfully reloaded " << path << " and " << stats.numLoaded - 1 << " inheriting groups";
+    return JsonUtils::g_RESULT_SUCCESS;
+}
+
 JsonParseResult loadGroup(RuleDatabase& database, const std::string& path) {
     ParsedData parsedData{database};
-    return readGroup(parsedData, path, true);
+    QueuedGroup queuedGroup;
+    auto result = readDocument(queuedGroup, path);
+    if (result.code != JsonParseReturnCode::kSuccess) {
+        return result;
+    }
+    // A single group is loaded on its own, so its parent is ignored
+    BuiltGroup builtGroup;
+    result = parseGroup(builtGroup, database, *parsedData.interner, *queuedGroup.document, queuedGroup.name, nullptr);
+    if (result.code != JsonParseReturnCode::kSuccess) {
+        return result;
+    }
+    std::vector<RuleTableUpdate> updates;
+    result = commitGroup(parsedData, updates, queuedGroup, builtGroup);
+    database.updateRuleTables(updates);
+    return result;
 }
 
 DatabaseStats loadDatabase(RuleDatabase& database, const std::string& dirPath) {
-    ParsedData parsedData{database};
-    readAllFiles(parsedData, dirPath);
-    return parsedData.stats;
+    return DatabaseLoader(database).loadDatabase(dirPath);
+}
+
+DatabaseStats loadDatabase(RuleDatabase& database, const std::string& dirPath, ThreadPool& threadPool) {
+    return DatabaseLoader(database, threadPool).loadDatabase(dirPath);
 }
 
-}  // namespace Contextual::RuleParser
\ No newline at end of file
+}  // namespace Contextual::RuleParser
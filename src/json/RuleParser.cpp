@@ -45,7 +45,7 @@ const std::string g_DEFAULT_ID = "Id";
 JsonParseResult parseSpeechResponse(std::shared_ptr<Response>& response, const rapidjson::Value& value,
                                     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                                    const std::unique_ptr<FunctionTable>& functionTable) {
+                                    std::shared_ptr<ContextManager>& contextManager) {
     if (!value.IsArray()) {
         return {JsonParseReturnCode::kInvalidType, "Speech response value must be an array"};
     }
@@ -59,7 +59,7 @@ JsonParseResult parseSpeechResponse(std::shared_ptr<Response>& response, const r
         }
         std::vector<std::shared_ptr<SpeechToken>> speechLine;
         const std::string& lineStr = line.GetString();
-        auto result = SpeechTokenizer::tokenize(speechLine, lineStr, symbols, localSymbols, functionTable);
+        auto result = SpeechTokenizer::tokenize(speechLine, lineStr, symbols, localSymbols, contextManager);
         if (result.code != SpeechTokenizerReturnCode::kSuccess) {
             return {JsonParseReturnCode::kInvalidValue,
                     "Failed to parse speech line \"" + lineStr + "\": " + result.errorMsg};
@@ -264,7 +264,7 @@ JsonParseResult parseResponseObject(std::shared_ptr<Response>& response, StringT
                                     const rapidjson::Value& root, const DatabaseParser::ParsingType parsingType,
                                     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                                    const std::unique_ptr<FunctionTable>& functionTable) {
+                                    std::shared_ptr<ContextManager>& contextManager) {
     if (!root.IsObject()) {
         return {JsonParseReturnCode::kInvalidType, "Response must be a JSON object"};
     }
@@ -283,7 +283,7 @@ JsonParseResult parseResponseObject(std::shared_ptr<Response>& response, StringT
 
     if (type == g_RESPONSE_TEXT) {
         if (parsingType == DatabaseParser::ParsingType::kSpeechbank) {
-            return parseSpeechResponse(response, value, symbols, localSymbols, functionTable);
+            return parseSpeechResponse(response, value, symbols, localSymbols, contextManager);
         }
         return parseSimpleResponse(response, value);
     }
@@ -307,7 +307,7 @@ JsonParseResult parseResponse(std::shared_ptr<Response>& response, StringTable&
                               const rapidjson::Value& root, const DatabaseParser::ParsingType parsingType,
                               const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                               const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                              const std::unique_ptr<FunctionTable>& functionTable) {
+                              std::shared_ptr<ContextManager>& contextManager) {
     if (root.HasMember(g_KEY_RESPONSE)) {
         const auto& value = root[g_KEY_RESPONSE];
         if (!value.IsArray()) {
@@ -319,13 +319,13 @@ JsonParseResult parseResponse(std::shared_ptr<Response>& response, StringTable&
         if (value.Size() == 1) {
             // Single response
             return parseResponseObject(response, stringTable, value[0], parsingType, symbols, localSymbols,
-                                       functionTable);
+                                       contextManager);
         } else {
             std::vector<std::shared_ptr<Response>> responses;
             for (auto iter = value.Begin(); iter != value.End(); ++iter) {
                 std::shared_ptr<Response> item;
                 auto result =
-                    parseResponseObject(item, stringTable, *iter, parsingType, symbols, localSymbols, functionTable);
+                    parseResponseObject(item, stringTable, *iter, parsingType, symbols, localSymbols, contextManager);
                 if (result.code != JsonParseReturnCode::kSuccess) {
                     return result;
                 }
@@ -341,32 +341,32 @@ JsonParseResult parseResponse(std::shared_ptr<Response>& response, StringTable&
 
 }  // namespace
 
-JsonParseResult parseRule(StringTable& stringTable, std::shared_ptr<RuleEntry>& rule,
+JsonParseResult parseRule(StringTable& stringTable, CriterionInterner& interner, std::shared_ptr<RuleEntry>& rule,
                           std::unordered_map<std::string, RuleInfo>& namedRules, int& nextId,
                           const rapidjson::Value& root, const std::string& idPrefix,
                           const DatabaseParser::ParsingType parsingType,
                           const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
-                          const std::unique_ptr<FunctionTable>& functionTable) {
+                          std::shared_ptr<ContextManager>& contextManager) {
     if (!root.IsObject()) {
         return {JsonParseReturnCode::kInvalidType, "Rule must be a JSON object"};
     }
 
     int priority = 0;
     std::vector<std::shared_ptr<Criteria>> criteria;
-    auto result = CriteriaParser::parseCriteria(criteria, priority, stringTable, root, namedRules);
+    auto result = CriteriaParser::parseCriteria(criteria, interner, priority, stringTable, root, namedRules);
     if (result.code != JsonParseReturnCode::kSuccess) {
         return result;
     }
 
     // Reads local symbols from key "Symbols" if it exists
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>> localSymbols;
-    result = SymbolParser::parseSymbols(localSymbols, root, symbols, functionTable);
+    result = SymbolParser::parseSymbols(localSymbols, root, symbols, contextManager);
     if (result.code != JsonParseReturnCode::kSuccess) {
         return result;
     }
 
     std::shared_ptr<Response> response;
-    result = parseResponse(response, stringTable, root, parsingType, symbols, localSymbols, functionTable);
+    result = parseResponse(response, stringTable, root, parsingType, symbols, localSymbols, contextManager);
     if (result.code != JsonParseReturnCode::kSuccess) {
         return result;
     }
@@ -38,7 +38,7 @@ const std::string g_TYPE_UNKNOWN = "Unknown";
 JsonParseResult parseToken(std::shared_ptr<SymbolToken>& token, const rapidjson::Value& root,
                            const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                            const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-                           const std::unique_ptr<FunctionTable>& functionTable);
+                           std::shared_ptr<ContextManager>& contextManager);
 
 JsonParseResult parseBoolToken(std::shared_ptr<SymbolToken>& token, const rapidjson::Value& value) {
     if (!value.IsBool()) {
@@ -106,7 +106,7 @@ JsonParseResult parseContextToken(std::shared_ptr<SymbolToken>& token, const rap
 JsonParseResult parseFunctionToken(std::shared_ptr<SymbolToken>& token, const rapidjson::Value& value,
                                    const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                    const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-                                   const std::unique_ptr<FunctionTable>& functionTable) {
+                                   std::shared_ptr<ContextManager>& contextManager) {
     if (!value.IsObject()) {
         return {JsonParseReturnCode::kInvalidType,
                 "SymbolToken of type \"" + g_TYPE_FUNCTION + "\" must have an object value"};
@@ -130,7 +130,7 @@ JsonParseResult parseFunctionToken(std::shared_ptr<SymbolToken>& token, const ra
     args.reserve(argValue.Size());
     for (auto iter = argValue.Begin(); iter != argValue.End(); ++iter) {
         std::shared_ptr<SymbolToken> arg;
-        result = parseToken(arg, *iter, symbols, otherSymbols, functionTable);
+        result = parseToken(arg, *iter, symbols, otherSymbols, contextManager);
         if (result.code != JsonParseReturnCode::kSuccess) {
             return result;
         }
@@ -138,6 +138,7 @@ JsonParseResult parseFunctionToken(std::shared_ptr<SymbolToken>& token, const ra
     }
 
     // Check that function exists
+    const std::unique_ptr<FunctionTable>& functionTable = contextManager->getFunctionTable();
     const auto& sig = functionTable->getSignature(name);
     if (sig == nullptr) {
         return {JsonParseReturnCode::kInvalidFunction, "Function \"" + name + "\" does not exist"};
@@ -162,14 +163,17 @@ JsonParseResult parseFunctionToken(std::shared_ptr<SymbolToken>& token, const ra
         return {JsonParseReturnCode::kInvalidFunction, "Invalid arguments for function \"" + name + "\": " + argList};
     }
 
-    token = std::make_shared<TokenFunction>(std::move(name), std::move(args));
+    token = functionTable->fold(*sig, args, contextManager);
+    if (token == nullptr) {
+        token = std::make_shared<TokenFunction>(std::move(name), std::move(args), sig.get());
+    }
     return JsonUtils::g_RESULT_SUCCESS;
 }
 
 JsonParseResult parseListToken(std::shared_ptr<SymbolToken>& token, const rapidjson::Value& value,
                                const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-                               const std::unique_ptr<FunctionTable>& functionTable) {
+                               std::shared_ptr<ContextManager>& contextManager) {
     if (!value.IsArray()) {
         return {JsonParseReturnCode::kInvalidType,
                 "SymbolToken of type \"" + g_TYPE_LIST + "\" must have an array value"};
@@ -181,7 +185,7 @@ JsonParseResult parseListToken(std::shared_ptr<SymbolToken>& token, const rapidj
     items.reserve(value.Size());
     for (auto iter = value.Begin(); iter != value.End(); ++iter) {
         std::shared_ptr<SymbolToken> item;
-        auto result = parseToken(item, *iter, symbols, otherSymbols, functionTable);
+        auto result = parseToken(item, *iter, symbols, otherSymbols, contextManager);
         if (result.code != JsonParseReturnCode::kSuccess) {
             return result;
         }
@@ -226,7 +230,7 @@ JsonParseResult parseToken(
     std::shared_ptr<SymbolToken>& token, const rapidjson::Value& root,
     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
     const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-    const std::unique_ptr<FunctionTable>& functionTable) {
+    std::shared_ptr<ContextManager>& contextManager) {
     if (!root.IsObject()) {
         return {JsonParseReturnCode::kInvalidType, "SymbolToken must be a JSON object"};
     }
@@ -254,9 +258,9 @@ JsonParseResult parseToken(
     } else if (type == g_TYPE_CONTEXT) {
         result = parseContextToken(token, value);
     } else if (type == g_TYPE_FUNCTION) {
-        result = parseFunctionToken(token, value, symbols, otherSymbols, functionTable);
+        result = parseFunctionToken(token, value, symbols, otherSymbols, contextManager);
     } else if (type == g_TYPE_LIST) {
-        result = parseListToken(token, value, symbols, otherSymbols, functionTable);
+        result = parseListToken(token, value, symbols, otherSymbols, contextManager);
     } else if (type == g_TYPE_SYMBOL) {
         result = parseSymbolToken(token, value, symbols, otherSymbols);
     } else {
@@ -268,7 +272,7 @@ JsonParseResult parseToken(
 JsonParseResult parseSymbol(
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols, const rapidjson::Value& root,
     const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-    const std::unique_ptr<FunctionTable>& functionTable) {
+    std::shared_ptr<ContextManager>& contextManager) {
     if (!root.IsObject()) {
         return {JsonParseReturnCode::kInvalidType, "Symbol must be a JSON object"};
     }
@@ -286,7 +290,7 @@ JsonParseResult parseSymbol(
     }
 
     std::shared_ptr<SymbolToken> token;
-    result = parseToken(token, root, symbols, otherSymbols, functionTable);
+    result = parseToken(token, root, symbols, otherSymbols, contextManager);
     if (result.code != JsonParseReturnCode::kSuccess) {
         return result;
     }
@@ -324,14 +328,14 @@ std::string tokenTypeToString(const TokenType type) {
 JsonParseResult parseSymbols(
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols, const rapidjson::Value& root,
     const std::optional<std::unordered_map<std::string, std::shared_ptr<SymbolToken>>>& otherSymbols,
-    const std::unique_ptr<FunctionTable>& functionTable) {
+    std::shared_ptr<ContextManager>& contextManager) {
     if (root.HasMember(g_KEY_SYMBOLS)) {
         const auto& value = root[g_KEY_SYMBOLS];
         if (!value.IsArray()) {
             return {JsonParseReturnCode::kInvalidType, "Key \"" + g_KEY_SYMBOLS + "\" must be an array"};
         }
         for (auto iter = value.Begin(); iter != value.End(); ++iter) {
-            auto result = parseSymbol(symbols, *iter, otherSymbols, functionTable);
+            auto result = parseSymbol(symbols, *iter, otherSymbols, contextManager);
             if (result.code != JsonParseReturnCode::kSuccess) {
                 return result;
             }
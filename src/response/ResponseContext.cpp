@@ -1,12 +1,25 @@
 #include "ResponseContext.h"
 
+#include "ContextIds.h"
+
 namespace Contextual {
 
 ResponseContext::ResponseContext(std::string table, std::string key)
-    : m_table(std::move(table)), m_key(std::move(key)) {}
+    : m_table(std::move(table)),
+      m_key(std::move(key)),
+      m_tableId(ContextIds::getTableId(m_table)),
+      m_keyId(ContextIds::getKeyId(m_key)) {}
 
 ResponseType ResponseContext::getType() const {
     return ResponseType::kContext;
 }
 
+const std::string& ResponseContext::getTable() const {
+    return m_table;
+}
+
+const std::string& ResponseContext::getKey() const {
+    return m_key;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -6,13 +6,17 @@ ResponseContextAdd::ResponseContextAdd(std::string table, std::string key, float
     : ResponseContext(std::move(table), std::move(key)), m_value(value) {}
 
 void ResponseContextAdd::execute(DatabaseQuery& query) {
-    const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(m_table);
+    ContextTable* contextTable = query.findContextTable(m_tableId);
     if (contextTable != nullptr) {
-        std::optional<float> numValue = contextTable->getFloat(m_key);
+        std::optional<float> numValue = contextTable->getFloat(m_keyId);
         if (numValue) {
-            contextTable->set(m_key, *numValue + m_value);
+            contextTable->setRawValue(m_keyId, *numValue + m_value, FactType::kNumber);
         }
     }
 }
 
+float ResponseContextAdd::getValue() const {
+    return m_value;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -6,11 +6,11 @@ ResponseContextInvert::ResponseContextInvert(std::string table, std::string key)
     : ResponseContext(std::move(table), std::move(key)) {}
 
 void ResponseContextInvert::execute(DatabaseQuery& query) {
-    const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(m_table);
+    ContextTable* contextTable = query.findContextTable(m_tableId);
     if (contextTable != nullptr) {
-        std::optional<bool> boolValue = contextTable->getBool(m_key);
+        std::optional<bool> boolValue = contextTable->getBool(m_keyId);
         if (boolValue) {
-            contextTable->set(m_key, !(*boolValue));
+            contextTable->setRawValue(m_keyId, static_cast<float>(!(*boolValue)), FactType::kBoolean);
         }
     }
 }
@@ -1,35 +1,47 @@
 #include "ResponseContextSetDynamic.h"
 
+#include "ContextIds.h"
+
 namespace Contextual {
 
 ResponseContextSetDynamic::ResponseContextSetDynamic(std::string table, std::string key, std::string otherTable,
                                                      std::string otherKey)
     : ResponseContext(std::move(table), std::move(key)),
       m_otherTable(std::move(otherTable)),
-      m_otherKey(std::move(otherKey)) {}
+      m_otherKey(std::move(otherKey)),
+      m_otherTableId(ContextIds::getTableId(m_otherTable)),
+      m_otherKeyId(ContextIds::getKeyId(m_otherKey)) {}
 
 void ResponseContextSetDynamic::execute(DatabaseQuery& query) {
-    const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(m_table);
+    ContextTable* contextTable = query.findContextTable(m_tableId);
     if (contextTable == nullptr) {
         return;
     }
-    const std::shared_ptr<ContextTable>& otherContextTable = query.getContextTable(m_otherTable);
+    ContextTable* otherContextTable = query.findContextTable(m_otherTableId);
     if (otherContextTable == nullptr) {
         return;
     }
-    FactType type = otherContextTable->getType(m_otherKey);
+    FactType type = otherContextTable->getType(m_otherKeyId);
     if (type == FactType::kList) {
-        const auto& list = otherContextTable->getList(m_otherKey);
-        bool isStringList = otherContextTable->isStringList(m_otherKey);
-        if (list == nullptr) {
-            contextTable->set(m_key, std::make_unique<std::unordered_set<int>>(std::move(*list)), isStringList);
+        const FactList* list = otherContextTable->getList(m_otherKeyId);
+        bool isStringList = otherContextTable->isStringList(m_otherKeyId);
+        if (list != nullptr) {
+            contextTable->set(m_keyId, *list, isStringList);
         }
     } else {
-        std::optional<float> rawValue = otherContextTable->getRawValue(m_otherKey);
+        std::optional<float> rawValue = otherContextTable->getRawValue(m_otherKeyId);
         if (rawValue) {
-            contextTable->setRawValue(m_key, *rawValue, type);
+            contextTable->setRawValue(m_keyId, *rawValue, type);
         }
     }
 }
 
+const std::string& ResponseContextSetDynamic::getOtherTable() const {
+    return m_otherTable;
+}
+
+const std::string& ResponseContextSetDynamic::getOtherKey() const {
+    return m_otherKey;
+}
+
 }  // namespace Contextual
\ No newline at end of file
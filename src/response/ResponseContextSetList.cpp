@@ -4,13 +4,24 @@ namespace Contextual {
 
 ResponseContextSetList::ResponseContextSetList(std::string table, std::string key, std::unordered_set<int> value,
                                                bool isStringList)
+    : ResponseContext(std::move(table), std::move(key)), m_value(value), m_isStringList(isStringList) {}
+
+ResponseContextSetList::ResponseContextSetList(std::string table, std::string key, FactList value, bool isStringList)
     : ResponseContext(std::move(table), std::move(key)), m_value(std::move(value)), m_isStringList(isStringList) {}
 
 void ResponseContextSetList::execute(DatabaseQuery& query) {
-    const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(m_table);
+    ContextTable* contextTable = query.findContextTable(m_tableId);
     if (contextTable != nullptr) {
-        contextTable->set(m_key, std::make_unique<std::unordered_set<int>>(m_value), m_isStringList);
+        contextTable->set(m_keyId, m_value, m_isStringList);
     }
 }
 
+const FactList& ResponseContextSetList::getValue() const {
+    return m_value;
+}
+
+bool ResponseContextSetList::isStringList() const {
+    return m_isStringList;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -6,10 +6,18 @@ ResponseContextSetStatic::ResponseContextSetStatic(std::string table, std::strin
     : ResponseContext(std::move(table), std::move(key)), m_type(type), m_value(value) {}
 
 void ResponseContextSetStatic::execute(DatabaseQuery& query) {
-    const std::shared_ptr<ContextTable>& contextTable = query.getContextTable(m_table);
+    ContextTable* contextTable = query.findContextTable(m_tableId);
     if (contextTable != nullptr) {
-        contextTable->setRawValue(m_key, m_value, m_type);
+        contextTable->setRawValue(m_keyId, m_value, m_type);
     }
 }
 
+FactType ResponseContextSetStatic::getFactType() const {
+    return m_type;
+}
+
+float ResponseContextSetStatic::getValue() const {
+    return m_value;
+}
+
 }  // namespace Contextual
\ No newline at end of file
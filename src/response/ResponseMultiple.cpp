@@ -5,7 +5,7 @@ namespace Contextual {
 ResponseMultiple::ResponseMultiple(std::vector<std::shared_ptr<Response>> responses)
     : m_responses(std::move(responses)) {}
 
-std::vector<std::shared_ptr<Response>> ResponseMultiple::getResponses() const {
+const std::vector<std::shared_ptr<Response>>& ResponseMultiple::getResponses() const {
     return m_responses;
 }
 
@@ -18,6 +18,14 @@ const std::string& ResponseSimple::getRandomOption() const {
     return m_options[index];
 }
 
+const std::string& ResponseSimple::getRandomOption(Random& random) const {
+    if (m_options.empty()) {
+        return g_EMPTY_STRING;
+    }
+    size_t index = random.randUInt(0, m_options.size() - 1);
+    return m_options[index];
+}
+
 const std::vector<std::string>& ResponseSimple::getOptions() const {
     return m_options;
 }
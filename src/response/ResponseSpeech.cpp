@@ -9,7 +9,9 @@ const std::vector<std::shared_ptr<SpeechToken>> g_EMPTY_LINE;
 }
 
 ResponseSpeech::ResponseSpeech(std::vector<std::vector<std::shared_ptr<SpeechToken>>> speechLines)
-    : m_speechLines(std::move(speechLines)) {}
+    : m_speechLines(std::move(speechLines)) {
+    m_program.compile(m_speechLines);
+}
 
 const std::vector<std::shared_ptr<SpeechToken>>& ResponseSpeech::getRandomLine() const {
     if (m_speechLines.empty()) {
@@ -21,8 +23,24 @@ const std::vector<std::shared_ptr<SpeechToken>>& ResponseSpeech::getRandomLine()
     return m_speechLines[index];
 }
 
+const std::vector<std::shared_ptr<SpeechToken>>& ResponseSpeech::getRandomLine(Random& random) const {
+    if (m_speechLines.empty()) {
+        return g_EMPTY_LINE;
+    }
+    size_t index = random.randUInt(0, m_speechLines.size() - 1);
+    return m_speechLines[index];
+}
+
 ResponseType ResponseSpeech::getType() const {
     return ResponseType::kSpeech;
 }
 
+const std::vector<std::vector<std::shared_ptr<SpeechToken>>>& ResponseSpeech::getSpeechLines() const {
+    return m_speechLines;
+}
+
+const SpeechProgram& ResponseSpeech::getProgram() const {
+    return m_program;
+}
+
 }  // namespace Contextual
@@ -12,6 +12,7 @@
 #include "ResponseMultiple.h"
 #include "SymbolToken.h"
 #include "TokenList.h"
+#include "TokenString.h"
 
 namespace Contextual::SpeechGenerator {
 
@@ -131,11 +132,17 @@ std::string helper(const int num) {
 SpeechGeneratorReturnCode performSpeechResponse(std::vector<std::shared_ptr<TextToken>>& speechLine,
                                                 std::shared_ptr<ResponseSpeech>& speechResponse, DatabaseQuery& query,
                                                 const std::shared_ptr<Response>& response) {
+    TokenSpeechSink sink(speechLine);
+    return performSpeechResponse(sink, speechResponse, query, response);
+}
+
+SpeechGeneratorReturnCode performSpeechResponse(SpeechSink& sink, std::shared_ptr<ResponseSpeech>& speechResponse,
+                                                DatabaseQuery& query, const std::shared_ptr<Response>& response) {
     // Look for speech responses; there should only be one maximum
     // There should never be a nested multiple response, so it is either top level or in a multiple response
     if (response->getType() == ResponseType::kSpeech) {
         speechResponse = std::static_pointer_cast<ResponseSpeech>(response);
-        if(generateLineFromResponse(speechLine, query, speechResponse)) {
+        if (generateLineFromResponse(sink, query, speechResponse)) {
             return SpeechGeneratorReturnCode::kSuccess;
         }
         return SpeechGeneratorReturnCode::kGenerationError;
@@ -145,14 +152,14 @@ SpeechGeneratorReturnCode performSpeechResponse(std::vector<std::shared_ptr<Text
         const auto& multipleResponse = std::static_pointer_cast<ResponseMultiple>(response);
         for (const auto& responseItem : multipleResponse->getResponses()) {
             if (responseItem->getType() == ResponseType::kContext) {
-                const auto& contextResponse = std::static_pointer_cast<ResponseContext>(response);
+                const auto& contextResponse = std::static_pointer_cast<ResponseContext>(responseItem);
                 contextResponse->execute(query);
             }
             if (responseItem->getType() == ResponseType::kSpeech) {
                 // Only execute the first speech response
                 if (speechResponse == nullptr) {
                     speechResponse = std::static_pointer_cast<ResponseSpeech>(responseItem);
-                    if(generateLineFromResponse(speechLine, query, speechResponse)) {
+                    if (generateLineFromResponse(sink, query, speechResponse)) {
                         returnCode = SpeechGeneratorReturnCode::kSuccess;
                     } else {
                         returnCode = SpeechGeneratorReturnCode::kGenerationError;
@@ -167,25 +174,107 @@ SpeechGeneratorReturnCode performSpeechResponse(std::vector<std::shared_ptr<Text
 
 bool generateLineFromResponse(std::vector<std::shared_ptr<TextToken>>& speechLine, DatabaseQuery& query,
                               const std::shared_ptr<ResponseSpeech>& speechResponse) {
+    TokenSpeechSink sink(speechLine);
+    return generateLineFromResponse(sink, query, speechResponse);
+}
+
+bool generateLineFromResponse(SpeechSink& sink, DatabaseQuery& query,
+                              const std::shared_ptr<ResponseSpeech>& speechResponse) {
+    const SpeechProgram& program = speechResponse->getProgram();
+    if (program.getNumLines() == 0) {
+        return false;
+    }
     int attempts = 0;
     while (++attempts < g_MAX_SPEECH_ATTEMPTS) {
-        bool result = generateLineFromTokens(speechLine, query, speechResponse->getRandomLine());
-        if (result) {
+        // Same choice as ResponseSpeech::getRandomLine, so both paths pick the same line for the same seed
+        size_t lineIndex = query.getRandom().randUInt(0, program.getNumLines() - 1);
+        if (generateLineFromProgram(sink, query, program, lineIndex)) {
             return true;
         }
     }
     return false;
 }
 
+bool generateLineFromProgram(SpeechSink& sink, DatabaseQuery& query, const SpeechProgram& program,
+                             const size_t lineIndex) {
+    const SpeechProgram::Line& line = program.getLine(lineIndex);
+    query.clearPrevChoices();
+    // Must have text to print properly
+    if (!line.hasText) {
+        return false;
+    }
+    // List options already chosen in this line, by list slot. Lines are short, so a scan beats a hash set.
+    std::vector<std::pair<uint32_t, std::string>> chosenListOptions;
+    sink.begin();
+    for (uint32_t i = line.begin; i < line.end; ++i) {
+        const SpeechProgram::Instruction& instruction = program.getInstruction(i);
+        switch (instruction.op) {
+            case SpeechProgram::Op::kText:
+                sink.writeText(program.getText(instruction));
+                break;
+            case SpeechProgram::Op::kFormat:
+                sink.writeFormat(program.getFormat(instruction));
+                break;
+            case SpeechProgram::Op::kSymbol: {
+                std::optional<std::string> nextTokenStr = program.getSymbol(instruction).evaluate(query);
+                if (!nextTokenStr) {
+                    sink.rollback();
+                    return false;
+                }
+                sink.writeText(*nextTokenStr);
+                break;
+            }
+            case SpeechProgram::Op::kList: {
+                // Attempt to sample without replacement; if this fails, then continue with the last choice
+                const auto& listToken = static_cast<const TokenList&>(program.getSymbol(instruction));
+                std::optional<std::string> nextTokenStr;
+                size_t index;
+                int attempts = 0;
+                while (++attempts <= g_MAX_LIST_ATTEMPTS) {
+                    nextTokenStr = listToken.evaluateList(query, index);
+                    const auto isChosen = [&](const std::pair<uint32_t, std::string>& option) {
+                        return option.first == instruction.arg && option.second == *nextTokenStr;
+                    };
+                    if (nextTokenStr &&
+                        std::none_of(chosenListOptions.begin(), chosenListOptions.end(), isChosen)) {
+                        chosenListOptions.emplace_back(instruction.arg, *nextTokenStr);
+                        break;
+                    }
+                }
+                if (!nextTokenStr) {
+                    sink.rollback();
+                    return false;
+                }
+                sink.writeText(*nextTokenStr);
+                query.addPrevChoice(index, std::move(*nextTokenStr));
+                break;
+            }
+        }
+    }
+    return true;
+}
+
 bool generateLineFromTokens(std::vector<std::shared_ptr<TextToken>>& speechLine, DatabaseQuery& query,
                             const std::vector<std::shared_ptr<SpeechToken>>& speechTokens) {
+    TokenSpeechSink sink(speechLine);
+    return generateLineFromTokens(sink, query, speechTokens);
+}
+
+bool generateLineFromTokens(SpeechSink& sink, DatabaseQuery& query,
+                            const std::vector<std::shared_ptr<SpeechToken>>& speechTokens) {
     bool hasText = false;
     std::unordered_map<std::shared_ptr<SpeechToken>, std::unordered_set<std::string>> chosenListOptions;
     query.clearPrevChoices();
+    sink.begin();
     for (const auto& token : speechTokens) {
         if (token->isSymbolToken()) {
             hasText = true;
             const auto& symbolToken = std::static_pointer_cast<SymbolToken>(token);
+            if (symbolToken->getType() == TokenType::kString) {
+                // Literal text is written as is, without copying it out of the token first
+                sink.writeText(std::static_pointer_cast<TokenString>(symbolToken)->getValue());
+                continue;
+            }
             std::optional<std::string> nextTokenStr;
             size_t index;  // Used only for list tokens
 
@@ -210,27 +299,40 @@ bool generateLineFromTokens(std::vector<std::shared_ptr<TextToken>>& speechLine,
             }
 
             if (nextTokenStr) {
+                sink.writeText(*nextTokenStr);
                 if (symbolToken->getType() == TokenType::kList) {
-                    query.addPrevChoice(index, *nextTokenStr);
+                    query.addPrevChoice(index, std::move(*nextTokenStr));
                 }
-                speechLine.push_back(std::make_shared<TextLiteral>(std::move(*nextTokenStr)));
             } else {
+                sink.rollback();
                 return false;
             }
         } else {
             const auto& textToken = std::static_pointer_cast<TextToken>(token);
-            speechLine.push_back(textToken);
+            if (textToken->isLiteral()) {
+                sink.writeText(std::static_pointer_cast<TextLiteral>(textToken)->value);
+            } else {
+                sink.writeFormat(textToken);
+            }
         }
     }
     // Must have text to print properly
     if (!hasText) {
+        sink.rollback();
         return false;
     }
     return true;
 }
 
 std::string getRawSpeechLine(const std::vector<std::shared_ptr<TextToken>>& speechLine) {
+    size_t size = 0;
+    for (const auto& textToken : speechLine) {
+        if (textToken->isLiteral()) {
+            size += std::static_pointer_cast<TextLiteral>(textToken)->value.size();
+        }
+    }
     std::string result;
+    result.reserve(size);
     for (const auto& textToken : speechLine) {
         if (textToken->isLiteral()) {
             const auto& textLiteral = std::static_pointer_cast<TextLiteral>(textToken);
@@ -0,0 +1,110 @@
+#include "SpeechProgram.h"
+
+#include <algorithm>
+
+#include "SpeechGenerator.h"
+#include "TokenFloat.h"
+#include "TokenInt.h"
+#include "TokenString.h"
+
+namespace Contextual {
+
+void SpeechProgram::compile(const std::vector<std::vector<std::shared_ptr<SpeechToken>>>& speechLines) {
+    m_instructions.clear();
+    m_lines.clear();
+    m_text.clear();
+    m_formats.clear();
+    m_symbols.clear();
+    m_lines.reserve(speechLines.size());
+
+    std::vector<const SpeechToken*> lists;
+    for (const auto& speechLine : speechLines) {
+        Line& line = m_lines.emplace_back();
+        line.begin = static_cast<uint32_t>(m_instructions.size());
+        lists.clear();
+        for (const auto& token : speechLine) {
+            if (!token->isSymbolToken()) {
+                const auto& textToken = std::static_pointer_cast<TextToken>(token);
+                if (textToken->isLiteral()) {
+                    appendText(std::static_pointer_cast<TextLiteral>(textToken)->value);
+                } else {
+                    m_instructions.push_back({Op::kFormat, static_cast<uint32_t>(m_formats.size()), 0});
+                    m_formats.push_back(textToken);
+                }
+                continue;
+            }
+
+            line.hasText = true;
+            const auto& symbolToken = std::static_pointer_cast<SymbolToken>(token);
+            switch (symbolToken->getType()) {
+                // Literals always evaluate to the same text, so they go straight into the pool
+                case TokenType::kString:
+                    appendText(std::static_pointer_cast<TokenString>(symbolToken)->getValue());
+                    break;
+                case TokenType::kInt:
+                    appendText(
+                        SpeechGenerator::integerToWord(std::static_pointer_cast<TokenInt>(symbolToken)->getValue()));
+                    break;
+                case TokenType::kFloat:
+                    appendText(SpeechGenerator::integerToWord(
+                        static_cast<int>(std::static_pointer_cast<TokenFloat>(symbolToken)->getValue())));
+                    break;
+                case TokenType::kList: {
+                    // Each occurrence of the same list shares a slot, so it does not repeat an option
+                    auto got = std::find(lists.begin(), lists.end(), token.get());
+                    const auto slot = static_cast<uint32_t>(got - lists.begin());
+                    if (got == lists.end()) {
+                        lists.push_back(token.get());
+                    }
+                    m_instructions.push_back({Op::kList, static_cast<uint32_t>(m_symbols.size()), slot});
+                    m_symbols.push_back(symbolToken);
+                    break;
+                }
+                default:
+                    m_instructions.push_back({Op::kSymbol, static_cast<uint32_t>(m_symbols.size()), 0});
+                    m_symbols.push_back(symbolToken);
+                    break;
+            }
+        }
+        line.end = static_cast<uint32_t>(m_instructions.size());
+        line.numLists = static_cast<uint32_t>(lists.size());
+    }
+}
+
+size_t SpeechProgram::getNumLines() const {
+    return m_lines.size();
+}
+
+const SpeechProgram::Line& SpeechProgram::getLine(const size_t lineIndex) const {
+    return m_lines[lineIndex];
+}
+
+const SpeechProgram::Instruction& SpeechProgram::getInstruction(const size_t instructionIndex) const {
+    return m_instructions[instructionIndex];
+}
+
+std::string_view SpeechProgram::getText(const Instruction& instruction) const {
+    return std::string_view(m_text).substr(instruction.index, instruction.arg);
+}
+
+const std::shared_ptr<TextToken>& SpeechProgram::getFormat(const Instruction& instruction) const {
+    return m_formats[instruction.index];
+}
+
+const SymbolToken& SpeechProgram::getSymbol(const Instruction& instruction) const {
+    return *m_symbols[instruction.index];
+}
+
+void SpeechProgram::appendText(const std::string_view text) {
+    // Extend the previous span when the text directly follows it in the same line
+    const uint32_t lineBegin = m_lines.back().begin;
+    if (m_instructions.size() > lineBegin && m_instructions.back().op == Op::kText &&
+        m_instructions.back().index + m_instructions.back().arg == m_text.size()) {
+        m_instructions.back().arg += static_cast<uint32_t>(text.size());
+    } else {
+        m_instructions.push_back({Op::kText, static_cast<uint32_t>(m_text.size()), static_cast<uint32_t>(text.size())});
+    }
+    m_text.append(text);
+}
+
+}  // namespace Contextual
@@ -0,0 +1,39 @@
+#include "SpeechSink.h"
+
+namespace Contextual {
+
+StringSpeechSink::StringSpeechSink(std::string& out) : m_out(out), m_begin(out.size()) {}
+
+void StringSpeechSink::begin() {
+    m_begin = m_out.size();
+}
+
+void StringSpeechSink::writeText(const std::string_view text) {
+    m_out.append(text);
+}
+
+void StringSpeechSink::writeFormat(const std::shared_ptr<TextToken>& /*format*/) {}
+
+void StringSpeechSink::rollback() {
+    m_out.resize(m_begin);
+}
+
+TokenSpeechSink::TokenSpeechSink(std::vector<std::shared_ptr<TextToken>>& out) : m_out(out), m_begin(out.size()) {}
+
+void TokenSpeechSink::begin() {
+    m_begin = m_out.size();
+}
+
+void TokenSpeechSink::writeText(const std::string_view text) {
+    m_out.push_back(std::make_shared<TextLiteral>(std::string(text)));
+}
+
+void TokenSpeechSink::writeFormat(const std::shared_ptr<TextToken>& format) {
+    m_out.push_back(format);
+}
+
+void TokenSpeechSink::rollback() {
+    m_out.resize(m_begin);
+}
+
+}  // namespace Contextual
@@ -1,8 +1,10 @@
 #include "SpeechTokenizer.h"
 
+#include <optional>
 #include <stdexcept>
 #include <vector>
 
+#include "SpeechGenerator.h"
 #include "SpeechToken.h"
 #include "SymbolParser.h"
 #include "TextToken.h"
@@ -69,7 +71,7 @@ SpeechTokenizerResult tokenizeSymbol(int& index, std::vector<std::shared_ptr<Spe
                                      const std::string& text,
                                      const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                      const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                                     const std::unique_ptr<FunctionTable>& functionTable);
+                                     std::shared_ptr<ContextManager>& contextManager);
 
 SpeechTokenizerResult tokenizePause(int& index, std::vector<std::shared_ptr<SpeechToken>>& tokens,
                                     const std::string& text) {
@@ -208,11 +210,12 @@ SpeechTokenizerResult tokenizeFunction(
     int& index, std::vector<std::shared_ptr<SpeechToken>>& tokens, const std::string& text, std::string functionName,
     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
     const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-    const std::unique_ptr<FunctionTable>& functionTable) {
+    std::shared_ptr<ContextManager>& contextManager) {
     if (functionName.empty()) {
         return {SpeechTokenizerReturnCode::kInvalidSyntax, "Function name cannot be empty"};
     }
     // Check that function exists
+    const std::unique_ptr<FunctionTable>& functionTable = contextManager->getFunctionTable();
     const auto& sig = functionTable->getSignature(functionName);
     if (sig == nullptr) {
         return {SpeechTokenizerReturnCode::kInvalidFunction, "Function \"" + functionName + "\" does not exist"};
@@ -244,7 +247,7 @@ SpeechTokenizerResult tokenizeFunction(
             }
             finishedItem = true;
         } else if (c == g_SYMBOL_START) {
-            auto result = tokenizeSymbol(index, args, text, symbols, localSymbols, functionTable);
+            auto result = tokenizeSymbol(index, args, text, symbols, localSymbols, contextManager);
             if (result.code != SpeechTokenizerReturnCode::kSuccess) {
                 return result;
             }
@@ -294,7 +297,11 @@ SpeechTokenizerResult tokenizeFunction(
         return {SpeechTokenizerReturnCode::kInvalidFunction,
                 "Invalid arguments for function \"" + functionName + "\": " + argList};
     }
-    tokens.push_back(std::make_shared<TokenFunction>(std::move(functionName), std::move(symbolArgs)));
+    if (std::shared_ptr<SymbolToken> folded = functionTable->fold(*sig, symbolArgs, contextManager)) {
+        tokens.push_back(std::move(folded));
+        return g_RESULT_SUCCESS;
+    }
+    tokens.push_back(std::make_shared<TokenFunction>(std::move(functionName), std::move(symbolArgs), sig.get()));
     return g_RESULT_SUCCESS;
 }
 
@@ -302,7 +309,7 @@ SpeechTokenizerResult tokenizeSymbol(int& index, std::vector<std::shared_ptr<Spe
                                      const std::string& text,
                                      const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                      const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                                     const std::unique_ptr<FunctionTable>& functionTable) {
+                                     std::shared_ptr<ContextManager>& contextManager) {
     std::string symbolName;
     ++index;
     while (index < text.size()) {
@@ -312,7 +319,7 @@ SpeechTokenizerResult tokenizeSymbol(int& index, std::vector<std::shared_ptr<Spe
             ++index;
         } else if (c == g_ARGS_START) {
             // It's a function!
-            return tokenizeFunction(index, tokens, text, std::move(symbolName), symbols, localSymbols, functionTable);
+            return tokenizeFunction(index, tokens, text, std::move(symbolName), symbols, localSymbols, contextManager);
         } else {
             break;
         }
@@ -499,12 +506,59 @@ SpeechTokenizerResult validate(const std::vector<std::shared_ptr<SpeechToken>>&
     return g_RESULT_SUCCESS;
 }
 
+// Returns the text a constant symbol always evaluates to, or nullopt if it depends on the query
+std::optional<std::string> getLiteralText(const std::shared_ptr<SpeechToken>& token) {
+    if (!token->isSymbolToken()) {
+        return std::nullopt;
+    }
+    const auto& symbolToken = std::static_pointer_cast<SymbolToken>(token);
+    if (symbolToken->getType() == TokenType::kString) {
+        return std::static_pointer_cast<TokenString>(symbolToken)->getValue();
+    }
+    if (symbolToken->getType() == TokenType::kInt) {
+        return SpeechGenerator::integerToWord(std::static_pointer_cast<TokenInt>(symbolToken)->getValue());
+    }
+    if (symbolToken->getType() == TokenType::kFloat) {
+        const float value = std::static_pointer_cast<TokenFloat>(symbolToken)->getValue();
+        return SpeechGenerator::integerToWord(static_cast<int>(value));
+    }
+    return std::nullopt;
+}
+
+// Merge each run of adjacent constant symbols, such as literal text around a folded function, into one string token
+void spliceLiterals(std::vector<std::shared_ptr<SpeechToken>>& tokens) {
+    std::vector<std::shared_ptr<SpeechToken>> spliced;
+    spliced.reserve(tokens.size());
+    size_t index = 0;
+    while (index < tokens.size()) {
+        std::optional<std::string> text = getLiteralText(tokens[index]);
+        size_t end = index + 1;
+        if (text) {
+            while (end < tokens.size()) {
+                std::optional<std::string> nextText = getLiteralText(tokens[end]);
+                if (!nextText) {
+                    break;
+                }
+                *text += *nextText;
+                ++end;
+            }
+        }
+        if (end - index > 1) {
+            spliced.push_back(std::make_shared<TokenString>(std::move(*text)));
+        } else {
+            spliced.push_back(std::move(tokens[index]));
+        }
+        index = end;
+    }
+    tokens = std::move(spliced);
+}
+
 }  // namespace
 
 SpeechTokenizerResult tokenize(std::vector<std::shared_ptr<SpeechToken>>& tokens, const std::string& text,
                                const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& symbols,
                                const std::unordered_map<std::string, std::shared_ptr<SymbolToken>>& localSymbols,
-                               const std::unique_ptr<FunctionTable>& functionTable) {
+                               std::shared_ptr<ContextManager>& contextManager) {
     std::string nextString;
     int index = 0;
     int numStars = 0;
@@ -559,7 +613,7 @@ SpeechTokenizerResult tokenize(std::vector<std::shared_ptr<SpeechToken>>& tokens
             }
         } else if (c == g_SYMBOL_START) {
             finishStringToken(nextString, tokens);
-            auto result = tokenizeSymbol(index, tokens, text, symbols, localSymbols, functionTable);
+            auto result = tokenizeSymbol(index, tokens, text, symbols, localSymbols, contextManager);
             if (result.code != SpeechTokenizerReturnCode::kSuccess) {
                 return result;
             }
@@ -602,7 +656,12 @@ SpeechTokenizerResult tokenize(std::vector<std::shared_ptr<SpeechToken>>& tokens
         italics = false;
     }
     finishStringToken(nextString, tokens);
-    return validate(tokens, italics, bold);
+    auto result = validate(tokens, italics, bold);
+    if (result.code != SpeechTokenizerReturnCode::kSuccess) {
+        return result;
+    }
+    spliceLiterals(tokens);
+    return g_RESULT_SUCCESS;
 }
 
 }  // namespace Contextual::SpeechTokenizer
\ No newline at end of file
@@ -2,32 +2,36 @@
 
 #include <utility>
 
+#include "ContextIds.h"
 #include "ContextTable.h"
-#include "MathUtils.h"
 #include "SpeechGenerator.h"
 
 namespace Contextual {
 
-TokenContext::TokenContext(std::string table, std::string key) : m_table(std::move(table)), m_key(std::move(key)) {}
+TokenContext::TokenContext(std::string table, std::string key)
+    : m_table(std::move(table)),
+      m_key(std::move(key)),
+      m_tableId(ContextIds::getTableId(m_table)),
+      m_keyId(ContextIds::getKeyId(m_key)) {}
 
 std::optional<std::string> TokenContext::evaluate(DatabaseQuery& query) const {
-    std::shared_ptr<ContextTable> contextTable = query.getContextTable(m_table);
+    const ContextTable* contextTable = query.findContextTable(m_tableId);
     if (contextTable != nullptr) {
-        FactType type = contextTable->getType(m_key);
+        FactType type = contextTable->getType(m_keyId);
         if (type == FactType::kString) {
-            const std::optional<std::string>& value = contextTable->getString(m_key);
+            const std::optional<std::string>& value = contextTable->getString(m_keyId);
             if (value) {
                 return value;
             }
         } else if (type == FactType::kNumber) {
-            const std::optional<int>& value = contextTable->getInt(m_key);
+            const std::optional<int>& value = contextTable->getInt(m_keyId);
             if (value) {
                 return SpeechGenerator::integerToWord(*value);
             }
         } else if (type == FactType::kList) {
-            std::optional<std::vector<std::string>> options = contextTable->toStringList(m_key);
+            std::optional<std::vector<std::string>> options = contextTable->toStringList(m_keyId);
             if (options) {
-                size_t index = MathUtils::randUInt(0, options->size() - 1);
+                size_t index = query.getRandom().randUInt(0, options->size() - 1);
                 return (*options)[index];
             }
         }
@@ -51,4 +55,12 @@ const std::string& TokenContext::getKey() const {
     return m_key;
 }
 
+int TokenContext::getTableId() const {
+    return m_tableId;
+}
+
+int TokenContext::getKeyId() const {
+    return m_keyId;
+}
+
 }  // namespace Contextual
\ No newline at end of file
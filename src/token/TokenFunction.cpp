@@ -2,35 +2,16 @@
 
 #include <utility>
 
-#include "MathUtils.h"
-#include "SpeechGenerator.h"
+#include "FunctionTable.h"
 
 namespace Contextual {
 
-TokenFunction::TokenFunction(std::string name, std::vector<std::shared_ptr<SymbolToken>> args)
-    : m_name(std::move(name)), m_args(std::move(args)) {}
+TokenFunction::TokenFunction(std::string name, std::vector<std::shared_ptr<SymbolToken>> args,
+                             const FunctionSig* sig)
+    : m_name(std::move(name)), m_args(std::move(args)), m_sig(sig) {}
 
 std::optional<std::string> TokenFunction::evaluate(DatabaseQuery& query) const {
-    FunctionVal val = query.getFunctionTable()->call(m_name, m_args, query);
-    if (val.error) {
-        return std::nullopt;
-    }
-    if (val.type == TokenType::kList && val.isStringList) {
-        size_t index = MathUtils::randUInt(0, val.listVal.size() - 1);
-        return query.getStringTable().lookup(val.listVal[index]).value_or("NULL");
-    }
-    if (val.type == TokenType::kString) {
-        return val.stringVal;
-    }
-    if (val.type == TokenType::kInt) {
-        return SpeechGenerator::integerToWord(val.intVal);
-    }
-    if (val.type == TokenType::kFloat) {
-        int intVal = static_cast<int>(val.floatVal);
-        return SpeechGenerator::integerToWord(intVal);
-    }
-
-    return std::nullopt;
+    return FunctionTable::valueToString(query.getFunctionTable()->call(*this, query), query);
 }
 
 std::string TokenFunction::toString() const {
@@ -58,4 +39,8 @@ const std::vector<std::shared_ptr<SymbolToken>>& TokenFunction::getArgs() const
     return m_args;
 }
 
+const FunctionSig* TokenFunction::getSignature() const {
+    return m_sig;
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -1,7 +1,5 @@
 #include "TokenList.h"
 
-#include "MathUtils.h"
-
 namespace Contextual {
 
 TokenList::TokenList(std::vector<std::shared_ptr<SymbolToken>> tokens) : m_tokens(std::move(tokens)) {}
@@ -12,7 +10,7 @@ std::optional<std::string> TokenList::evaluate(DatabaseQuery& query) const {
 }
 
 std::optional<std::string> TokenList::evaluateList(DatabaseQuery& query, size_t& index) const {
-    index = MathUtils::randUInt(0, m_tokens.size() - 1);
+    index = query.getRandom().randUInt(0, m_tokens.size() - 1);
     const std::shared_ptr<SymbolToken>& token = m_tokens[index];
     return token->evaluate(query);
 }
@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
+#include "ContextIds.h"
 #include "ContextManager.h"
 #include "ContextTable.h"
 #include "DefaultFunctionTable.h"
@@ -212,4 +214,74 @@ TEST_F(ContextTableTest, TestRemoveValue) {
     EXPECT_EQ(m_contextTable->getFloat("Key"), std::nullopt);
 }
 
+TEST_F(ContextTableTest, TestKeyIdValue) {
+    m_contextTable->set("Key", 2);
+    int keyId = ContextIds::getKeyId("Key");
+
+    EXPECT_EQ(ContextIds::findKeyId("Key"), keyId);
+    EXPECT_EQ(ContextIds::getKeyName(keyId), "Key");
+    EXPECT_TRUE(m_contextTable->hasKey(keyId));
+    EXPECT_EQ(m_contextTable->getType(keyId), FactType::kNumber);
+    EXPECT_EQ(m_contextTable->getInt(keyId), 2);
+
+    m_contextTable->setRawValue(keyId, 0.0f, FactType::kBoolean);
+    EXPECT_EQ(m_contextTable->getBool("Key"), false);
+}
+
+TEST_F(ContextTableTest, TestLargeListValue) {
+    std::unique_ptr<std::unordered_set<int>> list = std::make_unique<std::unordered_set<int>>();
+    for (int i = 10; i > 0; --i) {
+        list->insert(i);
+    }
+    m_contextTable->set("Key", std::move(list));
+
+    const FactList* value = m_contextTable->getList("Key");
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->size(), 10);
+    EXPECT_TRUE(value->contains(1));
+    EXPECT_TRUE(value->contains(10));
+    EXPECT_FALSE(value->contains(11));
+    EXPECT_TRUE(std::is_sorted(value->begin(), value->end()));
+}
+
+TEST_F(ContextTableTest, TestChangeTracking) {
+    EXPECT_EQ(m_contextTable->getVersion(), 0);
+    EXPECT_EQ(m_contextTable->getKeyVersion("Key"), 0);
+
+    m_contextTable->set("Key", 1);
+    m_contextTable->set("Other", std::unordered_set<std::string>{"A"});
+    const uint64_t keyVersion = m_contextTable->getKeyVersion("Key");
+    const uint64_t version = m_contextTable->getVersion();
+    EXPECT_GT(keyVersion, 0);
+    EXPECT_GT(version, keyVersion);
+    EXPECT_EQ(m_contextTable->getDirtyKeys().size(), 2);
+    EXPECT_TRUE(m_contextTable->isDirty(ContextIds::getKeyId("Key")));
+
+    // Writing the same facts again is not a change
+    m_contextTable->clearDirty();
+    m_contextTable->set("Key", 1);
+    m_contextTable->set("Other", std::unordered_set<std::string>{"A"});
+    m_contextTable->remove("Missing");
+    EXPECT_EQ(m_contextTable->getVersion(), version);
+    EXPECT_TRUE(m_contextTable->getDirtyKeys().empty());
+
+    // Changing the type with the same raw value is
+    m_contextTable->setRawValue("Key", 1.0f, FactType::kBoolean);
+    EXPECT_GT(m_contextTable->getKeyVersion("Key"), version);
+    EXPECT_EQ(m_contextTable->getKeyVersion("Other"), version);
+    ASSERT_EQ(m_contextTable->getDirtyKeys().size(), 1);
+    EXPECT_EQ(m_contextTable->getDirtyKeys()[0], ContextIds::getKeyId("Key"));
+
+    // Removal keeps its version
+    m_contextTable->remove("Other");
+    EXPECT_EQ(m_contextTable->getKeyVersion("Other"), m_contextTable->getVersion());
+    EXPECT_TRUE(m_contextTable->isDirty(ContextIds::getKeyId("Other")));
+
+    // Versions are never shared between tables
+    auto other =
+        std::make_shared<ContextTable>(std::make_shared<ContextManager>(std::make_unique<DefaultFunctionTable>()));
+    other->set("Key", 1);
+    EXPECT_NE(other->getVersion(), m_contextTable->getVersion());
+}
+
 }  // namespace Contextual
\ No newline at end of file
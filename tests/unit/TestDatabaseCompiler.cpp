@@ -0,0 +1,326 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "ContextManager.h"
+#include "DatabaseCompiler.h"
+#include "DatabaseGenerator.h"
+#include "DatabaseParser.h"
+#include "DefaultFunctionTable.h"
+#include "ResponseContext.h"
+#include "ResponseContextSetStatic.h"
+#include "ResponseEvent.h"
+#include "ResponseMultiple.h"
+#include "ResponseSimple.h"
+#include "ResponseSpeech.h"
+#include "RuleDatabase.h"
+
+namespace Contextual {
+
+namespace {
+
+// Covers the response and criterion types that generated databases do not use
+const char* g_EXTRA_GROUP = R"({
+  "Name": "Extra",
+  "Categories": [{
+    "Name": "Actions",
+    "Rules": [
+      {"Criteria": [{"Type": "Eq", "Table": "Speaker", "Key": "Mood", "Value": "happy"}],
+       "Response": [
+         {"Type": "Event", "Value": {"Name": "wave", "Args": ["left", "slow"]}},
+         {"Type": "Context", "Value": {"Op": "Set", "Table": "Speaker", "Key": "Mood", "Value": "tired"}},
+         {"Type": "Context", "Value": {"Op": "Set", "Table": "Speaker", "Key": "Copy", "Value": {"Table": "World", "Key": "Time"}}},
+         {"Type": "Context", "Value": {"Op": "Set", "Table": "Speaker", "Key": "Tags", "Value": ["a", "b", "c"]}},
+         {"Type": "Context", "Value": {"Op": "Add", "Table": "Speaker", "Key": "Count", "Value": 2}},
+         {"Type": "Context", "Value": {"Op": "Mult", "Table": "Speaker", "Key": "Count", "Value": 3}},
+         {"Type": "Context", "Value": {"Op": "Invert", "Table": "Speaker", "Key": "Flag"}}
+       ]},
+      {"Criteria": [{"Type": "Empty", "Table": "Speaker", "Key": "Tags", "Invert": true}, {"Type": "Dummy", "Value": 4}],
+       "Response": [{"Type": "Text", "Value": ["a", "b"]}]}
+    ]
+  }]
+})";
+
+std::shared_ptr<ContextManager> createManager() {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    return std::make_shared<ContextManager>(std::move(functionTable));
+}
+
+std::string describe(const std::shared_ptr<Response>& response) {
+    if (response == nullptr) {
+        return "null";
+    }
+    std::string str;
+    switch (response->getType()) {
+        case ResponseType::kSimple:
+            for (const auto& option : std::static_pointer_cast<ResponseSimple>(response)->getOptions()) {
+                str += option + "|";
+            }
+            return "Simple[" + str + "]";
+        case ResponseType::kMultiple:
+            for (const auto& child : std::static_pointer_cast<ResponseMultiple>(response)->getResponses()) {
+                str += describe(child) + ",";
+            }
+            return "Multiple[" + str + "]";
+        case ResponseType::kSpeech:
+            for (const auto& line : std::static_pointer_cast<ResponseSpeech>(response)->getSpeechLines()) {
+                for (const auto& token : line) {
+                    str += token->toString();
+                }
+                str += "|";
+            }
+            return "Speech[" + str + "]";
+        case ResponseType::kEvent: {
+            auto event = std::static_pointer_cast<ResponseEvent>(response);
+            for (const auto& arg : event->getArgs()) {
+                str += arg + ",";
+            }
+            return "Event[" + event->getName() + ":" + str + "]";
+        }
+        case ResponseType::kContext: {
+            auto context = std::static_pointer_cast<ResponseContext>(response);
+            return "Context[" + std::string(typeid(*context).name()) + ":" + context->getTable() + "." +
+                   context->getKey() + "]";
+        }
+    }
+    return "";
+}
+
+}  // namespace
+
+class DatabaseCompilerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_dir = std::filesystem::temp_directory_path() /
+                ("contextual-compiler-test-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        std::filesystem::remove_all(m_dir);
+        std::filesystem::create_directories(m_dir / "json");
+
+        Gen::GeneratorSettings settings;
+        settings.numGroups = 4;
+        settings.inheritanceDepth = 2;
+        settings.numCategories = 3;
+        settings.rulesPerCategory = 40;
+        Gen::GeneratorStats genStats{};
+        Gen::generateDatabase(genStats, settings, (m_dir / "json").string());
+        std::ofstream((m_dir / "json" / "Extra.json").string()) << g_EXTRA_GROUP;
+
+        m_jsonManager = createManager();
+        m_jsonDatabase = std::make_unique<RuleDatabase>(m_jsonManager);
+        auto stats = DatabaseParser::loadDatabase(*m_jsonDatabase, (m_dir / "json").string());
+        ASSERT_EQ(stats.numFailed, 0);
+        m_compiledPath = (m_dir / "database.ctxdb").string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    std::filesystem::path m_dir;
+    std::string m_compiledPath;
+    std::shared_ptr<ContextManager> m_jsonManager;
+    std::unique_ptr<RuleDatabase> m_jsonDatabase;
+};
+
+TEST_F(DatabaseCompilerTest, TestRoundTrip) {
+    DatabaseCompiler::CompileStats writeStats{};
+    auto result = DatabaseCompiler::writeDatabase(writeStats, *m_jsonDatabase, m_compiledPath);
+    ASSERT_EQ(result.code, DatabaseCompiler::CompileReturnCode::kSuccess) << result.errorMsg;
+
+    auto manager = createManager();
+    RuleDatabase database(manager);
+    DatabaseCompiler::CompileStats readStats{};
+    result = DatabaseCompiler::loadDatabase(readStats, database, m_compiledPath);
+    ASSERT_EQ(result.code, DatabaseCompiler::CompileReturnCode::kSuccess) << result.errorMsg;
+    EXPECT_EQ(readStats.numTables, writeStats.numTables);
+    EXPECT_EQ(readStats.numRules, writeStats.numRules);
+
+    // Symbols resolve to the same strings
+    const StringTable& expectedStrings = m_jsonManager->getStringTable();
+    ASSERT_EQ(manager->getStringTable().getSize(), expectedStrings.getSize());
+    for (size_t i = 0; i < expectedStrings.getSize(); ++i) {
+        const int symbol = StringTable::g_FIRST_SYMBOL + static_cast<int>(i);
+        EXPECT_EQ(manager->getStringTable().lookup(symbol), expectedStrings.lookup(symbol));
+    }
+
+    const auto tableNames = m_jsonDatabase->getTableNames();
+    ASSERT_EQ(database.getTableNames(), tableNames);
+    for (const auto& [group, category] : tableNames) {
+        const auto expected = m_jsonDatabase->getRuleTable(group, category)->getEntries();
+        const auto actual = database.getRuleTable(group, category)->getEntries();
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i]->id, expected[i]->id);
+            EXPECT_EQ(actual[i]->priority, expected[i]->priority);
+            EXPECT_EQ(describe(actual[i]->response), describe(expected[i]->response));
+            ASSERT_EQ(actual[i]->criteria.size(), expected[i]->criteria.size());
+            for (size_t j = 0; j < expected[i]->criteria.size(); ++j) {
+                EXPECT_EQ(actual[i]->criteria[j]->tableId, expected[i]->criteria[j]->tableId);
+                EXPECT_EQ(actual[i]->criteria[j]->keyId, expected[i]->criteria[j]->keyId);
+                EXPECT_EQ(actual[i]->criteria[j]->criterion->getType(), expected[i]->criteria[j]->criterion->getType());
+            }
+        }
+    }
+
+    // Inherited entries stay shared between parent and child tables
+    const auto parent = database.getRuleTable(Gen::getGroupName(0), Gen::getCategoryName(0))->getEntries();
+    const auto child = database.getRuleTable(Gen::getGroupName(1), Gen::getCategoryName(0))->getEntries();
+    size_t shared = 0;
+    for (const auto& entry : child) {
+        shared += std::count(parent.begin(), parent.end(), entry);
+    }
+    EXPECT_EQ(shared, parent.size());
+}
+
+TEST_F(DatabaseCompilerTest, TestQueriesMatchJson) {
+    DatabaseCompiler::CompileStats stats{};
+    ASSERT_EQ(DatabaseCompiler::writeDatabase(stats, *m_jsonDatabase, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+    auto manager = createManager();
+    RuleDatabase database(manager);
+    ASSERT_EQ(DatabaseCompiler::loadDatabase(stats, database, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+
+    for (uint64_t seed = 0; seed < 50; ++seed) {
+        for (int g = 0; g < 4; ++g) {
+            DatabaseQuery expectedQuery(m_jsonManager, Gen::getGroupName(g), Gen::getCategoryName(seed % 3));
+            DatabaseQuery actualQuery(manager, Gen::getGroupName(g), Gen::getCategoryName(seed % 3));
+            for (const std::string table : {"Speaker", "Listener", "World"}) {
+                auto expectedContext = std::make_shared<ContextTable>(m_jsonManager);
+                auto actualContext = std::make_shared<ContextTable>(manager);
+                for (int key = 0; key < 32; ++key) {
+                    int value = static_cast<int>((seed * 31 + key * 7 + table.size()) % 8);
+                    expectedContext->set("Key" + std::to_string(key), value);
+                    actualContext->set("Key" + std::to_string(key), value);
+                }
+                expectedQuery.addContextTable(table, expectedContext);
+                actualQuery.addContextTable(table, actualContext);
+            }
+            expectedQuery.setSeed(seed);
+            actualQuery.setSeed(seed);
+
+            BestMatch expected;
+            BestMatch actual;
+            auto expectedCode = m_jsonDatabase->queryBestMatch(expected, expectedQuery);
+            auto actualCode = database.queryBestMatch(actual, actualQuery);
+            EXPECT_EQ(actualCode, expectedCode);
+            EXPECT_EQ(actual.priority, expected.priority);
+            EXPECT_EQ(describe(actual.response), describe(expected.response));
+        }
+    }
+}
+
+TEST_F(DatabaseCompilerTest, TestRejectsInvalidFiles) {
+    auto manager = createManager();
+    RuleDatabase database(manager);
+    DatabaseCompiler::CompileStats stats{};
+    EXPECT_EQ(DatabaseCompiler::loadDatabase(stats, database, (m_dir / "missing.ctxdb").string()).code,
+              DatabaseCompiler::CompileReturnCode::kInvalidPath);
+
+    std::ofstream((m_dir / "garbage.ctxdb").string()) << "definitely not a database";
+    EXPECT_EQ(DatabaseCompiler::loadDatabase(stats, database, (m_dir / "garbage.ctxdb").string()).code,
+              DatabaseCompiler::CompileReturnCode::kInvalidFormat);
+
+    // Every truncation of a valid file must be rejected without crashing
+    ASSERT_EQ(DatabaseCompiler::writeDatabase(stats, *m_jsonDatabase, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+    const auto size = std::filesystem::file_size(m_compiledPath);
+    for (auto truncated : {size_t{4}, size_t{24}, static_cast<size_t>(size / 2), static_cast<size_t>(size - 4)}) {
+        std::filesystem::copy_file(m_compiledPath, m_dir / "truncated.ctxdb",
+                                   std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(m_dir / "truncated.ctxdb", truncated);
+        RuleDatabase truncatedDatabase(createManager());
+        EXPECT_NE(DatabaseCompiler::loadDatabase(stats, truncatedDatabase, (m_dir / "truncated.ctxdb").string()).code,
+                  DatabaseCompiler::CompileReturnCode::kSuccess);
+    }
+}
+
+TEST_F(DatabaseCompilerTest, TestRemapsSymbolsIntoUsedStringTable) {
+    DatabaseCompiler::CompileStats stats{};
+    ASSERT_EQ(DatabaseCompiler::writeDatabase(stats, *m_jsonDatabase, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+    auto manager = createManager();
+    manager->getStringTable().cache("not in the compiled database");
+    manager->getStringTable().cache("tired");
+
+    // The same file loads again into a string table that already holds its symbols
+    RuleDatabase database(manager);
+    RuleDatabase otherDatabase(manager);
+    ASSERT_EQ(DatabaseCompiler::loadDatabase(stats, database, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+    ASSERT_EQ(DatabaseCompiler::loadDatabase(stats, otherDatabase, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+
+    for (const std::string mood : {"happy", "sad"}) {
+        DatabaseQuery expectedQuery(m_jsonManager, "Extra", "Actions");
+        DatabaseQuery actualQuery(manager, "Extra", "Actions");
+        auto expectedContext = std::make_shared<ContextTable>(m_jsonManager);
+        auto actualContext = std::make_shared<ContextTable>(manager);
+        expectedContext->set("Mood", mood);
+        actualContext->set("Mood", mood);
+        expectedQuery.addContextTable("Speaker", expectedContext);
+        actualQuery.addContextTable("Speaker", actualContext);
+
+        BestMatch expected;
+        BestMatch actual;
+        auto expectedCode = m_jsonDatabase->queryBestMatch(expected, expectedQuery);
+        EXPECT_EQ(database.queryBestMatch(actual, actualQuery), expectedCode);
+        EXPECT_EQ(describe(actual.response), describe(expected.response));
+        EXPECT_EQ(otherDatabase.queryBestMatch(actual, actualQuery), expectedCode);
+        EXPECT_EQ(describe(actual.response), describe(expected.response));
+    }
+
+    // String values set by responses use the live symbol
+    const auto entries = database.getRuleTable("Extra", "Actions")->getEntries();
+    const auto entry = std::find_if(entries.begin(), entries.end(), [](const std::shared_ptr<RuleEntry>& entry) {
+        return entry->response->getType() == ResponseType::kMultiple;
+    });
+    ASSERT_NE(entry, entries.end());
+    const auto response = std::static_pointer_cast<ResponseMultiple>((*entry)->response);
+    const auto setMood = std::static_pointer_cast<ResponseContextSetStatic>(response->getResponses()[1]);
+    EXPECT_EQ(setMood->getValue(), static_cast<float>(manager->getStringTable().cache("tired")));
+}
+
+TEST_F(DatabaseCompilerTest, TestNumbersInSymbolRangeAreNotRemapped) {
+    // Numbers that collide with symbol IDs, next to a string so the file has symbols to remap
+    std::filesystem::create_directories(m_dir / "numeric");
+    std::ofstream((m_dir / "numeric" / "Numeric.json").string()) << R"({"Name": "Numeric", "Categories": [{
+        "Name": "Idle", "Rules": [
+          {"Criteria": [{"Type": "Eq", "Table": "Speaker", "Key": "Level", "Value": 1000},
+                        {"Type": "Eq", "Table": "Speaker", "Key": "Rank", "Value": [1000, 1001]},
+                        {"Type": "Includes", "Table": "Speaker", "Key": "Tags", "Value": [1001, "x"]}],
+           "Response": [{"Type": "Text", "Value": ["numeric"]}]}]}]})";
+    auto jsonManager = createManager();
+    RuleDatabase jsonDatabase(jsonManager);
+    ASSERT_EQ(DatabaseParser::loadDatabase(jsonDatabase, (m_dir / "numeric").string()).numLoaded, 1);
+    DatabaseCompiler::CompileStats stats{};
+    ASSERT_EQ(DatabaseCompiler::writeDatabase(stats, jsonDatabase, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+
+    auto manager = createManager();
+    manager->getStringTable().cache("shifts every symbol");
+    RuleDatabase database(manager);
+    ASSERT_EQ(DatabaseCompiler::loadDatabase(stats, database, m_compiledPath).code,
+              DatabaseCompiler::CompileReturnCode::kSuccess);
+
+    DatabaseQuery query(manager, "Numeric", "Idle");
+    auto speaker = std::make_shared<ContextTable>(manager);
+    speaker->set("Level", 1000);
+    speaker->set("Rank", 1001);
+    speaker->set("Tags", std::unordered_set<std::string>{"x"});
+    query.addContextTable("Speaker", speaker);
+    BestMatch bestMatch;
+    EXPECT_EQ(database.queryBestMatch(bestMatch, query), QueryReturnCode::kSuccess);
+
+    // The numbers were kept as written
+    speaker->set("Level", 1001);
+    EXPECT_EQ(database.queryBestMatch(bestMatch, query), QueryReturnCode::kFailure);
+}
+
+}  // namespace Contextual
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "ContextManager.h"
+#include "DatabaseGenerator.h"
+#include "DatabaseParser.h"
+#include "DefaultFunctionTable.h"
+#include "RuleDatabase.h"
+
+namespace Contextual {
+
+class DatabaseGeneratorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_settings.numGroups = 4;
+        m_settings.inheritanceDepth = 2;
+        m_settings.numCategories = 2;
+        m_settings.rulesPerCategory = 25;
+        m_settings.maxCriteria = 6;
+        m_dir = std::filesystem::temp_directory_path() /
+                ("contextual-gen-test-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        std::filesystem::remove_all(m_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    Gen::GeneratorSettings m_settings;
+    std::filesystem::path m_dir;
+};
+
+TEST_F(DatabaseGeneratorTest, TestGeneratedDatabaseLoads) {
+    Gen::GeneratorStats genStats{};
+    auto result = Gen::generateDatabase(genStats, m_settings, m_dir.string());
+    ASSERT_EQ(result.code, Gen::GeneratorReturnCode::kSuccess);
+    EXPECT_EQ(genStats.numGroups, 4);
+    EXPECT_EQ(genStats.numRules, 200);
+
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    auto manager = std::make_shared<ContextManager>(std::move(functionTable));
+    RuleDatabase database(manager);
+    auto stats = DatabaseParser::loadDatabase(database, m_dir.string());
+    EXPECT_EQ(stats.numLoaded, 4);
+    EXPECT_EQ(stats.numFailed, 0);
+    EXPECT_EQ(stats.numTables, 8);
+    EXPECT_EQ(stats.numRules, 200);
+
+    // Every second group inherits the rules of the one before it
+    const auto& rootTable = database.getRuleTable(Gen::getGroupName(0), Gen::getCategoryName(0));
+    const auto& childTable = database.getRuleTable(Gen::getGroupName(1), Gen::getCategoryName(0));
+    ASSERT_NE(rootTable, nullptr);
+    ASSERT_NE(childTable, nullptr);
+    EXPECT_EQ(rootTable->getNumEntries(), 25);
+    EXPECT_EQ(childTable->getNumEntries(), 50);
+}
+
+TEST_F(DatabaseGeneratorTest, TestGeneratorIsReproducible) {
+    EXPECT_EQ(Gen::generateGroup(m_settings, 1), Gen::generateGroup(m_settings, 1));
+    EXPECT_NE(Gen::generateGroup(m_settings, 1), Gen::generateGroup(m_settings, 2));
+    Gen::GeneratorSettings reseeded = m_settings;
+    reseeded.seed = m_settings.seed + 1;
+    EXPECT_NE(Gen::generateGroup(m_settings, 1), Gen::generateGroup(reseeded, 1));
+}
+
+TEST_F(DatabaseGeneratorTest, TestInvalidSettings) {
+    m_settings.minCriteria = 5;
+    m_settings.maxCriteria = 2;
+    Gen::GeneratorStats genStats{};
+    auto result = Gen::generateDatabase(genStats, m_settings, m_dir.string());
+    EXPECT_EQ(result.code, Gen::GeneratorReturnCode::kInvalidSettings);
+    EXPECT_FALSE(std::filesystem::exists(m_dir));
+}
+
+}  // namespace Contextual
@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ContextManager.h"
+#include "CriterionAlternate.h"
+#include "DatabaseGenerator.h"
+#include "DatabaseParser.h"
+#include "DefaultFunctionTable.h"
+#include "RuleDatabase.h"
+#include "ThreadPool.h"
+
+namespace Contextual {
+
+namespace {
+
+std::shared_ptr<ContextManager> createManager() {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    return std::make_shared<ContextManager>(std::move(functionTable));
+}
+
+void writeGroup(const std::filesystem::path& path, const std::string& name, const std::string& parent,
+                const std::string& category = "Idle", const std::string& line = "") {
+    std::ofstream out(path.string());
+    out << R"({"Name": ")" << name << R"(", )";
+    if (!parent.empty()) {
+        out << R"("Parent": ")" << parent << R"(", )";
+    }
+    out << R"("Categories": [{"Name": ")" << category
+        << R"(", "Rules": [{"Criteria": [], "Response": [{"Type": "Text", "Value": [")"
+        << (line.empty() ? name : line) << R"("]}]}]}]})";
+}
+
+}  // namespace
+
+class DatabaseParserTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_dir = std::filesystem::temp_directory_path() /
+                ("contextual-parser-test-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        std::filesystem::remove_all(m_dir);
+        std::filesystem::create_directories(m_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    std::filesystem::path m_dir;
+};
+
+TEST_F(DatabaseParserTest, TestParallelLoadMatchesSerialLoad) {
+    Gen::GeneratorSettings settings;
+    settings.numGroups = 24;
+    settings.inheritanceDepth = 4;
+    settings.numCategories = 3;
+    settings.rulesPerCategory = 20;
+    Gen::GeneratorStats genStats{};
+    ASSERT_EQ(Gen::generateDatabase(genStats, settings, m_dir.string()).code, Gen::GeneratorReturnCode::kSuccess);
+
+    ThreadPool serialPool(0);
+    RuleDatabase serialDatabase(createManager());
+    auto serialStats = DatabaseParser::loadDatabase(serialDatabase, m_dir.string(), serialPool);
+    EXPECT_EQ(serialStats.numLoaded, 24);
+    EXPECT_EQ(serialStats.numFailed, 0);
+
+    ThreadPool parallelPool(4);
+    RuleDatabase parallelDatabase(createManager());
+    auto parallelStats = DatabaseParser::loadDatabase(parallelDatabase, m_dir.string(), parallelPool);
+    EXPECT_EQ(parallelStats.numLoaded, serialStats.numLoaded);
+    EXPECT_EQ(parallelStats.numFailed, serialStats.numFailed);
+    EXPECT_EQ(parallelStats.numTables, serialStats.numTables);
+    EXPECT_EQ(parallelStats.numRules, serialStats.numRules);
+
+    // Children see the complete tables of their parents no matter which thread built them
+    const auto tableNames = serialDatabase.getTableNames();
+    ASSERT_EQ(parallelDatabase.getTableNames(), tableNames);
+    for (const auto& [group, category] : tableNames) {
+        const auto expected = serialDatabase.getRuleTable(group, category)->getEntries();
+        const auto actual = parallelDatabase.getRuleTable(group, category)->getEntries();
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i]->id, expected[i]->id);
+            EXPECT_EQ(actual[i]->priority, expected[i]->priority);
+        }
+    }
+}
+
+TEST_F(DatabaseParserTest, TestMissingAndCircularParents) {
+    writeGroup(m_dir / "Root.json", "Root", "");
+    writeGroup(m_dir / "Child.json", "Child", "Root");
+    writeGroup(m_dir / "Grandchild.json", "Grandchild", "Child");
+    writeGroup(m_dir / "Orphan.json", "Orphan", "Missing");
+    writeGroup(m_dir / "CycleA.json", "CycleA", "CycleB");
+    writeGroup(m_dir / "CycleB.json", "CycleB", "CycleA");
+    std::ofstream((m_dir / "Broken.json").string()) << "{ not json";
+
+    RuleDatabase database(createManager());
+    auto stats = DatabaseParser::loadDatabase(database, m_dir.string());
+    EXPECT_EQ(stats.numLoaded, 3);
+    EXPECT_EQ(stats.numFailed, 4);
+    ASSERT_NE(database.getRuleTable("Grandchild", "Idle"), nullptr);
+    EXPECT_EQ(database.getRuleTable("Grandchild", "Idle")->getNumEntries(), 3);
+    EXPECT_EQ(database.getRuleTable("Orphan", "Idle"), nullptr);
+}
+
+TEST_F(DatabaseParserTest, TestDuplicateGroupFirstFileWins) {
+    // The first definition waits for its parent while the second could be built right away
+    writeGroup(m_dir / "A.json", "Dup", "Root", "Idle", "first");
+    writeGroup(m_dir / "B.json", "Dup", "", "Idle", "second");
+    writeGroup(m_dir / "Root.json", "Root", "");
+
+    for (const size_t numThreads : {0, 4}) {
+        ThreadPool threadPool(numThreads);
+        RuleDatabase database(createManager());
+        auto stats = DatabaseParser::loadDatabase(database, m_dir.string(), threadPool);
+        EXPECT_EQ(stats.numLoaded, 2);
+        EXPECT_EQ(stats.numFailed, 1);
+        ASSERT_NE(database.getRuleTable("Dup", "Idle"), nullptr);
+        // Its own rule plus the one inherited from Root
+        EXPECT_EQ(database.getRuleTable("Dup", "Idle")->getNumEntries(), 2);
+    }
+}
+
+TEST_F(DatabaseParserTest, TestFailedGroupAddsNoTables) {
+    std::ofstream((m_dir / "Partial.json").string())
+        << R"({"Name": "Partial", "Categories": [
+                {"Name": "Good", "Rules": [{"Criteria": [], "Response": [{"Type": "Text", "Value": ["ok"]}]}]},
+                {"Name": "Bad", "Rules": [{"Criteria": [{"Type": "Named", "Value": "Missing"}]}]}]})";
+
+    RuleDatabase database(createManager());
+    auto stats = DatabaseParser::loadDatabase(database, m_dir.string());
+    EXPECT_EQ(stats.numLoaded, 0);
+    EXPECT_EQ(stats.numFailed, 1);
+    EXPECT_EQ(database.getRuleTable("Partial", "Good"), nullptr);
+}
+
+TEST_F(DatabaseParserTest, TestReloadRebuildsInheritingGroups) {
+    writeGroup(m_dir / "Root.json", "Root", "");
+    writeGroup(m_dir / "Child.json", "Child", "Root");
+    writeGroup(m_dir / "Other.json", "Other", "");
+
+    RuleDatabase database(createManager());
+    DatabaseParser::DatabaseLoader loader(database);
+    ASSERT_EQ(loader.loadDatabase(m_dir.string()).numLoaded, 3);
+    const auto otherTable = database.getRuleTable("Other", "Idle");
+    const auto oldChildTable = database.getRuleTable("Child", "Idle");
+
+    // Move the root's rule into another category
+    writeGroup(m_dir / "Root.json", "Root", "", "Greet", "hello");
+    DatabaseParser::DatabaseStats stats{};
+    auto result = loader.reloadGroup(stats, (m_dir / "Root.json").string());
+    ASSERT_EQ(result.code, JsonParseReturnCode::kSuccess) << result.errorMsg;
+    EXPECT_EQ(stats.numLoaded, 2);
+    EXPECT_EQ(database.getRuleTable("Root", "Idle"), nullptr);
+    ASSERT_NE(database.getRuleTable("Root", "Greet"), nullptr);
+    // Children only inherit into categories they define themselves
+    EXPECT_EQ(database.getRuleTable("Child", "Greet"), nullptr);
+    EXPECT_EQ(database.getRuleTable("Child", "Idle")->getNumEntries(), 1);
+    EXPECT_EQ(database.getRuleTable("Other", "Idle"), otherTable);
+
+    // Tables handed out before the reload stay valid
+    EXPECT_EQ(oldChildTable->getNumEntries(), 2);
+}
+
+TEST_F(DatabaseParserTest, TestFailedReloadLeavesDatabaseUntouched) {
+    writeGroup(m_dir / "Root.json", "Root", "");
+    writeGroup(m_dir / "Child.json", "Child", "Root");
+
+    RuleDatabase database(createManager());
+    DatabaseParser::DatabaseLoader loader(database);
+    ASSERT_EQ(loader.loadDatabase(m_dir.string()).numLoaded, 2);
+    const auto rootTable = database.getRuleTable("Root", "Idle");
+
+    DatabaseParser::DatabaseStats stats{};
+    std::ofstream((m_dir / "Root.json").string()) << "{ not json";
+    EXPECT_EQ(loader.reloadGroup(stats, (m_dir / "Root.json").string()).code, JsonParseReturnCode::kInvalidSyntax);
+    writeGroup(m_dir / "Root.json", "Root", "Child");
+    EXPECT_EQ(loader.reloadGroup(stats, (m_dir / "Root.json").string()).code, JsonParseReturnCode::kInvalidValue);
+    writeGroup(m_dir / "Root.json", "Renamed", "");
+    EXPECT_EQ(loader.reloadGroup(stats, (m_dir / "Root.json").string()).code, JsonParseReturnCode::kInvalidValue);
+    EXPECT_EQ(database.getRuleTable("Root", "Idle"), rootTable);
+    EXPECT_EQ(database.getRuleTable("Renamed", "Idle"), nullptr);
+
+    // New groups can be added to a running database
+    writeGroup(m_dir / "Grandchild.json", "Grandchild", "Child");
+    auto result = loader.reloadGroup(stats, (m_dir / "Grandchild.json").string());
+    ASSERT_EQ(result.code, JsonParseReturnCode::kSuccess) << result.errorMsg;
+    EXPECT_EQ(database.getRuleTable("Grandchild", "Idle")->getNumEntries(), 3);
+}
+
+TEST_F(DatabaseParserTest, TestReloadWhileQuerying) {
+    writeGroup(m_dir / "Root.json", "Root", "");
+    writeGroup(m_dir / "Child.json", "Child", "Root");
+
+    auto manager = createManager();
+    RuleDatabase database(manager);
+    DatabaseParser::DatabaseLoader loader(database);
+    ASSERT_EQ(loader.loadDatabase(m_dir.string()).numLoaded, 2);
+
+    std::atomic<bool> done = false;
+    std::atomic<int> numFailed = 0;
+    std::thread reader([&]() {
+        while (!done) {
+            DatabaseQuery query(manager, "Child", "Idle");
+            BestMatch bestMatch;
+            if (database.queryBestMatch(bestMatch, query) != QueryReturnCode::kSuccess) {
+                ++numFailed;
+            }
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        writeGroup(m_dir / "Root.json", "Root", "", "Idle", "line" + std::to_string(i));
+        DatabaseParser::DatabaseStats stats{};
+        EXPECT_EQ(loader.reloadGroup(stats, (m_dir / "Root.json").string()).code, JsonParseReturnCode::kSuccess);
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(numFailed, 0);
+}
+
+TEST_F(DatabaseParserTest, TestReloadReleasesReplacedCriteria) {
+    auto writeRoot = [this](const int value) {
+        std::ofstream((m_dir / "Root.json").string())
+            << R"({"Name": "Root", "Categories": [{"Name": "Idle", "Rules": [{"Criteria": [)"
+            << R"({"Type": "Eq", "Table": "Speaker", "Key": "Level", "Value": )" << value
+            << R"(}], "Response": [{"Type": "Text", "Value": ["A"]}]}]}]})";
+    };
+    writeRoot(0);
+
+    RuleDatabase database(createManager());
+    DatabaseParser::DatabaseLoader loader(database);
+    ASSERT_EQ(loader.loadDatabase(m_dir.string()).numLoaded, 1);
+    const int numCriterions = Criterion::getCount();
+
+    // Each reload replaces the only criterion, so the old one must not be kept alive
+    for (int value = 1; value <= 5; ++value) {
+        writeRoot(value);
+        DatabaseParser::DatabaseStats stats{};
+        ASSERT_EQ(loader.reloadGroup(stats, (m_dir / "Root.json").string()).code, JsonParseReturnCode::kSuccess);
+        EXPECT_EQ(Criterion::getCount(), numCriterions);
+    }
+}
+
+TEST_F(DatabaseParserTest, TestIdenticalCriteriaAreShared) {
+    const std::string rules =
+        R"([{"Criteria": [{"Type": "Eq", "Table": "Speaker", "Key": "Mood", "Value": "Happy"},
+                          {"Type": "Le", "Table": "Speaker", "Key": "Health", "Value": 50},
+                          {"Type": "Eq", "Table": "Speaker", "Key": "Item", "Value": [1, 2, 3]}],
+            "Response": [{"Type": "Text", "Value": ["A"]}]},
+           {"Criteria": [{"Type": "Eq", "Table": "Listener", "Key": "Mood", "Value": "Happy"},
+                         {"Type": "Eq", "Table": "Speaker", "Key": "Item", "Value": [3, 2, 1]}],
+            "Response": [{"Type": "Text", "Value": ["B"]}]}])";
+    for (const std::string name : {"First", "Second"}) {
+        std::ofstream((m_dir / (name + ".json")).string())
+            << R"({"Name": ")" << name << R"(", "Categories": [{"Name": "Idle", "Rules": )" << rules << "}]}";
+    }
+
+    RuleDatabase database(createManager());
+    auto stats = DatabaseParser::loadDatabase(database, m_dir.string());
+    ASSERT_EQ(stats.numLoaded, 2);
+    auto first = database.getRuleTable("First", "Idle");
+    auto second = database.getRuleTable("Second", "Idle");
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    // Rules are sorted by priority, so A comes first in both tables
+    const RuleEntry& firstA = first->getEntry(0);
+    const RuleEntry& firstB = first->getEntry(1);
+    const RuleEntry& secondA = second->getEntry(0);
+    for (size_t i = 0; i < firstA.criteria.size(); ++i) {
+        EXPECT_EQ(firstA.criteria[i], secondA.criteria[i]);
+    }
+    // Same criterion on a different table shares the criterion but not the triple
+    EXPECT_NE(firstA.criteria[0], firstB.criteria[0]);
+    EXPECT_EQ(firstA.criteria[0]->criterion, firstB.criteria[0]->criterion);
+    // Alternate options are compared as sets
+    EXPECT_EQ(firstA.criteria[2], firstB.criteria[1]);
+    EXPECT_EQ(std::static_pointer_cast<CriterionAlternate>(firstA.criteria[2]->criterion)->getOptions().size(), 3);
+}
+
+}  // namespace Contextual
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ContextIds.h"
+#include "ContextManager.h"
+#include "ContextTable.h"
+#include "CriterionStatic.h"
+#include "DatabaseQuery.h"
+#include "DefaultFunctionTable.h"
+#include "ResponseSimple.h"
+#include "RuleDatabase.h"
+#include "ThreadPool.h"
+
+namespace Contextual {
+
+class RuleDatabaseTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_manager = std::make_shared<ContextManager>(std::make_unique<DefaultFunctionTable>());
+        m_database = std::make_unique<RuleDatabase>(m_manager);
+
+        // Each table answers with the bucket the speaker's health falls into
+        for (const std::string category : {"Idle", "Combat"}) {
+            auto ruleTable = std::make_unique<RuleTable>();
+            for (int bucket = 0; bucket < 10; ++bucket) {
+                auto entry = std::make_shared<RuleEntry>();
+                entry->id = "Test." + category + "." + std::to_string(bucket);
+                entry->priority = 1;
+                entry->criteria.push_back(std::make_shared<Criteria>(
+                    "Speaker", "Health",
+                    std::make_shared<CriterionStatic>(bucket * 10.0f, bucket * 10.0f + 9.0f, false)));
+                entry->response = std::make_shared<ResponseSimple>(std::vector<std::string>{category + "Response"});
+                ruleTable->addEntry(entry);
+            }
+            ruleTable->sortEntries();
+            m_database->addRuleTable("Test", category, ruleTable);
+        }
+    }
+
+    std::shared_ptr<ContextManager> m_manager;
+    std::unique_ptr<RuleDatabase> m_database;
+};
+
+TEST_F(RuleDatabaseTest, TestBatchMatchesSingleQueries) {
+    std::vector<DatabaseQuery> queries;
+    for (int i = 0; i < 500; ++i) {
+        std::string category = i % 3 == 0 ? "Idle" : (i % 3 == 1 ? "Combat" : "Missing");
+        DatabaseQuery& query = queries.emplace_back(m_manager, "Test", category);
+        auto speaker = std::make_shared<ContextTable>(m_manager);
+        // Values past 99 match no rule
+        speaker->set("Health", i % 120);
+        query.addContextTable("Speaker", speaker);
+    }
+
+    ThreadPool threadPool(4);
+    std::vector<BestMatch> bestMatches;
+    std::vector<QueryReturnCode> returnCodes;
+    m_database->queryBestMatches(bestMatches, returnCodes, queries, threadPool);
+
+    ASSERT_EQ(bestMatches.size(), queries.size());
+    ASSERT_EQ(returnCodes.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        BestMatch expected;
+        QueryReturnCode expectedCode = m_database->queryBestMatch(expected, queries[i]);
+        EXPECT_EQ(returnCodes[i], expectedCode);
+        EXPECT_EQ(bestMatches[i].response, expected.response);
+    }
+}
+
+TEST_F(RuleDatabaseTest, TestBatchWithoutWorkers) {
+    std::vector<DatabaseQuery> queries;
+    queries.emplace_back(m_manager, "Test", "Idle");
+    auto speaker = std::make_shared<ContextTable>(m_manager);
+    speaker->set("Health", 5);
+    queries[0].addContextTable("Speaker", speaker);
+
+    ThreadPool threadPool(0);
+    std::vector<BestMatch> bestMatches;
+    std::vector<QueryReturnCode> returnCodes;
+    m_database->queryBestMatches(bestMatches, returnCodes, queries, threadPool);
+
+    ASSERT_EQ(returnCodes.size(), 1);
+    EXPECT_EQ(returnCodes[0], QueryReturnCode::kSuccess);
+    EXPECT_EQ(bestMatches[0].priority, 1);
+}
+
+TEST_F(RuleDatabaseTest, TestSnapshotIsUnaffectedByUpdates) {
+    std::shared_ptr<const DatabaseSnapshot> snapshot = m_database->getSnapshot();
+    const uint64_t version = snapshot->getVersion();
+    std::shared_ptr<const RuleTable> idleTable = snapshot->getRuleTable("Test", "Idle");
+
+    std::vector<RuleTableUpdate> updates;
+    updates.push_back({"Test", "Idle", nullptr});
+    updates.push_back({"Test", "Extra", std::make_shared<RuleTable>()});
+    m_database->updateRuleTables(updates);
+
+    // The old snapshot still sees the tables it was taken with
+    EXPECT_EQ(snapshot->getVersion(), version);
+    EXPECT_EQ(snapshot->getRuleTable("Test", "Idle"), idleTable);
+    EXPECT_EQ(snapshot->getRuleTable("Test", "Extra"), nullptr);
+
+    EXPECT_EQ(m_database->getVersion(), version + 1);
+    EXPECT_EQ(m_database->getRuleTable("Test", "Idle"), nullptr);
+    EXPECT_NE(m_database->getRuleTable("Test", "Extra"), nullptr);
+
+    // Once the last snapshot goes away, so does the removed table
+    std::weak_ptr<const RuleTable> weakTable = idleTable;
+    idleTable.reset();
+    snapshot.reset();
+    EXPECT_TRUE(weakTable.expired());
+}
+
+TEST_F(RuleDatabaseTest, TestDuplicateTableIsNotTaken) {
+    const uint64_t version = m_database->getVersion();
+    auto ruleTable = std::make_unique<RuleTable>();
+    const RuleTable* rawTable = ruleTable.get();
+    EXPECT_EQ(m_database->addRuleTable("Test", "Idle", ruleTable), RuleDatabaseReturnCode::kAlreadyDefined);
+    EXPECT_EQ(ruleTable.get(), rawTable);
+    EXPECT_EQ(m_database->getVersion(), version);
+
+    EXPECT_EQ(m_database->addRuleTable("Test", "Extra", ruleTable), RuleDatabaseReturnCode::kSuccess);
+    EXPECT_EQ(ruleTable, nullptr);
+    EXPECT_EQ(m_database->getRuleTable("Test", "Extra").get(), rawTable);
+}
+
+TEST_F(RuleDatabaseTest, TestConcurrentReadersAndWriter) {
+    std::atomic<bool> done = false;
+    std::atomic<int> numInconsistent = 0;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                // Both tables are always swapped together, so a snapshot must never mix them
+                std::shared_ptr<const DatabaseSnapshot> snapshot = m_database->getSnapshot();
+                const auto& idle = snapshot->getRuleTable("Test", "Idle");
+                const auto& combat = snapshot->getRuleTable("Test", "Combat");
+                if (idle == nullptr || combat == nullptr || idle->getNumEntries() != combat->getNumEntries()) {
+                    ++numInconsistent;
+                }
+            }
+        });
+    }
+
+    for (size_t numEntries = 1; numEntries <= 50; ++numEntries) {
+        std::vector<RuleTableUpdate> updates;
+        for (const std::string category : {"Idle", "Combat"}) {
+            auto ruleTable = std::make_shared<RuleTable>();
+            for (size_t i = 0; i < numEntries; ++i) {
+                auto entry = std::make_shared<RuleEntry>();
+                entry->priority = 0;
+                ruleTable->addEntry(entry);
+            }
+            updates.push_back({"Test", category, std::move(ruleTable)});
+        }
+        m_database->updateRuleTables(updates);
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(numInconsistent, 0);
+    EXPECT_EQ(m_database->getRuleTable("Test", "Idle")->getNumEntries(), 50);
+}
+
+TEST_F(RuleDatabaseTest, TestContextTableBindings) {
+    DatabaseQuery query(m_manager, "Test", "Idle");
+    auto speaker = std::make_shared<ContextTable>(m_manager);
+    auto other = std::make_shared<ContextTable>(m_manager);
+    query.addContextTable("Speaker", speaker);
+    query.addContextTable("Speaker", other);
+    EXPECT_EQ(query.findContextTable("Speaker"), speaker.get());
+    EXPECT_EQ(query.findContextTable(ContextIds::getTableId("Speaker")), query.getContextTable("Speaker").get());
+    EXPECT_EQ(query.findContextTable("NeverBound"), nullptr);
+    EXPECT_EQ(query.findContextTable(-1), nullptr);
+
+    // Tables first named after the query was created still get a slot
+    query.addContextTable("BoundAfterQuery", other);
+    EXPECT_EQ(query.findContextTable("BoundAfterQuery"), other.get());
+    EXPECT_EQ(query.findContextTable("Listener"), nullptr);
+}
+
+}  // namespace Contextual
\ No newline at end of file
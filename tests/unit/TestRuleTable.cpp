@@ -0,0 +1,505 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CompiledCriteria.h"
+#include "ContextIds.h"
+#include "ContextManager.h"
+#include "ContextTable.h"
+#include "CriterionAlternate.h"
+#include "CriterionDynamic.h"
+#include "CriterionEmpty.h"
+#include "CriterionExist.h"
+#include "CriterionFail.h"
+#include "CriterionIncludes.h"
+#include "CriterionStatic.h"
+#include "DatabaseQuery.h"
+#include "DefaultFunctionTable.h"
+#include "RangeKernel.h"
+#include "ResponseSimple.h"
+#include "RuleTable.h"
+
+namespace {
+
+// Counts heap allocations made while enabled, to check that scratch queries allocate nothing
+std::atomic<bool> g_countAllocations = false;
+std::atomic<size_t> g_numAllocations = 0;
+
+}  // namespace
+
+void* operator new(const std::size_t size) {
+    if (g_countAllocations) {
+        ++g_numAllocations;
+    }
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace Contextual {
+
+class RuleTableTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_manager = std::make_shared<ContextManager>(std::make_unique<DefaultFunctionTable>());
+    }
+
+    std::shared_ptr<RuleEntry> createEntry(const std::string& id, int priority,
+                                           std::vector<std::shared_ptr<Criteria>> criteria) {
+        auto entry = std::make_shared<RuleEntry>();
+        entry->id = id;
+        entry->priority = priority;
+        entry->criteria = std::move(criteria);
+        entry->response = std::make_shared<ResponseSimple>(std::vector<std::string>{id});
+        return entry;
+    }
+
+    // Expected candidates for queryBest using a plain linear scan
+    std::vector<std::shared_ptr<Response>> expectedCandidates(const RuleTable& ruleTable, const DatabaseQuery& query,
+                                                              int& priority) {
+        std::vector<std::shared_ptr<Response>> candidates;
+        priority = std::numeric_limits<int>::min();
+        for (const auto& entry : ruleTable.getEntries()) {
+            bool matched = std::all_of(entry->criteria.begin(), entry->criteria.end(), [&query](const auto& criteria) {
+                return criteria->criterion->evaluate(criteria->tableId, criteria->keyId, query);
+            });
+            if (!matched || entry->priority < priority) {
+                continue;
+            }
+            if (entry->priority > priority) {
+                priority = entry->priority;
+                candidates.clear();
+            }
+            candidates.push_back(entry->response);
+        }
+        return candidates;
+    }
+
+    std::shared_ptr<ContextManager> m_manager;
+};
+
+TEST_F(RuleTableTest, TestSharedPredicatePrunesRules) {
+    auto isHigh = std::make_shared<Criteria>("Speaker", "Health", std::make_shared<CriterionStatic>(50, 100, false));
+    auto hasName = std::make_shared<Criteria>("Speaker", "Name", std::make_shared<CriterionExist>(false));
+    auto noListener = std::make_shared<Criteria>("Listener", "Name", std::make_shared<CriterionExist>(true));
+
+    RuleTable ruleTable;
+    std::shared_ptr<RuleEntry> entry = createEntry("A", 3, {isHigh, hasName});
+    ruleTable.addEntry(entry);
+    entry = createEntry("B", 2, {isHigh});
+    ruleTable.addEntry(entry);
+    entry = createEntry("C", 1, {hasName, noListener});
+    ruleTable.addEntry(entry);
+    ruleTable.sortEntries();
+
+    auto speaker = std::make_shared<ContextTable>(m_manager);
+    speaker->set("Health", 10);
+    speaker->set("Name", "Bob");
+    DatabaseQuery query(m_manager, "Group", "Category");
+    query.addContextTable("Speaker", speaker);
+
+    BestMatch bestMatch = ruleTable.queryBest(query);
+    ASSERT_NE(bestMatch.response, nullptr);
+    EXPECT_EQ(bestMatch.priority, 1);
+    EXPECT_EQ(std::static_pointer_cast<ResponseSimple>(bestMatch.response)->getOptions()[0], "C");
+
+    speaker->set("Health", 75);
+    bestMatch = ruleTable.queryBest(query);
+    ASSERT_NE(bestMatch.response, nullptr);
+    EXPECT_EQ(bestMatch.priority, 3);
+}
+
+TEST_F(RuleTableTest, TestIndexMatchesLinearScan) {
+    std::mt19937 rng(1234);
+    const std::vector<std::string> tables = {"Speaker", "Listener"};
+    const std::vector<std::string> keys = {"A", "B", "C", "D", "List"};
+
+    // Small pool of criteria so that rules share predicates
+    std::vector<std::shared_ptr<Criteria>> pool;
+    for (const auto& table : tables) {
+        for (const auto& key : keys) {
+            pool.push_back(std::make_shared<Criteria>(table, key, std::make_shared<CriterionStatic>(0, 2, false)));
+            pool.push_back(std::make_shared<Criteria>(table, key, std::make_shared<CriterionStatic>(1, 3, true)));
+            pool.push_back(std::make_shared<Criteria>(
+                table, key, std::make_shared<CriterionAlternate>(std::unordered_set<int>{1, 3}, false)));
+            pool.push_back(std::make_shared<Criteria>(table, key, std::make_shared<CriterionExist>(false)));
+            pool.push_back(std::make_shared<Criteria>(table, key, std::make_shared<CriterionExist>(true)));
+            pool.push_back(
+                std::make_shared<Criteria>(table, key, std::make_shared<CriterionIncludes>(std::vector<int>{2}, false)));
+            pool.push_back(std::make_shared<Criteria>(table, key, std::make_shared<CriterionEmpty>(true)));
+            pool.push_back(std::make_shared<Criteria>(
+                table, key, std::make_shared<CriterionDynamic>(-1, 1, "Listener", key, false)));
+        }
+    }
+
+    RuleTable ruleTable;
+    std::uniform_int_distribution<size_t> poolDist(0, pool.size() - 1);
+    for (int i = 0; i < 100; ++i) {
+        std::vector<std::shared_ptr<Criteria>> criteria;
+        size_t numCriteria = 2 + rng() % 3;
+        for (size_t j = 0; j < numCriteria; ++j) {
+            criteria.push_back(pool[poolDist(rng)]);
+        }
+        std::shared_ptr<RuleEntry> entry = createEntry("Rule" + std::to_string(i), rng() % 6, criteria);
+        ruleTable.addEntry(entry);
+    }
+    ruleTable.sortEntries();
+
+    for (int i = 0; i < 500; ++i) {
+        DatabaseQuery query(m_manager, "Group", "Category");
+        for (const auto& table : tables) {
+            if (rng() % 8 == 0) {
+                continue;
+            }
+            auto contextTable = std::make_shared<ContextTable>(m_manager);
+            for (const auto& key : keys) {
+                int kind = rng() % 3;
+                if (kind == 1) {
+                    contextTable->set(key, static_cast<int>(rng() % 5));
+                } else if (kind == 2) {
+                    auto list = std::make_unique<std::unordered_set<int>>();
+                    for (size_t j = rng() % 3; j > 0; --j) {
+                        list->insert(rng() % 4);
+                    }
+                    contextTable->set(key, std::move(list));
+                }
+            }
+            query.addContextTable(table, contextTable);
+        }
+
+        // Rules pruned through shared predicates must never be skipped by mistake in the other query modes
+        std::vector<std::shared_ptr<Response>> allMatches;
+        for (const auto& entry : ruleTable.getEntries()) {
+            if (std::all_of(entry->criteria.begin(), entry->criteria.end(), [&query](const auto& criteria) {
+                    return criteria->criterion->evaluate(criteria->tableId, criteria->keyId, query);
+                })) {
+                allMatches.push_back(entry->response);
+            }
+        }
+        EXPECT_EQ(ruleTable.queryUniform(query).options, allMatches);
+
+        int expectedPriority;
+        std::vector<std::shared_ptr<Response>> candidates = expectedCandidates(ruleTable, query, expectedPriority);
+        BestMatch bestMatch = ruleTable.queryBest(query);
+        if (candidates.empty()) {
+            EXPECT_EQ(bestMatch.response, nullptr);
+            continue;
+        }
+        EXPECT_EQ(bestMatch.priority, expectedPriority);
+        EXPECT_NE(std::find(candidates.begin(), candidates.end(), bestMatch.response), candidates.end());
+    }
+}
+
+TEST_F(RuleTableTest, TestSeededQueryIsReproducible) {
+    RuleTable ruleTable;
+    auto maybeFail = std::make_shared<Criteria>("", "", std::make_shared<CriterionFail>(0.5f));
+    for (int i = 0; i < 10; ++i) {
+        std::shared_ptr<RuleEntry> entry = createEntry("Rule" + std::to_string(i), 1, {maybeFail});
+        ruleTable.addEntry(entry);
+    }
+    ruleTable.sortEntries();
+
+    DatabaseQuery query(m_manager, "Group", "Category");
+    query.setSeed(42);
+    std::vector<std::shared_ptr<Response>> first;
+    for (int i = 0; i < 50; ++i) {
+        first.push_back(ruleTable.queryBest(query).response);
+    }
+
+    query.setSeed(42);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(ruleTable.queryBest(query).response, first[i]);
+    }
+}
+
+TEST_F(RuleTableTest, TestScratchQueriesMatchOwningQueries) {
+    auto isHigh = std::make_shared<Criteria>("Speaker", "Health", std::make_shared<CriterionStatic>(50, 100, false));
+    auto maybeFail = std::make_shared<Criteria>("", "", std::make_shared<CriterionFail>(0.3f));
+    RuleTable ruleTable;
+    for (int i = 0; i < 20; ++i) {
+        std::shared_ptr<RuleEntry> entry = createEntry("Rule" + std::to_string(i), i % 3, {isHigh, maybeFail});
+        // Overlapping options so that unique queries have something to drop
+        entry->response = std::make_shared<ResponseSimple>(
+            std::vector<std::string>{"Option" + std::to_string(i % 4), "Option" + std::to_string(i % 7)});
+        ruleTable.addEntry(entry);
+    }
+    ruleTable.sortEntries();
+
+    auto speaker = std::make_shared<ContextTable>(m_manager);
+    speaker->set("Health", 75);
+    DatabaseQuery query(m_manager, "Group", "Category");
+    query.addContextTable("Speaker", speaker);
+    const std::unordered_set<std::string> skip = {"Option2"};
+
+    QueryScratch scratch;
+    for (uint64_t seed = 0; seed < 50; ++seed) {
+        query.setSeed(seed);
+        BestMatch expected = ruleTable.queryBest(query);
+        query.setSeed(seed);
+        const RuleEntry* entry = ruleTable.queryBest(scratch, query);
+        ASSERT_EQ(entry == nullptr, expected.response == nullptr);
+        if (entry != nullptr) {
+            EXPECT_EQ(entry->response, expected.response);
+            EXPECT_EQ(entry->priority, expected.priority);
+        }
+
+        query.setSeed(seed);
+        UniformMatch expectedUniform = ruleTable.queryUniform(query);
+        query.setSeed(seed);
+        ruleTable.queryAll(scratch, query);
+        ASSERT_EQ(scratch.matches.size(), expectedUniform.options.size());
+        for (size_t i = 0; i < scratch.matches.size(); ++i) {
+            EXPECT_EQ(ruleTable.getEntry(scratch.matches[i]).response, expectedUniform.options[i]);
+        }
+
+        for (const bool unique : {false, true}) {
+            query.setSeed(seed);
+            SimpleWeightedMatch expectedSimple = ruleTable.querySimpleWeighted(query, skip, unique);
+            query.setSeed(seed);
+            ruleTable.querySimple(scratch, query, skip, unique);
+            ASSERT_EQ(scratch.simpleOptions.size(), expectedSimple.weightedOptions.size());
+            for (size_t i = 0; i < scratch.simpleOptions.size(); ++i) {
+                EXPECT_EQ(*scratch.simpleOptions[i].first, expectedSimple.weightedOptions[i].first);
+                EXPECT_EQ(scratch.simpleOptions[i].second, expectedSimple.weightedOptions[i].second);
+            }
+        }
+    }
+
+    // Unique options appear once each, in order of first appearance
+    query.setWillFail(DatabaseQuery::WillFail::kNever);
+    ruleTable.querySimple(scratch, query, skip, true);
+    std::vector<std::string> options;
+    for (const auto& [option, priority] : scratch.simpleOptions) {
+        EXPECT_EQ(std::find(options.begin(), options.end(), *option), options.end());
+        EXPECT_NE(*option, "Option2");
+        options.push_back(*option);
+    }
+    EXPECT_EQ(options.size(), 6);
+}
+
+TEST_F(RuleTableTest, TestScratchQueriesDoNotAllocate) {
+    auto isHigh = std::make_shared<Criteria>("Speaker", "Health", std::make_shared<CriterionStatic>(50, 100, false));
+    auto hasName = std::make_shared<Criteria>("Speaker", "Name", std::make_shared<CriterionExist>(false));
+    RuleTable ruleTable;
+    for (int i = 0; i < 50; ++i) {
+        std::shared_ptr<RuleEntry> entry =
+            createEntry("Rule" + std::to_string(i), i % 5, i % 2 == 0 ? std::vector{isHigh, hasName} : std::vector{isHigh});
+        ruleTable.addEntry(entry);
+    }
+    ruleTable.sortEntries();
+
+    auto speaker = std::make_shared<ContextTable>(m_manager);
+    speaker->set("Health", 75);
+    speaker->set("Name", "Bob");
+    DatabaseQuery query(m_manager, "Group", "Category");
+    query.addContextTable("Speaker", speaker);
+    const std::unordered_set<std::string> skip;
+
+    // Warm up the scratch buffers once
+    QueryScratch scratch;
+    static_cast<void>(ruleTable.queryBest(scratch, query));
+    ruleTable.querySimple(scratch, query, skip, true);
+
+    g_numAllocations = 0;
+    g_countAllocations = true;
+    for (int i = 0; i < 100; ++i) {
+        static_cast<void>(ruleTable.queryBest(scratch, query));
+        ruleTable.queryAll(scratch, query);
+        ruleTable.querySimple(scratch, query, skip, true);
+    }
+    g_countAllocations = false;
+    EXPECT_EQ(g_numAllocations, 0);
+}
+
+TEST_F(RuleTableTest, TestCompiledCriteriaMatchVirtual) {
+    std::vector<int> manyOptions;
+    for (int i = 0; i < 20; i += 2) {
+        manyOptions.push_back(i);
+    }
+    std::vector<std::shared_ptr<Criterion>> criteria = {
+        std::make_shared<CriterionStatic>(2, 5, false),
+        std::make_shared<CriterionStatic>(2, 5, true),
+        std::make_shared<CriterionAlternate>(std::unordered_set<int>{1, 3}, false),
+        std::make_shared<CriterionAlternate>(std::unordered_set<int>(manyOptions.begin(), manyOptions.end()), true),
+        std::make_shared<CriterionDynamic>(-1, 1, "Listener", "B", false),
+        std::make_shared<CriterionExist>(false),
+        std::make_shared<CriterionExist>(true),
+        std::make_shared<CriterionIncludes>(std::vector<int>{2, 5}, false),
+        std::make_shared<CriterionIncludes>(std::vector<int>{1}, true),
+        std::make_shared<CriterionEmpty>(false),
+        std::make_shared<CriterionEmpty>(true),
+        std::make_shared<CriterionFail>(0.5f),
+    };
+    const int tableId = ContextIds::getTableId("Speaker");
+    const int keyId = ContextIds::getKeyId("A");
+    CompiledCriteria compiledCriteria;
+    std::vector<CompiledCriterion> compiled;
+    for (const auto& criterion : criteria) {
+        compiled.push_back(compiledCriteria.compile(tableId, keyId, *criterion));
+    }
+
+    std::mt19937 rng(5678);
+    for (int i = 0; i < 200; ++i) {
+        DatabaseQuery query(m_manager, "Group", "Category");
+        query.setWillFail(i % 2 == 0 ? DatabaseQuery::WillFail::kNever : DatabaseQuery::WillFail::kAlways);
+        for (const std::string table : {"Speaker", "Listener"}) {
+            if (rng() % 6 == 0) {
+                continue;
+            }
+            auto contextTable = std::make_shared<ContextTable>(m_manager);
+            for (const std::string key : {"A", "B"}) {
+                int kind = rng() % 3;
+                if (kind == 1) {
+                    contextTable->set(key, static_cast<int>(rng() % 20));
+                } else if (kind == 2) {
+                    auto list = std::make_unique<std::unordered_set<int>>();
+                    for (size_t j = rng() % 3; j > 0; --j) {
+                        list->insert(rng() % 6);
+                    }
+                    contextTable->set(key, std::move(list));
+                }
+            }
+            query.addContextTable(table, contextTable);
+        }
+        for (size_t j = 0; j < criteria.size(); ++j) {
+            EXPECT_EQ(compiledCriteria.evaluate(compiled[j], query), criteria[j]->evaluate(tableId, keyId, query))
+                << "criterion " << j << ", query " << i;
+        }
+    }
+}
+
+TEST_F(RuleTableTest, TestRangeKernelMatchesScalar) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<float> mins = {0, 1, -inf, 2, 5, nan, -1, 3};
+    std::vector<float> maxs = {0, 3, 1, inf, 4, 1, nan, 3};
+    std::mt19937 rng(42);
+    for (int i = 0; i < 100; ++i) {
+        float min = static_cast<float>(rng() % 10) - 5;
+        mins.push_back(min);
+        maxs.push_back(min + static_cast<float>(rng() % 4));
+    }
+    const size_t count = mins.size();
+    mins.resize(RangeKernel::getPaddedCount(count), RangeKernel::getPaddingMin());
+    maxs.resize(RangeKernel::getPaddedCount(count), RangeKernel::getPaddingMax());
+    std::vector<uint64_t> matches(RangeKernel::getNumWords(mins.size()));
+
+    for (const float value : {-inf, -5.0f, -1.0f, 0.0f, 0.5f, 1.0f, 3.0f, 4.0f, 7.5f, inf, nan}) {
+        RangeKernel::evaluate(value, mins.data(), maxs.data(), mins.size(), matches.data());
+        for (size_t j = 0; j < mins.size(); ++j) {
+            const bool expected = j < count && mins[j] <= value && value <= maxs[j];
+            EXPECT_EQ(((matches[j / 64] >> (j % 64)) & 1) != 0, expected)
+                << RangeKernel::getInstructionSet() << ": range " << j << ", value " << value;
+        }
+    }
+}
+
+TEST_F(RuleTableTest, TestCachedQueriesMatchUncachedQueries) {
+    std::mt19937 rng(99);
+    const std::vector<std::string> keys = {"A", "B", "C"};
+    std::vector<std::shared_ptr<Criteria>> pool;
+    for (const auto& key : keys) {
+        pool.push_back(std::make_shared<Criteria>("Speaker", key, std::make_shared<CriterionStatic>(0, 1, false)));
+        pool.push_back(std::make_shared<Criteria>("Speaker", key, std::make_shared<CriterionExist>(false)));
+        pool.push_back(
+            std::make_shared<Criteria>("Speaker", key, std::make_shared<CriterionIncludes>(std::vector<int>{1}, false)));
+        pool.push_back(std::make_shared<Criteria>(
+            "Speaker", key, std::make_shared<CriterionDynamic>(-1, 1, "Listener", key, false)));
+    }
+    pool.push_back(std::make_shared<Criteria>("", "", std::make_shared<CriterionFail>(0.5f)));
+
+    std::vector<std::shared_ptr<RuleEntry>> entries;
+    std::uniform_int_distribution<size_t> poolDist(0, pool.size() - 1);
+    for (int i = 0; i < 80; ++i) {
+        std::vector<std::shared_ptr<Criteria>> criteria;
+        for (size_t j = 1 + rng() % 3; j > 0; --j) {
+            criteria.push_back(pool[poolDist(rng)]);
+        }
+        entries.push_back(createEntry("Rule" + std::to_string(i), rng() % 4, criteria));
+    }
+    RuleTable uncached;
+    uncached.addEntries(entries);
+    uncached.sortEntries();
+    RuleTable cached;
+    cached.addEntries(entries);
+    cached.sortEntries();
+    cached.enableCache(4);
+
+    // A few speakers that repeat, against a listener that changes every time and is only read by residual criteria
+    std::vector<std::shared_ptr<ContextTable>> speakers;
+    for (int i = 0; i < 6; ++i) {
+        auto speaker = std::make_shared<ContextTable>(m_manager);
+        for (const auto& key : keys) {
+            if (rng() % 2 == 0) {
+                speaker->set(key, static_cast<int>(rng() % 3));
+            } else {
+                speaker->set(key, std::make_unique<std::unordered_set<int>>(std::unordered_set<int>{1}));
+            }
+        }
+        speakers.push_back(speaker);
+    }
+    for (uint64_t i = 0; i < 300; ++i) {
+        auto listener = std::make_shared<ContextTable>(m_manager);
+        for (const auto& key : keys) {
+            listener->set(key, static_cast<int>(rng() % 3));
+        }
+        DatabaseQuery query(m_manager, "Group", "Category");
+        query.addContextTable("Speaker", speakers[rng() % speakers.size()]);
+        query.addContextTable("Listener", listener);
+
+        query.setSeed(i);
+        BestMatch expected = uncached.queryBest(query);
+        query.setSeed(i);
+        BestMatch actual = cached.queryBest(query);
+        EXPECT_EQ(actual.response, expected.response);
+        EXPECT_EQ(actual.priority, expected.priority);
+
+        query.setSeed(i);
+        std::vector<std::shared_ptr<Response>> expectedOptions = uncached.queryUniform(query).options;
+        query.setSeed(i);
+        EXPECT_EQ(cached.queryUniform(query).options, expectedOptions);
+    }
+    ASSERT_NE(cached.getCache(), nullptr);
+    EXPECT_GT(cached.getCache()->getNumHits(), 0);
+    EXPECT_LE(cached.getCache()->getSize(), 4);
+
+    // Changing a fact the criteria read is a different fingerprint, so the old result is never reused
+    auto speaker = std::make_shared<ContextTable>(m_manager);
+    speaker->set("A", 1);
+    DatabaseQuery query(m_manager, "Group", "Category");
+    query.addContextTable("Speaker", speaker);
+    query.setWillFail(DatabaseQuery::WillFail::kNever);
+    EXPECT_EQ(cached.queryUniform(query).options, uncached.queryUniform(query).options);
+    speaker->set("A", 2);
+    EXPECT_EQ(cached.queryUniform(query).options, uncached.queryUniform(query).options);
+
+    // A reused scratch skips fingerprinting while the context tables keep their versions, but not after a change
+    QueryScratch scratch;
+    QueryScratch expectedScratch;
+    for (int value : {2, 2, 1, 1, 0, 1}) {
+        speaker->set("A", value);
+        cached.queryAll(scratch, query);
+        uncached.queryAll(expectedScratch, query);
+        EXPECT_EQ(scratch.matches, expectedScratch.matches);
+    }
+}
+
+}  // namespace Contextual
\ No newline at end of file
@@ -1,8 +1,23 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "ContextManager.h"
+#include "ContextTable.h"
+#include "DatabaseQuery.h"
+#include "DefaultFunctionTable.h"
+#include "ResponseSpeech.h"
 #include "SpeechGenerator.h"
+#include "SpeechSink.h"
+#include "SpeechTokenizer.h"
+#include "TokenInt.h"
+#include "TokenList.h"
+#include "TokenString.h"
 
 namespace Contextual {
 
@@ -41,4 +56,89 @@ TEST_F(SpeechGeneratorTest, TestIntegerToWord) {
                       "nine hundred forty-seven million two hundred sixty-eight thousand eight hundred fifty-first");
 }
 
+TEST_F(SpeechGeneratorTest, TestSinkMatchesTokens) {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    auto manager = std::make_shared<ContextManager>(std::move(functionTable));
+    DatabaseQuery query(manager, "Group", "Category");
+    auto listener = std::make_shared<ContextTable>(manager);
+    listener->set("Name", "Grievous");
+    query.addContextTable("Listener", listener);
+
+    const std::unordered_map<std::string, std::shared_ptr<SymbolToken>> symbols;
+    std::vector<std::shared_ptr<SpeechToken>> tokens;
+    auto result = SpeechTokenizer::tokenize(tokens, "{speed=2}*Hello* @upper(#Listener.Name)!/Welcome.", symbols,
+                                            symbols, manager);
+    ASSERT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
+
+    std::vector<std::shared_ptr<TextToken>> speechLine;
+    ASSERT_TRUE(SpeechGenerator::generateLineFromTokens(speechLine, query, tokens));
+    std::string text = "> ";
+    StringSpeechSink sink(text);
+    ASSERT_TRUE(SpeechGenerator::generateLineFromTokens(sink, query, tokens));
+    EXPECT_EQ(text, "> " + SpeechGenerator::getRawSpeechLine(speechLine));
+    EXPECT_EQ(text, "> Hello GRIEVOUS!Welcome.");
+
+    // A line that fails partway through leaves nothing behind
+    tokens.clear();
+    result = SpeechTokenizer::tokenize(tokens, "Hello #Listener.Title!", symbols, symbols, manager);
+    ASSERT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
+    EXPECT_FALSE(SpeechGenerator::generateLineFromTokens(sink, query, tokens));
+    EXPECT_EQ(text, "> Hello GRIEVOUS!Welcome.");
+    speechLine.clear();
+    EXPECT_FALSE(SpeechGenerator::generateLineFromTokens(speechLine, query, tokens));
+    EXPECT_TRUE(speechLine.empty());
+}
+
+TEST_F(SpeechGeneratorTest, TestProgramMatchesTokens) {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    auto manager = std::make_shared<ContextManager>(std::move(functionTable));
+    DatabaseQuery query(manager, "Group", "Category");
+    auto listener = std::make_shared<ContextTable>(manager);
+    listener->set("Name", "Grievous");
+    listener->set("Gender", "male");
+    query.addContextTable("Listener", listener);
+
+    std::vector<std::shared_ptr<SymbolToken>> letters;
+    for (const std::string letter : {"A", "B", "C", "D"}) {
+        letters.push_back(std::make_shared<TokenString>(letter));
+    }
+    const std::unordered_map<std::string, std::shared_ptr<SymbolToken>> symbols = {
+        {"letter", std::make_shared<TokenList>(letters)}, {"count", std::make_shared<TokenInt>(3)}};
+    std::vector<std::vector<std::shared_ptr<SpeechToken>>> speechLines;
+    const std::vector<std::string> lines = {
+        "*Hello* #Listener.Name, @count letters: @letter, @letter, @letter.__ Then @prev(2).",
+        "{speed=2}@capitalize(@subjective(#Listener.Gender)) picked @letter!/Twice: @letter.",
+        "Hi @upper(#Listener.Name) and @ord(2)"};
+    for (const std::string& line : lines) {
+        auto result = SpeechTokenizer::tokenize(speechLines.emplace_back(), line, symbols, symbols,
+                                                manager);
+        ASSERT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
+    }
+    auto speechResponse = std::make_shared<ResponseSpeech>(speechLines);
+    ASSERT_EQ(speechResponse->getProgram().getNumLines(), speechLines.size());
+
+    for (uint64_t seed = 0; seed < 64; ++seed) {
+        query.setSeed(seed);
+        std::vector<std::shared_ptr<TextToken>> expectedLine;
+        ASSERT_TRUE(SpeechGenerator::generateLineFromTokens(expectedLine, query,
+                                                            speechResponse->getRandomLine(query.getRandom())));
+        const std::optional<std::string> expectedPrev = query.getPrevChoice(2);
+
+        query.setSeed(seed);
+        std::vector<std::shared_ptr<TextToken>> actualLine;
+        ASSERT_TRUE(SpeechGenerator::generateLineFromResponse(actualLine, query, speechResponse));
+        EXPECT_EQ(query.getPrevChoice(2), expectedPrev);
+        ASSERT_EQ(actualLine.size(), expectedLine.size());
+        std::string expected;
+        std::string actual;
+        for (size_t i = 0; i < expectedLine.size(); ++i) {
+            expected += expectedLine[i]->toString();
+            actual += actualLine[i]->toString();
+        }
+        EXPECT_EQ(actual, expected);
+    }
+}
+
 }  // namespace Contextual
\ No newline at end of file
@@ -3,23 +3,51 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "ContextManager.h"
+#include "ContextTable.h"
+#include "DatabaseQuery.h"
 #include "DefaultFunctionTable.h"
 #include "FunctionTable.h"
 #include "SpeechTokenizer.h"
 #include "SymbolToken.h"
+#include "TokenFunction.h"
 
 namespace Contextual {
 
+namespace {
+
+// A pure function that interns its argument, so folding it needs the manager's string table
+class InternFunctionTable : public FunctionTable {
+public:
+    void initialize() override {
+        registerFunction(0, "intern", TokenType::kInt, {TokenType::kString}, false, true);
+    }
+
+protected:
+    FunctionVal doCall(int, const std::vector<std::shared_ptr<SymbolToken>>& args,
+                       DatabaseQuery& query) const override {
+        std::optional<std::string> str = argToString(args[0], query);
+        if (!str) {
+            return FunctionVal();
+        }
+        return FunctionVal(query.getStringTable().cache(*str));
+    }
+};
+
+}  // namespace
+
 class SpeechTokenizerTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        m_functionTable = std::make_unique<DefaultFunctionTable>();
+        m_manager = std::make_shared<ContextManager>(std::make_unique<DefaultFunctionTable>());
     }
 
     void testValidSpeechLine(const std::string& speechLine, const std::string& expected) {
         std::vector<std::shared_ptr<SpeechToken>> tokens;
-        auto result = SpeechTokenizer::tokenize(tokens, speechLine, m_symbols, m_localSymbols, m_functionTable);
+        auto result = SpeechTokenizer::tokenize(tokens, speechLine, m_symbols, m_localSymbols, m_manager);
         EXPECT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
 
         // Convert tokens to string
@@ -32,11 +60,11 @@ protected:
 
     void testInvalidSpeechLine(const std::string& speechLine, const SpeechTokenizerReturnCode expectedCode) {
         std::vector<std::shared_ptr<SpeechToken>> tokens;
-        auto result = SpeechTokenizer::tokenize(tokens, speechLine, m_symbols, m_localSymbols, m_functionTable);
+        auto result = SpeechTokenizer::tokenize(tokens, speechLine, m_symbols, m_localSymbols, m_manager);
         EXPECT_EQ(result.code, expectedCode);
     }
 
-    std::unique_ptr<FunctionTable> m_functionTable;
+    std::shared_ptr<ContextManager> m_manager;
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>> m_symbols;
     std::unordered_map<std::string, std::shared_ptr<SymbolToken>> m_localSymbols;
 };
@@ -69,4 +97,85 @@ TEST_F(SpeechTokenizerTest, TestInvalidFormat) {
     testInvalidSpeechLine("{italics=true}Hello world!{italics=false}", SpeechTokenizerReturnCode::kInvalidFormat);
 }
 
+TEST_F(SpeechTokenizerTest, TestFunctionsBindAtTokenize) {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    auto manager = std::make_shared<ContextManager>(std::move(functionTable));
+    const std::unique_ptr<FunctionTable>& boundTable = manager->getFunctionTable();
+
+    std::vector<std::shared_ptr<SpeechToken>> tokens;
+    auto result = SpeechTokenizer::tokenize(tokens, "@missing()", m_symbols, m_localSymbols, manager);
+    EXPECT_EQ(result.code, SpeechTokenizerReturnCode::kInvalidFunction);
+
+    tokens.clear();
+    result = SpeechTokenizer::tokenize(tokens, "@ord(#Speaker.Rank) @count(#Speaker.Items)", m_symbols, m_localSymbols,
+                                       manager);
+    ASSERT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
+    ASSERT_EQ(tokens.size(), 3);
+    const auto ord = std::static_pointer_cast<TokenFunction>(tokens[0]);
+    const auto count = std::static_pointer_cast<TokenFunction>(tokens[2]);
+    EXPECT_EQ(ord->getSignature(), boundTable->getSignature("ord").get());
+    EXPECT_EQ(count->getSignature(), boundTable->getSignature("count").get());
+
+    DatabaseQuery query(manager, "Group", "Category");
+    auto speaker = std::make_shared<ContextTable>(manager);
+    speaker->set("Rank", 3);
+    speaker->set("Items", std::unordered_set<std::string>{"Sword", "Shield"});
+    query.addContextTable("Speaker", speaker);
+    EXPECT_EQ(ord->evaluate(query), "third");
+    EXPECT_EQ(count->evaluate(query), "two");
+    // Calls by name still go through the same function
+    EXPECT_EQ(boundTable->call("count", count->getArgs(), query).intVal, 2);
+}
+
+TEST_F(SpeechTokenizerTest, TestNestedFunctionCalls) {
+    auto functionTable = std::make_unique<DefaultFunctionTable>();
+    functionTable->initialize();
+    auto manager = std::make_shared<ContextManager>(std::move(functionTable));
+    DatabaseQuery query(manager, "Group", "Category");
+    auto listener = std::make_shared<ContextTable>(manager);
+    listener->set("Gender", "female");
+    listener->set("Items", std::unordered_set<std::string>{"Sword", "Shield", "Bow"});
+    query.addContextTable("Listener", listener);
+
+    const auto evaluate = [&](const std::string& line) {
+        std::vector<std::shared_ptr<SpeechToken>> tokens;
+        auto result = SpeechTokenizer::tokenize(tokens, line, m_symbols, m_localSymbols, manager);
+        EXPECT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
+        std::string str;
+        for (const auto& token : tokens) {
+            str += std::static_pointer_cast<SymbolToken>(token)->evaluate(query).value_or("<error>");
+        }
+        return str;
+    };
+    EXPECT_EQ(evaluate("@capitalize(@gender(#Listener.Gender, they, he, she))"), "She");
+    EXPECT_EQ(evaluate("@upper(@concat(@objective(#Listener.Gender), @num(@count(#Listener.Items))))"), "HERTHREE");
+    EXPECT_EQ(evaluate("@num(@add(@count(#Listener.Items), 2))"), "five");
+    EXPECT_EQ(evaluate("@count(@list_concat(#Listener.Items, #Listener.Items))"), "six");
+}
+
+TEST_F(SpeechTokenizerTest, TestConstantFolding) {
+    m_manager->getFunctionTable()->initialize();
+    // Pure functions over literals collapse into the surrounding text
+    testValidSpeechLine("You are @ord(@add(1, 2)) in line, @upper(friend).", R"([String="You are third in line, FRIEND."])");
+    testValidSpeechLine("Roll @num(@div_int(12, 4))!", R"([String="Roll three!"])");
+    // Calls that depend on the query, or that fail, are left for runtime
+    testValidSpeechLine("Roll @rand_int(1, 6)!", R"([String="Roll "][Function=rand_int([Integer=1], [Integer=6])][String="!"])");
+    testValidSpeechLine("Hi @upper(#Listener.Name)", R"([String="Hi "][Function=upper([Context=Listener.Name])])");
+    testValidSpeechLine("@div(1, 0)", R"([Function=div([Integer=1], [Integer=0])])");
+}
+
+TEST_F(SpeechTokenizerTest, TestFoldingUsesManagerStringTable) {
+    auto functionTable = std::make_unique<InternFunctionTable>();
+    functionTable->initialize();
+    auto manager = std::make_shared<ContextManager>(std::move(functionTable));
+    const int id = manager->getStringTable().cache("Shield");
+
+    std::vector<std::shared_ptr<SpeechToken>> tokens;
+    auto result = SpeechTokenizer::tokenize(tokens, "@intern(Shield)", m_symbols, m_localSymbols, manager);
+    ASSERT_EQ(result.code, SpeechTokenizerReturnCode::kSuccess);
+    ASSERT_EQ(tokens.size(), 1);
+    EXPECT_EQ(tokens[0]->toString(), "[Integer=" + std::to_string(id) + "]");
+}
+
 }  // namespace Contextual
\ No newline at end of file
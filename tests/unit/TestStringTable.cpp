@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StringTable.h"
+
+namespace Contextual {
+
+TEST(StringTableTest, TestCacheAndLookup) {
+    StringTable stringTable;
+    int symbol = stringTable.cache("Value");
+
+    EXPECT_EQ(stringTable.cache("Value"), symbol);
+    EXPECT_NE(stringTable.cache("Other"), symbol);
+    EXPECT_EQ(stringTable.lookup(symbol), "Value");
+    EXPECT_EQ(stringTable.lookup(-1), std::nullopt);
+    EXPECT_EQ(stringTable.getSize(), 2);
+}
+
+TEST(StringTableTest, TestConcurrentCache) {
+    const int numThreads = 4;
+    const int numStrings = 5000;
+    StringTable stringTable;
+
+    // Every thread interns the same strings in a different order
+    std::vector<std::vector<int>> symbols(numThreads, std::vector<int>(numStrings));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&stringTable, &symbols, t]() {
+            for (int i = 0; i < numStrings; ++i) {
+                int value = (i * 7919 + t * 1237) % numStrings;
+                symbols[t][value] = stringTable.cache("String" + std::to_string(value));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(stringTable.getSize(), numStrings);
+    for (int i = 0; i < numStrings; ++i) {
+        for (int t = 1; t < numThreads; ++t) {
+            EXPECT_EQ(symbols[t][i], symbols[0][i]);
+        }
+        EXPECT_EQ(stringTable.lookup(symbols[0][i]), "String" + std::to_string(i));
+    }
+}
+
+}  // namespace Contextual
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace Contextual {
+
+TEST(ThreadPoolTest, TestNestedParallelFor) {
+    const size_t numOuter = 16;
+    const size_t numInner = 64;
+    ThreadPool threadPool(2);
+
+    // Every worker runs an outer task that queues more helpers than there are idle workers
+    std::vector<std::atomic<int>> counts(numOuter);
+    threadPool.parallelFor(numOuter, [&](const size_t i) {
+        threadPool.parallelFor(numInner, [&](size_t) { ++counts[i]; });
+    });
+    for (const auto& count : counts) {
+        EXPECT_EQ(count, numInner);
+    }
+}
+
+TEST(ThreadPoolTest, TestExceptionIsRethrown) {
+    ThreadPool threadPool(4);
+    EXPECT_THROW(threadPool.parallelFor(1000,
+                                        [](const size_t i) {
+                                            if (i == 10) {
+                                                throw std::runtime_error("Task failed");
+                                            }
+                                        }),
+                 std::runtime_error);
+
+    // The pool is still usable afterwards
+    std::atomic<int> numSucceeded = 0;
+    threadPool.parallelFor(100, [&](size_t) { ++numSucceeded; });
+    EXPECT_EQ(numSucceeded, 100);
+}
+
+}  // namespace Contextual